@@ -1,7 +1,8 @@
 // ==============================================================================
 // ATtiny402 SCD41 CO2 Sensor Reader
 // ==============================================================================
-// Sketch uses 3275 bytes (79%) of program storage space. Maximum is 4096 bytes. 
+// Flash: 4096 bytes. 3275 bytes (79%) were used before the binary protocol and
+// the sleep modes: check the "Sketch uses" line of the IDE after a change.
 //
 // HARDWARE SETUP:
 // - ATtiny402 with SCD41 CO2 sensor via I2C
@@ -27,84 +28,344 @@
 // Flash command (replace COMx with your port):
 //   pymcuprog write -d attiny402 -t uart -u COMx -f ATtiny402_HTCO2.ino.hex --erase --verify
 //
-// READING SERIAL OUTPUT:
-// ----------------------
-// Connect USB-UART RX to ATtiny402 PA6 (TX) to read sensor data
-// Baud rate: 115200
-// Output format: CO2,Temperature_tenths,Humidity_tenths,Light
-// Example: 1124,188,596,243 = 1124ppm, 18.8°C, 59. 6%RH, light=243
+// SERIAL PROTOCOL (binary, 115200 baud, single wire on PA6):
+// -----------------------------------------------------------
+// PA7 is used by the photoresistor and the alternate USART pins are the I2C bus,
+// so requests and answers share PA6 (half duplex, open drain, pull-up on the
+// MainPCB side). The node only talks when asked:
+//   0x11 = measure now (read the SCD41 if it has new data, answer the measurement)
+//   0x12 = send last (answer the last measurement again)
+//   0x13 lo hi = set the measurement interval in seconds (answers the config)
+// Other bytes are ignored: the MainPCB starts each request with 0xFF, whose start
+// bit wakes the ATtiny from standby (it may be received garbled).
+// Answer frame:
+//   0xA5 | LEN | payload[LEN] | CRC8
+// CRC8 covers LEN and the payload (Sensirion polynomial 0x31, init 0xFF, the
+// same CRC as the SCD41 words). Payload, little endian:
+//   [0]    message type (0x01 = measurement)
+//   [1..2] CO2 (ppm)
+//   [3..4] SCD41 raw temperature (T = -45 + 175 * raw / 65535)
+//   [5..6] SCD41 raw humidity (RH = 100 * raw / 65535)
+//   [7..8] light sensor raw ADC value (0-1023)
+//   [9]    SCD41 reads rejected by their CRC (wraps at 255)
+// Config payload:
+//   [0]    message type (0x02 = config)
+//   [1..2] measurement interval (s)
+//   [3]    SCD41 mode (0 = periodic, 1 = low power periodic, 2 = single shot)
+// The conversions are done by the MainPCB (MainPCB/VanManagement/peripherals_devices/htco2_protocol.c),
+// which keeps the 32-bit divisions out of this sketch.
+//
+// POWER:
+// ------
+// The ATtiny sleeps in standby between events, woken every second by the RTC
+// PIT (1 kHz internal oscillator) or by a start bit on PA6. millis() must stay
+// on its default timer (not the RTC). The SCD41 mode follows the interval:
+//   < 30 s: periodic (5 s, ~15 mA)
+//   < 60 s: low power periodic (30 s, ~3.2 mA)
+//   else:   single shot (5 s measurement, idle ~0.2 mA in between)
+// The sensor is only read when get_data_ready_status reports new data.
 // ==============================================================================
 
 #include <Wire.h>
+#include <avr/sleep.h>
 
 #define SCD41_ADDR 0x62
 #define PHOTORESISTOR_PIN PIN_PA7
 #define LED_PIN PIN_PA3
-#define MEASUREMENT_INTERVAL 5000
+
+// SCD41 commands (datasheet section 3.5)
+#define SCD41_START_PERIODIC 0x21b1
+#define SCD41_START_LOW_POWER 0x21ac
+#define SCD41_STOP_PERIODIC 0x3f86
+#define SCD41_MEASURE_SINGLE_SHOT 0x219d
+#define SCD41_READ_MEASUREMENT 0xec05
+#define SCD41_GET_DATA_READY 0xe4b8
+#define SCD41_STOP_DELAY 500         // ms before the sensor accepts a new command
+#define SCD41_SINGLE_SHOT_TIME 5     // s
+#define SCD41_SINGLE_SHOT_TIMEOUT (2 * SCD41_SINGLE_SHOT_TIME)  // s without data: shot lost, start a new one
+
+// SCD41 modes (sent in the config answer)
+#define MODE_PERIODIC 0
+#define MODE_LOW_POWER 1
+#define MODE_SINGLE_SHOT 2
+#define MODE_STOPPED 3               // Between two modes, for one second at least (never sent)
+#define LOW_POWER_INTERVAL 30        // s, shortest interval in low power periodic mode
+#define SINGLE_SHOT_INTERVAL 60      // s, shortest interval in single shot mode
+#define MIN_INTERVAL 5               // s, periodic mode update rate
+#define DEFAULT_INTERVAL 30          // s
+
+// UART protocol (see MainPCB/VanManagement/peripherals_devices/htco2_protocol.h)
+#define FRAME_SYNC 0xA5
+#define MSG_MEASUREMENT 0x01
+#define MSG_CONFIG 0x02
+#define MEASUREMENT_LEN 10
+#define CONFIG_LEN 4
+#define CMD_MEASURE_NOW 0x11
+#define CMD_SEND_LAST 0x12
+#define CMD_SET_INTERVAL 0x13
+#define REQUEST_WINDOW 5             // ms awake waiting for the next request byte
+
+static uint8_t sensor_crc_errors = 0;
+static uint8_t last_payload[MEASUREMENT_LEN];
+static bool has_measurement = false;
+
+static uint16_t interval = DEFAULT_INTERVAL;
+static uint8_t scd41_mode = MODE_STOPPED;        // Until setup() picks the mode
+static bool single_shot_running = false;
+static uint8_t single_shot_age = 0;               // s since the single shot command
+static uint16_t seconds_since_reading = 0;
+static volatile uint8_t pit_ticks = 0;
+
+// Sensirion CRC-8 (polynomial 0x31, init 0xFF), also used for the UART frames
+static uint8_t crc8(const uint8_t* data, uint8_t len, uint8_t crc) {
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+// False if the sensor did not acknowledge the command
+static bool scd41_command(uint16_t cmd) {
+  Wire.beginTransmission(SCD41_ADDR);
+  Wire.write(cmd >> 8);
+  Wire.write(cmd & 0xFF);
+  return Wire.endTransmission() == 0;
+}
+
+// Send a read command and get words (raw, each followed by its CRC), false on error
+static bool scd41_read(uint16_t cmd, uint8_t* raw, uint8_t words) {
+  scd41_command(cmd);
+  delay(1); // Wait 1ms for command execution
+  
+  uint8_t len = words * 3;
+  Wire.requestFrom(SCD41_ADDR, len);
+  if (Wire.available() < len) {
+    return false;
+  }
+  for (uint8_t i = 0; i < len; i++) {
+    raw[i] = Wire.read();
+  }
+  for (uint8_t i = 0; i < len; i += 3) {
+    if (crc8(&raw[i], 2, 0xFF) != raw[i + 2]) {
+      sensor_crc_errors++;
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool scd41_data_ready() {
+  uint8_t raw[3];
+  // Lowest 11 bits are 0 while no new measurement is available
+  return scd41_read(SCD41_GET_DATA_READY, raw, 1) && (((raw[0] & 0x07) | raw[1]) != 0);
+}
+
+static uint8_t mode_for(uint16_t seconds) {
+  if (seconds < LOW_POWER_INTERVAL) return MODE_PERIODIC;
+  if (seconds < SINGLE_SHOT_INTERVAL) return MODE_LOW_POWER;
+  return MODE_SINGLE_SHOT;
+}
+
+// One step towards the mode of the current interval, called every second. It
+// never waits for the sensor, so requests are answered during a change
+static void set_mode() {
+  uint8_t mode = mode_for(interval);
+  if (mode == scd41_mode) {
+    return;
+  }
+  if (scd41_mode == MODE_SINGLE_SHOT) {
+    if (single_shot_running) {
+      return;         // Commands are refused until the shot ends (read or timed out)
+    }
+    scd41_mode = MODE_STOPPED;
+  } else if (scd41_mode != MODE_STOPPED) {
+    scd41_command(SCD41_STOP_PERIODIC);
+    scd41_mode = MODE_STOPPED;
+    return;           // Next second: past SCD41_STOP_DELAY
+  }
+  
+  if (mode == MODE_PERIODIC) {
+    scd41_command(SCD41_START_PERIODIC);
+  } else if (mode == MODE_LOW_POWER) {
+    scd41_command(SCD41_START_LOW_POWER);
+  }
+  scd41_mode = mode;
+}
+
+static void send_frame(const uint8_t* payload, uint8_t len) {
+  uint8_t crc = crc8(&len, 1, 0xFF);
+  crc = crc8(payload, len, crc);
+  Serial.write(FRAME_SYNC);
+  Serial.write(len);
+  Serial.write(payload, len);
+  Serial.write(crc);
+  Serial.flush();
+  // Our own bytes are received on the single wire: never take them for requests
+  while (Serial.available()) {
+    Serial.read();
+  }
+}
+
+// Read the SCD41 into last_payload if it has a new measurement
+static bool read_sensor() {
+  uint8_t raw[9];   // CO2(2) + CRC(1) + Temp(2) + CRC(1) + Hum(2) + CRC(1)
+  if (!scd41_data_ready() || !scd41_read(SCD41_READ_MEASUREMENT, raw, 3)) {
+    return false;
+  }
+  
+  uint16_t light = analogRead(PHOTORESISTOR_PIN);
+  last_payload[0] = MSG_MEASUREMENT;
+  last_payload[1] = raw[1];   // CO2 (sensor words are big endian)
+  last_payload[2] = raw[0];
+  last_payload[3] = raw[4];   // Temperature raw
+  last_payload[4] = raw[3];
+  last_payload[5] = raw[7];   // Humidity raw
+  last_payload[6] = raw[6];
+  last_payload[7] = (uint8_t)light;
+  last_payload[8] = (uint8_t)(light >> 8);
+  has_measurement = true;
+  seconds_since_reading = 0;
+  single_shot_running = false;
+  
+  // Toggle LED to indicate successful reading
+  digitalWrite(LED_PIN, !digitalRead(LED_PIN));
+  return true;
+}
+
+static void send_last() {
+  if (!has_measurement) {
+    return;         // Nothing to answer yet (first SCD41 reading)
+  }
+  last_payload[9] = sensor_crc_errors;
+  send_frame(last_payload, MEASUREMENT_LEN);
+}
+
+static void send_config() {
+  uint8_t payload[CONFIG_LEN] = {MSG_CONFIG, (uint8_t)interval, (uint8_t)(interval >> 8), mode_for(interval)};
+  send_frame(payload, CONFIG_LEN);
+}
+
+// Next request byte, -1 if none within REQUEST_WINDOW
+static int read_request_byte() {
+  unsigned long start = millis();
+  while (!Serial.available()) {
+    if (millis() - start >= REQUEST_WINDOW) {
+      return -1;
+    }
+  }
+  return Serial.read();
+}
+
+static void handle_requests() {
+  int cmd;
+  while ((cmd = read_request_byte()) >= 0) {
+    switch (cmd) {
+      case CMD_MEASURE_NOW:
+        // Nothing new means the previous answer is still current
+        read_sensor();
+        send_last();
+        break;
+      case CMD_SEND_LAST:
+        send_last();
+        break;
+      case CMD_SET_INTERVAL: {
+        int lo = read_request_byte();
+        int hi = read_request_byte();
+        if (lo < 0 || hi < 0) {
+          return;
+        }
+        interval = (uint16_t)(lo | (hi << 8));
+        if (interval < MIN_INTERVAL) {
+          interval = MIN_INTERVAL;
+        }
+        send_config();      // The mode follows at the next seconds (set_mode())
+        break;
+      }
+      default:
+        break;        // Wake byte or noise on the line
+    }
+  }
+}
+
+// Called every second (or more after a long request)
+static void update_measurement(uint8_t seconds) {
+  if (seconds_since_reading < 0xFFFF - seconds) {
+    seconds_since_reading += seconds;
+  }
+  set_mode();
+  
+  if (scd41_mode == MODE_STOPPED) {
+    return;
+  }
+  if (scd41_mode == MODE_SINGLE_SHOT) {
+    if (single_shot_running) {
+      if (single_shot_age < 0xFF - seconds) {
+        single_shot_age += seconds;
+      }
+      if (single_shot_age >= SCD41_SINGLE_SHOT_TIMEOUT) {
+        single_shot_running = false;    // No data: started again below
+      }
+    }
+    if (!single_shot_running) {
+      if (mode_for(interval) != MODE_SINGLE_SHOT) {
+        return;       // Leaving the mode: set_mode() switches at the next second
+      }
+      // Started early so that the result is ready when the interval ends
+      // (NACKed command: tried again next second)
+      if (seconds_since_reading + SCD41_SINGLE_SHOT_TIME >= interval &&
+          scd41_command(SCD41_MEASURE_SINGLE_SHOT)) {
+        single_shot_running = true;
+        single_shot_age = 0;
+      }
+      return;
+    }
+  } else if (seconds_since_reading < interval) {
+    return;
+  }
+  read_sensor();      // Polled every second until the data is ready
+}
+
+ISR(RTC_PIT_vect) {
+  RTC.PITINTFLAGS = RTC_PI_bm;
+  pit_ticks++;
+}
 
 void setup() {
-  Serial.begin(115200);
+  Serial.begin(115200, SERIAL_HALF_DUPLEX);
+  USART0.CTRLB |= USART_SFDEN_bm;     // A start bit wakes the CPU from standby
   Wire.begin();
   pinMode(LED_PIN, OUTPUT);
   
-  // Start SCD41 periodic measurement (command 0x21b1 from datasheet page 9)
-  Wire.beginTransmission(SCD41_ADDR);
-  Wire.write(0x21); 
-  Wire.write(0xb1);
-  Wire.endTransmission();
+  // The SCD41 keeps running through an ATtiny reset: stop it before choosing the mode
+  scd41_command(SCD41_STOP_PERIODIC);
+  delay(SCD41_STOP_DELAY);
+  set_mode();         // From MODE_STOPPED: starts the mode at once
+  
+  // 1 s periodic interrupt from the 1.024 kHz internal oscillator
+  RTC.CLKSEL = RTC_CLKSEL_INT1K_gc;
+  while (RTC.PITSTATUS > 0) {}
+  RTC.PITINTCTRL = RTC_PI_bm;
+  RTC.PITCTRL = RTC_PERIOD_CYC1024_gc | RTC_PITEN_bm;
   
-  // Wait for first measurement to be ready (5 seconds minimum)
-  delay(5000);
+  set_sleep_mode(SLEEP_MODE_STANDBY);
+  sleep_enable();
 }
 
 void loop() {
-  // Read measurement (command 0xec05 from datasheet page 9)
-  Wire.beginTransmission(SCD41_ADDR);
-  Wire.write(0xec); 
-  Wire. write(0x05);
-  Wire.endTransmission();
-  
-  delay(1); // Wait 1ms for command execution
+  sleep_cpu();
   
-  // Request 9 bytes: CO2(2) + CRC(1) + Temp(2) + CRC(1) + Hum(2) + CRC(1)
-  Wire.requestFrom(SCD41_ADDR, 9);
+  cli();
+  uint8_t seconds = pit_ticks;
+  pit_ticks = 0;
+  sei();
   
-  if (Wire.available() >= 9) {
-    // Read CO2 (2 bytes + CRC)
-    uint16_t co2 = Wire.read() << 8 | Wire.read();
-    Wire. read(); // Skip CRC
-    
-    // Read temperature raw value (2 bytes + CRC)
-    uint16_t temp_raw = Wire.read() << 8 | Wire.read();
-    Wire.read(); // Skip CRC
-    
-    // Read humidity raw value (2 bytes + CRC)
-    uint16_t hum_raw = Wire.read() << 8 | Wire.read();
-    Wire.read(); // Skip CRC
-    
-    // CO2 in ppm (parts per million)
-    Serial.print(co2);
-    Serial. write(',');
-    
-    // Temperature in tenths of °C: (-450 + temp_raw * 175 / 655. 35)
-    // Formula: T = -45 + 175 * (temp_raw / 65535)
-    // Multiply by 10 to get tenths: T*10 = -450 + 1750 * temp_raw / 65535
-    // Simplified: T*10 = -450 + temp_raw * 1750 / 65535 ≈ -450 + temp_raw / 37. 45
-    Serial.print((int16_t)(-450 + ((long)temp_raw * 1750L) / 65535L));
-    Serial.write(',');
-    
-    // Humidity in tenths of %RH: (hum_raw * 100 / 65535) * 10
-    // Simplified: hum_raw * 1000 / 65535
-    Serial.print((uint16_t)(((long)hum_raw * 1000L) / 65535L));
-    Serial.write(',');
-    
-    // Light sensor raw ADC value (0-1023)
-    Serial.println(analogRead(PHOTORESISTOR_PIN));
-    
-    // Toggle LED to indicate successful reading
-    digitalWrite(LED_PIN, !digitalRead(LED_PIN));
+  if (seconds == 0 || Serial.available()) {
+    handle_requests();    // Woken by a start bit on PA6
   }
-  
-  // Wait 5 seconds between measurements (signal update interval from datasheet)
-  delay(MEASUREMENT_INTERVAL);
-}
\ No newline at end of file
+  if (seconds > 0) {
+    update_measurement(seconds);
+  }
+}
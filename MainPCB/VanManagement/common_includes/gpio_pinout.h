@@ -12,14 +12,14 @@
 #define EXT_LED             42    // Exterior LED Power Control
 
 // MPPT UART pins (multiplexed on UART1)
-#define VE_DIRECT_TX0       UART_PIN_NO_CHANGE    // 100|50 MPPT TX (RX only, no TX needed)
+#define VE_DIRECT_TX0       UART_PIN_NO_CHANGE    // 100|50 MPPT TX (not wired: text protocol only, set a pin to enable VE.Direct HEX)
 #define VE_DIRECT_RX0       18    // 100|50 MPPT RX
-#define VE_DIRECT_TX1       UART_PIN_NO_CHANGE    // 70|15 MPPT TX (RX only, no TX needed)
+#define VE_DIRECT_TX1       UART_PIN_NO_CHANGE    // 70|15 MPPT TX (not wired: text protocol only, set a pin to enable VE.Direct HEX)
 #define VE_DIRECT_RX1       15    // 70|15 MPPT RX
 
 // Sensor UART pins (multiplexed on UART2)
-#define HEATER_TX           8   // Diesel Heater TX (RX only)
-#define HCO2T_TX            3   // Humidity/CO2/Temperature/Light sensor TX (RX only)
+#define HEATER_TX           8   // Diesel Heater single-wire UART (blue wire)
+#define HCO2T_TX            3   // Humidity/CO2/Temperature/Light sensor single-wire UART (requests and frames)
 
 // USB OTG pins
 #define USB_A9_N            19   // USB OTG D-
@@ -20,11 +20,13 @@ esp_err_t app_main_send_van_state_to_app(void) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    van_state_t* van_state = protocol_get_van_state();
-    if (!van_state) {
-        ESP_LOGE(TAG, "Failed to get van state for sending");
+    // Copie cohérente du dernier état publié (sans verrou)
+    static van_state_t snapshot;
+    if (protocol_get_van_state_snapshot(&snapshot) == 0) {
+        ESP_LOGD(TAG, "No van state published yet");
         return ESP_ERR_INVALID_STATE;
     }
+    const van_state_t* van_state = &snapshot;
 
     // Allouer buffer JSON sur le heap
     char* json_buffer = (char*)malloc(4096);
@@ -31,6 +31,9 @@ static const char *TAG = "\033[0;34mBLE_MGR\033[0m";
 #define VAN_SERVICE_UUID_16         0xAAA0
 #define VAN_CHAR_COMMAND_UUID_16    0xAAA1  
 #define VAN_CHAR_STATE_UUID_16      0xAAA2
+#define VAN_CHAR_HISTORY_UUID_16    0xAAA3  // History requests (write) and bulk data (notify)
+
+#define HISTORY_MBUF_RESERVE 8              // Buffers left free for the state notifications
 
 // ============================================================================
 // DATA STRUCTURES
@@ -41,6 +44,7 @@ typedef struct {
     bool connected;
     bool notifications_enabled;  // Flag pour savoir si le client a activé les notifications
     uint32_t notifications_enabled_time;  // Timestamp quand les notifications ont été activées
+    bool history_enabled;        // Notifications activées sur la caractéristique historique
     uint8_t mac[6];
 } ble_connection_t;
 
@@ -86,12 +90,14 @@ typedef struct {
 static ble_connection_t g_connections[MAX_CONNECTIONS] = {0};
 static external_device_t g_external_devices[MAX_EXTERNAL_DEVICES] = {0};
 static ble_receive_callback_t g_receive_callback = NULL;
+static ble_receive_callback_t g_history_callback = NULL;
 static SemaphoreHandle_t g_ble_mutex = NULL;
 static bool g_ble_initialized = false;
 
 // GATT Characteristic handles
 static uint16_t g_char_command_handle = 0;
 static uint16_t g_char_state_handle = 0;
+static uint16_t g_char_history_handle = 0;
 
 // ============================================================================
 // FORWARD DECLARATIONS
@@ -180,6 +186,8 @@ static void van_gatt_register_cb(struct ble_gatt_register_ctxt *ctxt, void *arg)
                 g_char_command_handle = ctxt->chr.val_handle;
             } else if (uuid == VAN_CHAR_STATE_UUID_16) {
                 g_char_state_handle = ctxt->chr.val_handle;
+            } else if (uuid == VAN_CHAR_HISTORY_UUID_16) {
+                g_char_history_handle = ctxt->chr.val_handle;
             }
             break;
             
@@ -207,6 +215,12 @@ static int van_gatt_access_cb(uint16_t conn_handle, uint16_t attr_handle,
                     
                     free(data);
                 }
+            } else if (attr_handle == g_char_history_handle) {
+                uint8_t request[32];
+                uint16_t data_len = 0;
+                if (ble_hs_mbuf_to_flat(ctxt->om, request, sizeof(request), &data_len) == 0 && g_history_callback) {
+                    g_history_callback(conn_handle, request, data_len);
+                }
             }
             break;
             
@@ -245,6 +259,13 @@ static const struct ble_gatt_svc_def gatt_services[] = {
                 .flags = BLE_GATT_CHR_F_NOTIFY,
                 .val_handle = &g_char_state_handle,
             },
+            {
+                // History characteristic (write request, notify bulk data)
+                .uuid = BLE_UUID16_DECLARE(VAN_CHAR_HISTORY_UUID_16),
+                .access_cb = van_gatt_access_cb,
+                .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_NOTIFY,
+                .val_handle = &g_char_history_handle,
+            },
             {0} // End
         },
     },
@@ -267,6 +288,7 @@ static int van_gap_event(struct ble_gap_event *event, void *arg) {
                     g_connections[slot].conn_handle = event->connect.conn_handle;
                     g_connections[slot].connected = true;
                     g_connections[slot].notifications_enabled = false;  // Pas encore prêt
+                    g_connections[slot].history_enabled = false;
                     
                     struct ble_gap_conn_desc desc;
                     if (ble_gap_conn_find(event->connect.conn_handle, &desc) == 0) {
@@ -319,6 +341,7 @@ static int van_gap_event(struct ble_gap_event *event, void *arg) {
             if (slot >= 0) {
                 g_connections[slot].connected = false;
                 g_connections[slot].notifications_enabled = false;
+                g_connections[slot].history_enabled = false;
                 memset(g_connections[slot].mac, 0, 6);
             }
             unlock_ble();
@@ -342,7 +365,9 @@ static int van_gap_event(struct ble_gap_event *event, void *arg) {
             // Mettre à jour le flag pour cette connexion
             lock_ble();
             int slot = find_connection_by_handle(event->subscribe.conn_handle);
-            if (slot >= 0) {
+            if (slot >= 0 && event->subscribe.attr_handle == g_char_history_handle) {
+                g_connections[slot].history_enabled = event->subscribe.cur_notify;
+            } else if (slot >= 0) {
                 g_connections[slot].notifications_enabled = event->subscribe.cur_notify;
                 if (event->subscribe.cur_notify) {
                     g_connections[slot].notifications_enabled_time = xTaskGetTickCount();
@@ -1118,6 +1143,51 @@ esp_err_t ble_send_json(const char* json_string) {
     return ble_send_raw((const uint8_t*)json_string, strlen(json_string));
 }
 
+// ============================================================================
+// PUBLIC API - HISTORY TRANSFER
+// ============================================================================
+
+void ble_set_history_callback(ble_receive_callback_t history_callback) {
+    g_history_callback = history_callback;
+}
+
+uint16_t ble_get_history_payload_size(uint16_t conn_handle) {
+    uint16_t mtu = ble_att_mtu(conn_handle);
+    if (mtu <= 3) {
+        return 0;
+    }
+    uint16_t payload = mtu - 3;     // ATT notification header
+    return (payload > BLE_MAX_FRAGMENT_SIZE) ? BLE_MAX_FRAGMENT_SIZE : payload;
+}
+
+esp_err_t ble_send_history(uint16_t conn_handle, const uint8_t* data, size_t length) {
+    if (!g_ble_initialized || !data || length == 0 || g_char_history_handle == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    lock_ble();
+    int slot = find_connection_by_handle(conn_handle);
+    bool ready = slot >= 0 && g_connections[slot].history_enabled;
+    unlock_ble();
+    if (!ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Laisser des buffers libres pour l'état envoyé chaque seconde
+    if (os_msys_num_free() < HISTORY_MBUF_RESERVE) {
+        return ESP_ERR_NO_MEM;
+    }
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(data, length);
+    if (!om) {
+        return ESP_ERR_NO_MEM;
+    }
+    int rc = ble_gatts_notify_custom(conn_handle, g_char_history_handle, om);
+    if (rc == BLE_HS_ENOMEM || rc == BLE_HS_EBUSY) {
+        return ESP_ERR_NO_MEM;
+    }
+    return (rc == 0) ? ESP_OK : ESP_FAIL;
+}
+
 // ============================================================================
 // PUBLIC API - EXTERNAL DEVICE MANAGEMENT
 // ============================================================================
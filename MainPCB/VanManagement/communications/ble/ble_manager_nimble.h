@@ -114,6 +114,35 @@ esp_err_t ble_send_raw(const uint8_t* data, size_t length);
  */
 esp_err_t ble_send_json(const char* json_string);
 
+// ============================================================================
+// HISTORY TRANSFER (characteristic 0xAAA3, separate from the state stream)
+// ============================================================================
+
+/**
+ * @brief Set the callback receiving the requests written on the history characteristic
+ *
+ * Called from the NimBLE host task: keep it short (queue the request).
+ */
+void ble_set_history_callback(ble_receive_callback_t history_callback);
+
+/**
+ * @brief Largest history notification for a connection (negotiated MTU - 3)
+ * @return Payload size in bytes, 0 if the connection is unknown
+ */
+uint16_t ble_get_history_payload_size(uint16_t conn_handle);
+
+/**
+ * @brief Notify one history chunk to one connection (no fragmentation)
+ *
+ * Never blocks. Keeps a reserve of buffers so the state notifications are
+ * not starved by a bulk transfer.
+ *
+ * @param data Chunk, at most ble_get_history_payload_size() bytes
+ * @return ESP_OK, ESP_ERR_NO_MEM if the stack is congested (retry later),
+ *         ESP_ERR_INVALID_STATE if the client is gone or not subscribed
+ */
+esp_err_t ble_send_history(uint16_t conn_handle, const uint8_t* data, size_t length);
+
 // ============================================================================
 // EXTERNAL DEVICE MANAGEMENT
 // ============================================================================
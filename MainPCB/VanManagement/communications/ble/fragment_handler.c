@@ -25,6 +25,15 @@ bool fragment_handler_is_active(fragment_handler_t* handler) {
     return handler->assembly.active;
 }
 
+bool fragment_handler_get_partial(fragment_handler_t* handler, const uint8_t** data, size_t* len) {
+    if (!handler->assembly.active || handler->assembly.buffer == NULL) {
+        return false;
+    }
+    *data = handler->assembly.buffer;
+    *len = handler->assembly.current_size;
+    return true;
+}
+
 void fragment_handler_check_timeout(fragment_handler_t* handler, uint32_t current_ms) {
     if (handler->assembly.active) {
         uint32_t elapsed = current_ms - handler->assembly.last_update_ms;
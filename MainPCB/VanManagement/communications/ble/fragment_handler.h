@@ -64,6 +64,14 @@ fragment_result_t fragment_handler_process(
     size_t* output_len
 );
 
+/**
+ * Donne accès aux données déjà réassemblées pendant un réassemblage en cours
+ * (pour traiter une commande au fil de l'eau, sans attendre le dernier fragment)
+ * 
+ * @return true si un réassemblage est en cours
+ */
+bool fragment_handler_get_partial(fragment_handler_t* handler, const uint8_t** data, size_t* len);
+
 /**
  * Nettoie les ressources du gestionnaire
  */
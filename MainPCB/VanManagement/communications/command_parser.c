@@ -73,6 +73,15 @@ command_parse_result_t parse_van_command(const uint8_t* raw_data, size_t data_le
                     return PARSE_ERROR_LED_DATA;
                 }
                 (*output_cmd)->command.led_cmd.command.dynamic_cmd = dynamic_cmd;
+            } else if (led_type == LED_SCENE) {
+                // Action (1 byte) + slot (1 byte)
+                if (offset + 2 * sizeof(uint8_t) > data_len) {
+                    free(*output_cmd);
+                    *output_cmd = NULL;
+                    return PARSE_ERROR_INCOMPLETE_DATA;
+                }
+                (*output_cmd)->command.led_cmd.command.scene_cmd.action = (led_scene_action_t)raw_data[offset++];
+                (*output_cmd)->command.led_cmd.command.scene_cmd.slot = raw_data[offset++];
             } else {
                 free(*output_cmd);
                 *output_cmd = NULL;
@@ -361,6 +370,11 @@ static bool validate_led_command(const led_command_t* cmd) {
             }
         }
         return true;
+    } else if (cmd->led_type == LED_SCENE) {
+        const led_scene_command_t* scene_cmd = &cmd->command.scene_cmd;
+        return (scene_cmd->action >= LED_SCENE_RECALL &&
+                scene_cmd->action <= LED_SCENE_DELETE &&
+                scene_cmd->slot < LED_SCENE_SLOT_COUNT);
     }
 
     return false;
@@ -378,6 +392,91 @@ void free_van_command(van_command_t* cmd) {
     }
 }
 
+// ============================================================================
+// PROGRESSIVE LED DYNAMIC PARSING
+// ============================================================================
+
+void led_stream_parser_reset(led_stream_parser_t* parser) {
+    if (parser == NULL) return;
+    memset(parser, 0, sizeof(led_stream_parser_t));
+    parser->state = LED_STREAM_WAITING_HEADER;
+}
+
+void led_stream_parser_set_target(led_stream_parser_t* parser, led_dynamic_command_t* target) {
+    if (parser == NULL || parser->state != LED_STREAM_HEADER_READY) return;
+    parser->target = target;
+    parser->state = (target != NULL) ? LED_STREAM_KEYFRAMES : LED_STREAM_ERROR;
+}
+
+led_stream_state_t led_stream_parser_feed(led_stream_parser_t* parser, const uint8_t* data, size_t data_len) {
+    if (parser == NULL || data == NULL) return LED_STREAM_ERROR;
+
+    if (parser->state == LED_STREAM_WAITING_HEADER) {
+        // type(1) + timestamp(4) + led_type(1)
+        size_t offset = MIN_VAN_COMMAND_SIZE;
+        if (data_len < offset + 1) return parser->state;
+
+        if (data[0] != COMMAND_TYPE_LED || data[offset] != LED_DYNAMIC) {
+            parser->state = LED_STREAM_NOT_STREAMABLE;
+            return parser->state;
+        }
+        offset++;
+
+        // strip_target(1) + loop_duration(4) + keyframe_count(2) + loop_behavior(1)
+        size_t fixed_part_size = 1 + sizeof(uint32_t) + sizeof(uint16_t) + 1;
+        if (data_len < offset + fixed_part_size) return parser->state;
+
+        parser->strip_target = (led_strip_dynamic_target_t)data[offset++];
+        memcpy(&parser->loop_duration_ms, &data[offset], sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        memcpy(&parser->keyframe_count, &data[offset], sizeof(uint16_t));
+        offset += sizeof(uint16_t);
+        parser->loop_behavior = (loop_behavior_t)data[offset++];
+        parser->offset = offset;
+
+        if (parser->strip_target > ROOF_LED_ALL_DYNAMIC ||
+            parser->keyframe_count == 0 || parser->keyframe_count > MAX_KEYFRAMES ||
+            parser->loop_duration_ms == 0) {
+            ESP_LOGE(TAG, "❌ Invalid streamed LED header (target=%d, keyframes=%u, duration=%u)",
+                     parser->strip_target, parser->keyframe_count, (unsigned)parser->loop_duration_ms);
+            parser->state = LED_STREAM_ERROR;
+            return parser->state;
+        }
+
+        parser->state = LED_STREAM_HEADER_READY;
+        return parser->state;
+    }
+
+    if (parser->state == LED_STREAM_KEYFRAMES) {
+        while (parser->keyframes_parsed < parser->keyframe_count) {
+            size_t offset = parser->offset;
+            led_keyframe_t* keyframe = &parser->target->keyframes[parser->keyframes_parsed];
+
+            // Stop at the first keyframe not fully received yet
+            if (!parse_led_keyframe(data, &offset, keyframe, parser->strip_target, data_len)) {
+                break;
+            }
+
+            // Same rule as validate_led_command(): timestamps strictly increasing
+            if (parser->keyframes_parsed > 0 &&
+                keyframe->timestamp_ms <= parser->target->keyframes[parser->keyframes_parsed - 1].timestamp_ms) {
+                ESP_LOGE(TAG, "❌ Streamed keyframe %u out of order", parser->keyframes_parsed);
+                parser->state = LED_STREAM_ERROR;
+                return parser->state;
+            }
+
+            parser->offset = offset;
+            parser->keyframes_parsed++;
+        }
+
+        if (parser->keyframes_parsed == parser->keyframe_count) {
+            parser->state = LED_STREAM_DONE;
+        }
+    }
+
+    return parser->state;
+}
+
 const char* parse_result_to_string(command_parse_result_t result){
     switch (result) {
         case PARSE_SUCCESS:
@@ -44,11 +44,37 @@ typedef enum {
     PARSE_ERROR_VALIDATION_FAILED,
 } command_parse_result_t;
 
+// Progressive parsing of LED dynamic commands (keyframes are extracted
+// fragment by fragment from the reassembly buffer while it is still filling)
+typedef enum {
+    LED_STREAM_WAITING_HEADER,   // Not enough bytes yet to read the command header
+    LED_STREAM_HEADER_READY,     // Header parsed, waiting for a keyframe buffer (led_stream_parser_set_target)
+    LED_STREAM_KEYFRAMES,        // Keyframes are being parsed into the target buffer
+    LED_STREAM_DONE,             // Every keyframe has been parsed
+    LED_STREAM_NOT_STREAMABLE,   // Not a LED dynamic command, use parse_van_command()
+    LED_STREAM_ERROR,            // Invalid data
+} led_stream_state_t;
+
+typedef struct {
+    led_stream_state_t state;
+    size_t offset;                          // Parse offset in the reassembly buffer
+    led_strip_dynamic_target_t strip_target;
+    uint32_t loop_duration_ms;
+    uint16_t keyframe_count;
+    loop_behavior_t loop_behavior;
+    led_dynamic_command_t* target;          // Receives the keyframes (not owned)
+    uint16_t keyframes_parsed;              // Keyframes fully parsed and validated
+} led_stream_parser_t;
+
 // Public API
 command_parse_result_t parse_van_command(const uint8_t* raw_data, size_t data_len, van_command_t** output_cmd);
 bool validate_parsed_command(const van_command_t* cmd);
 void free_van_command(van_command_t* cmd);
 
+void led_stream_parser_reset(led_stream_parser_t* parser);
+void led_stream_parser_set_target(led_stream_parser_t* parser, led_dynamic_command_t* target);
+led_stream_state_t led_stream_parser_feed(led_stream_parser_t* parser, const uint8_t* data, size_t data_len);
+
 // Helper function to get parse result as string
 const char* parse_result_to_string(command_parse_result_t result);
 
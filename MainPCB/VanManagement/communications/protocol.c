@@ -6,11 +6,14 @@
  * All peripheral managers can read and update their respective sections via pointer access.
  * 
  * Architecture:
- * - Single static instance of van_state_t
- * - Thread-safe access via pointer (managers own their sections)
+ * - Single static instance of van_state_t, written by the update cycle
+ * - Two published snapshots under a sequence counter (seqlock): the update
+ *   cycle publishes the whole state once per cycle, readers in other tasks
+ *   copy the last complete one without locks
  */
 
 #include "protocol.h"
+#include <stdatomic.h>
 
 static const char *TAG = "PROTOCOL";
 
@@ -26,6 +29,16 @@ static const char *TAG = "PROTOCOL";
  */
 static van_state_t van_state = {0};
 
+/**
+ * @brief Published snapshots (double buffer)
+ *
+ * snapshot_seq is even when idle and odd while a publication is copying.
+ * Publication n (seq 2n -> 2n+2) writes snapshots[(n + 1) & 1], so the last
+ * complete snapshot snapshots[(seq >> 1) & 1] is never the one being written.
+ */
+static van_state_t snapshots[2];
+static atomic_uint snapshot_seq = 0;
+
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
@@ -43,6 +56,8 @@ esp_err_t protocol_init(void) {
     
     // Initialize state structure with zeros
     memset(&van_state, 0, sizeof(van_state_t));
+    memset(snapshots, 0, sizeof(snapshots));
+    atomic_store(&snapshot_seq, 0);
     
     
     ESP_LOGI(TAG, "van_state_t size: %d bytes", sizeof(van_state_t));
@@ -59,7 +74,8 @@ esp_err_t protocol_init(void) {
  * @brief Get pointer to the global van state
  * 
  * Returns a direct pointer to the van_state structure.
- * Peripheral managers can use this pointer to read and update their sections.
+ * Peripheral managers use this pointer from the update cycle to update their
+ * sections; other tasks read protocol_get_van_state_snapshot().
  * 
  * Example usage in a manager:
  * @code
@@ -74,6 +90,41 @@ van_state_t* protocol_get_van_state(void) {
     return &van_state;
 }
 
+/**
+ * @brief Publish the working state for the readers
+ *
+ * Single writer: call from the update cycle once every section is updated.
+ */
+void protocol_publish_van_state(void) {
+    unsigned int seq = atomic_load_explicit(&snapshot_seq, memory_order_relaxed);
+
+    atomic_store_explicit(&snapshot_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&snapshots[((seq >> 1) + 1) & 1], &van_state, sizeof(van_state_t));
+    atomic_store_explicit(&snapshot_seq, seq + 2, memory_order_release);
+}
+
+/**
+ * @brief Copy the last published state
+ *
+ * The copied buffer is only rewritten by the publication after next, so a
+ * retry needs two publications during one copy (never at the update rate).
+ *
+ * @param[out] out Consistent copy of van_state
+ * @return Sequence of the copy (changes with every publication, 0 before the first)
+ */
+uint32_t protocol_get_van_state_snapshot(van_state_t* out) {
+    unsigned int begin, end;
+    do {
+        begin = atomic_load_explicit(&snapshot_seq, memory_order_acquire);
+        memcpy(out, &snapshots[(begin >> 1) & 1], sizeof(van_state_t));
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&snapshot_seq, memory_order_relaxed);
+        // Buffer rewritten from seq (begin & ~1) + 3 on
+    } while (end - (begin & ~1u) >= 3);
+    return begin >> 1;
+}
+
 // ============================================================================
 // UTILITY FUNCTIONS (Optional helpers)
 // ============================================================================
@@ -138,72 +189,80 @@ bool protocol_has_system_error(uint32_t* error_code) {
  * Useful for debugging and monitoring.
  */
 void protocol_print_state_summary(void) {
+    // Copy of the last published state: callable from any task
+    static van_state_t snapshot;
+    if (protocol_get_van_state_snapshot(&snapshot) == 0) {
+        ESP_LOGI(TAG, "No van state published yet");
+        return;
+    }
+    const van_state_t* state = &snapshot;
+
     ESP_LOGI(TAG, "=== VAN STATE SUMMARY ===");
     
     // System
     ESP_LOGI(TAG, "System:");
-    ESP_LOGI(TAG, "  Uptime: %lu seconds", van_state.system.uptime);
+    ESP_LOGI(TAG, "  Uptime: %lu seconds", state->system.uptime);
     ESP_LOGI(TAG, "  Error: %s (code: 0x%lX)", 
-             van_state.system.system_error ? "YES" : "NO",
-             van_state.system.error_code);
+             state->system.system_error ? "YES" : "NO",
+             state->system.error_code);
     
     // Battery
     ESP_LOGI(TAG, "Battery:");
-    ESP_LOGI(TAG, "  Voltage: %.2fV", van_state.battery.voltage_mv / 1000.0f);
-    ESP_LOGI(TAG, "  Current: %.2fA", van_state.battery.current_ma / 1000.0f);
-    ESP_LOGI(TAG, "  Capacity: %lu mAh", van_state.battery.capacity_mah);
-    ESP_LOGI(TAG, "  SOC: %d%%", van_state.battery.soc_percent);
-    ESP_LOGI(TAG, "  Cell Count: %d", van_state.battery.cell_count);
-    ESP_LOGI(TAG, "  Cycle Count: %d", van_state.battery.cycle_count);
-    ESP_LOGI(TAG, "  Health: %d%%", van_state.battery.health_percent);
+    ESP_LOGI(TAG, "  Voltage: %.2fV", state->battery.voltage_mv / 1000.0f);
+    ESP_LOGI(TAG, "  Current: %.2fA", state->battery.current_ma / 1000.0f);
+    ESP_LOGI(TAG, "  Capacity: %lu mAh", state->battery.capacity_mah);
+    ESP_LOGI(TAG, "  SOC: %d%%", state->battery.soc_percent);
+    ESP_LOGI(TAG, "  Cell Count: %d", state->battery.cell_count);
+    ESP_LOGI(TAG, "  Cycle Count: %d", state->battery.cycle_count);
+    ESP_LOGI(TAG, "  Health: %d%%", state->battery.health_percent);
     
     // MPPT
     ESP_LOGI(TAG, "MPPT:");
     ESP_LOGI(TAG, "  100|50 Power: %.1fW @ %.2fV", 
-             van_state.mppt.solar_power_100_50,
-             van_state.mppt.battery_voltage_100_50);
+             state->mppt.solar_power_100_50,
+             state->mppt.battery_voltage_100_50);
     ESP_LOGI(TAG, "  70|15 Power: %.1fW @ %.2fV", 
-             van_state.mppt.solar_power_70_15,
-             van_state.mppt.battery_voltage_70_15);
+             state->mppt.solar_power_70_15,
+             state->mppt.battery_voltage_70_15);
     ESP_LOGI(TAG, "  Total Solar: %.1fW", 
-             van_state.mppt.solar_power_100_50 + van_state.mppt.solar_power_70_15);
+             state->mppt.solar_power_100_50 + state->mppt.solar_power_70_15);
     
     // Sensors
     ESP_LOGI(TAG, "Sensors:");
-    ESP_LOGI(TAG, "  Cabin Temp: %.1f°C", van_state.sensors.cabin_temperature);
-    ESP_LOGI(TAG, "  Exterior Temp: %.1f°C", van_state.sensors.exterior_temperature);
-    ESP_LOGI(TAG, "  Humidity: %.1f%%", van_state.sensors.humidity);
-    ESP_LOGI(TAG, "  CO2: %d ppm", van_state.sensors.co2_level);
-    ESP_LOGI(TAG, "  Door: %s", van_state.sensors.door_open ? "OPEN" : "CLOSED");
+    ESP_LOGI(TAG, "  Cabin Temp: %.1f°C", state->sensors.cabin_temperature);
+    ESP_LOGI(TAG, "  Exterior Temp: %.1f°C", state->sensors.exterior_temperature);
+    ESP_LOGI(TAG, "  Humidity: %.1f%%", state->sensors.humidity);
+    ESP_LOGI(TAG, "  CO2: %d ppm", state->sensors.co2_level);
+    ESP_LOGI(TAG, "  Door: %s", state->sensors.door_open ? "OPEN" : "CLOSED");
     
     // Heater
     ESP_LOGI(TAG, "Heater:");
-    ESP_LOGI(TAG, "  Status: %s", van_state.heater.heater_on ? "ON" : "OFF");
-    ESP_LOGI(TAG, "  Target Temp: %.1f°C", van_state.heater.target_air_temperature);
-    ESP_LOGI(TAG, "  Actual Temp: %.1f°C", van_state.heater.actual_air_temperature);
-    ESP_LOGI(TAG, "  Fuel Level: %d%%", van_state.heater.fuel_level_percent);
+    ESP_LOGI(TAG, "  Status: %s", state->heater.heater_on ? "ON" : "OFF");
+    ESP_LOGI(TAG, "  Target Temp: %.1f°C", state->heater.target_air_temperature);
+    ESP_LOGI(TAG, "  Actual Temp: %.1f°C", state->heater.actual_air_temperature);
+    ESP_LOGI(TAG, "  Fuel Level: %d%%", state->heater.fuel_level_percent);
     ESP_LOGI(TAG, "  Pump: %s, Fan: %d%%", 
-             van_state.heater.pump_active ? "ON" : "OFF",
-             van_state.heater.radiator_fan_speed);
+             state->heater.pump_active ? "ON" : "OFF",
+             state->heater.radiator_fan_speed);
     
     // LEDs
     ESP_LOGI(TAG, "LEDs:");
     ESP_LOGI(TAG, "  Roof1: %s, Mode: %d, Brightness: %d", 
-             van_state.leds.leds_roof1.enabled ? "ON" : "OFF",
-             van_state.leds.leds_roof1.current_mode,
-             van_state.leds.leds_roof1.brightness);
+             state->leds.leds_roof1.enabled ? "ON" : "OFF",
+             state->leds.leds_roof1.current_mode,
+             state->leds.leds_roof1.brightness);
     ESP_LOGI(TAG, "  Roof2: %s, Mode: %d, Brightness: %d", 
-             van_state.leds.leds_roof2.enabled ? "ON" : "OFF",
-             van_state.leds.leds_roof2.current_mode,
-             van_state.leds.leds_roof2.brightness);
+             state->leds.leds_roof2.enabled ? "ON" : "OFF",
+             state->leds.leds_roof2.current_mode,
+             state->leds.leds_roof2.brightness);
     ESP_LOGI(TAG, "  Front: %s, Mode: %d, Brightness: %d", 
-             van_state.leds.leds_av.enabled ? "ON" : "OFF",
-             van_state.leds.leds_av.current_mode,
-             van_state.leds.leds_av.brightness);
+             state->leds.leds_av.enabled ? "ON" : "OFF",
+             state->leds.leds_av.current_mode,
+             state->leds.leds_av.brightness);
     ESP_LOGI(TAG, "  Rear: %s, Mode: %d, Brightness: %d", 
-             van_state.leds.leds_ar.enabled ? "ON" : "OFF",
-             van_state.leds.leds_ar.current_mode,
-             van_state.leds.leds_ar.brightness);
+             state->leds.leds_ar.enabled ? "ON" : "OFF",
+             state->leds.leds_ar.current_mode,
+             state->leds.leds_ar.brightness);
     
     ESP_LOGI(TAG, "========================");
 }
\ No newline at end of file
@@ -23,6 +23,7 @@
 typedef enum {
     LED_STATIC,
     LED_DYNAMIC,
+    LED_SCENE,
 } led_type_t;
 
 // Cibles pour STATIC (Roof + Ext)
@@ -123,6 +124,22 @@ typedef struct {
     led_keyframe_t keyframes[];
 } led_dynamic_command_t;
 
+// =============================== LED SCENE COMMAND STRUCTURES ===============================
+
+#define LED_SCENE_SLOT_COUNT 8
+
+// Scène: instantané des 4 strips (mode, couleurs, luminosité, alim ext) stocké en NVS
+typedef enum {
+    LED_SCENE_RECALL,   // Réapplique la scène enregistrée
+    LED_SCENE_SAVE,     // Enregistre l'état actuel des strips
+    LED_SCENE_DELETE,   // Efface la scène
+} led_scene_action_t;
+
+typedef struct {
+    led_scene_action_t action;
+    uint8_t slot;       // 0 à LED_SCENE_SLOT_COUNT-1
+} led_scene_command_t;
+
 // ============================== LED FINAL COMMAND STRUCTURES ==============================
 
 typedef struct {
@@ -130,6 +147,7 @@ typedef struct {
     union {
         led_static_command_t static_cmd;
         led_dynamic_command_t* dynamic_cmd;
+        led_scene_command_t scene_cmd;
     } command;
 } led_command_t;
 
@@ -218,6 +236,33 @@ typedef enum {
     CHARGE_STATE_STORAGE,
 } charge_state_t;
 
+// LED strips of the van
+typedef enum {
+    LED_ROOF_STRIP_1,
+    LED_ROOF_STRIP_2,
+    LED_EXT_FRONT,
+    LED_EXT_BACK,
+    LED_STRIP_COUNT
+} led_strip_t;
+
+// Rolling timing statistics of a LED pipeline stage (microseconds)
+typedef struct {
+    uint16_t min_us;
+    uint16_t avg_us;
+    uint16_t max_us;
+    uint16_t p99_us;
+} led_timing_stats_t;
+
+// LED pipeline instrumentation of one strip
+typedef struct {
+    uint8_t fps;                    // Frames per second over the last report period
+    led_timing_stats_t render;      // Frame color computation
+    led_timing_stats_t convert;     // Scaling + write into the pixel buffer
+    led_timing_stats_t refresh;     // led_strip_refresh() (encoding + DMA)
+    led_timing_stats_t jitter;      // Frame start delay vs schedule
+    uint32_t missed_deadlines;      // Frames finished after their deadline (since boot)
+} led_strip_metrics_t;
+
 // Main PCB and devices state
 typedef struct {
     // ═══════════════════════════════════════════════════════════
@@ -385,6 +430,9 @@ typedef struct {
             uint8_t current_mode;
             uint8_t brightness;
         } leds_ar;
+
+        // Instrumentation du rendu, indexée par led_strip_t
+        led_strip_metrics_t metrics[LED_STRIP_COUNT];
     } leds;
     
     // ═══════════════════════════════════════════════════════════
@@ -412,6 +460,18 @@ typedef struct {
     // SLAVE PCB - Etat de la carte esclave
     // ═══════════════════════════════════════════════════════════
     slave_pcb_state_t slave_pcb;        // Etat complet du Slave PCB
+
+    // ═══════════════════════════════════════════════════════════
+    // TENDANCES - Agrégats glissants (telemetry_aggregator)
+    // ═══════════════════════════════════════════════════════════
+    struct {
+        float solar_wh_1m;              // Production solaire, dernière minute (Wh)
+        float solar_wh_15m;             // Production solaire, 15 dernières minutes (Wh)
+        float battery_ah_15m;           // Charge nette batterie, 15 min (Ah, <0 = décharge)
+        float consumption_ah_15m;       // Décharge batterie, 15 min (Ah)
+        float battery_voltage_min_15m;  // Tension batterie minimale, 15 min (V)
+        float tank_rate_lph[5];         // Variation des réservoirs A-E, 15 min (L/h, <0 = consommation)
+    } trends;
     
 } van_state_t;
 
@@ -431,13 +491,25 @@ esp_err_t protocol_init(void);
 /**
  * @brief Get pointer to the global van state
  * 
- * Returns a direct pointer to van_state_t for reading and updating.
- * Each manager should update only its own section.
+ * Returns a direct pointer to van_state_t for updating, from the update
+ * cycle only. Each manager should update only its own section.
+ * Other tasks read with protocol_get_van_state_snapshot().
  * 
  * @return Pointer to van_state_t structure (never NULL)
  */
 van_state_t* protocol_get_van_state(void);
 
+/**
+ * @brief Publish the updated state to the readers (end of the update cycle)
+ */
+void protocol_publish_van_state(void);
+
+/**
+ * @brief Copy the last published state, lock-free and consistent across sections
+ * @return Publication number of the copy (0 before the first)
+ */
+uint32_t protocol_get_van_state_snapshot(van_state_t* out);
+
 // ============================================================================
 // UTILITY FUNCTIONS
 // ============================================================================
@@ -1,17 +1,88 @@
 #include "uart_multiplexer.h"
+#include "freertos/task.h"
+#include "freertos/message_buffer.h"
+#include "driver/gpio.h"
+#include <string.h>
+#include <inttypes.h>
 
 
 static const char *TAG = "UART_MUX";
 
-// Mutexes to protect UART access
+// Mutex to protect UART0 access
 static SemaphoreHandle_t uart0_mutex = NULL;
-static SemaphoreHandle_t uart1_mutex = NULL;
-static SemaphoreHandle_t uart2_mutex = NULL;
 
+typedef struct {
+    const char *name;
+    uart_port_t port;
+    int tx_pin;                 // Our TX (UART_PIN_NO_CHANGE if not wired)
+    int rx_pin;
+    bool one_wire;              // TX and RX share the wire (open drain, half duplex)
+    uint32_t baud_rate;
+    uint16_t idle_gap_ms;       // Silence marking a frame boundary
+    uint16_t buffer_size;       // Frames waiting for the reader (bytes)
+    uint32_t default_slice_ms;
+} uart_mux_device_config_t;
 
-// Current device connected to each UART
-static mppt_device_t current_mppt_device = MPPT_100_50;
-static sensor_device_t current_sensor_device = SENSOR_HEATER;
+static const uart_mux_device_config_t device_configs[UART_MUX_DEVICE_COUNT] = {
+    [UART_MUX_MPPT_100_50] = {
+        .name = "MPPT 100|50", .port = UART_NUM_1, .tx_pin = VE_DIRECT_TX0, .rx_pin = VE_DIRECT_RX0,
+        .baud_rate = 19200, .idle_gap_ms = 50,
+        .buffer_size = 1024, .default_slice_ms = UART_MUX_SLICE_MPPT_MS,
+    },
+    [UART_MUX_MPPT_70_15] = {
+        .name = "MPPT 70|15", .port = UART_NUM_1, .tx_pin = VE_DIRECT_TX1, .rx_pin = VE_DIRECT_RX1,
+        .baud_rate = 19200, .idle_gap_ms = 50,
+        .buffer_size = 1024, .default_slice_ms = UART_MUX_SLICE_MPPT_MS,
+    },
+    [UART_MUX_HEATER] = {   // Polled once per second, listens in between (heater_protocol.h)
+        .name = "Heater", .port = UART_NUM_2, .tx_pin = HEATER_TX, .rx_pin = HEATER_TX, .one_wire = true,
+        .baud_rate = HEATER_BAUD_RATE, .idle_gap_ms = 20,
+        .buffer_size = 256, .default_slice_ms = UART_MUX_SLICE_HEATER_MS,
+    },
+    [UART_MUX_HCO2T] = {    // Polled: answers a request (htco2_protocol.h)
+        .name = "HCO2T", .port = UART_NUM_2, .tx_pin = HCO2T_TX, .rx_pin = HCO2T_TX, .one_wire = true,
+        .baud_rate = 115200, .idle_gap_ms = 20,
+        .buffer_size = 128, .default_slice_ms = UART_MUX_SLICE_HCO2T_MS,
+    },
+};
+
+// One shared UART and the devices taking turns on it
+typedef struct {
+    uart_port_t port;
+    uart_mux_device_t first, last;      // Devices of this UART (contiguous ids)
+    uart_mux_device_t active;
+    bool synced;                        // A boundary was seen since the switch
+    TickType_t slice_start;
+    TickType_t last_rx;
+    TickType_t frame_start;
+
+    uint8_t frame[UART_MUX_FRAME_MAX];
+    uint16_t frame_len;
+    bool frame_truncated;
+
+    // Line held by a client (uart_mux_acquire), protected by mux_lock
+    int hold_request;                   // Device requested, -1 if none
+    bool held;
+    SemaphoreHandle_t owner_mutex;      // One client at a time
+    SemaphoreHandle_t grant;
+
+    QueueHandle_t events;               // Driver event queue
+    TaskHandle_t task;
+} uart_mux_bus_t;
+
+static uart_mux_bus_t buses[] = {
+    { .port = UART_NUM_1, .first = UART_MUX_MPPT_100_50, .last = UART_MUX_MPPT_70_15 },
+    { .port = UART_NUM_2, .first = UART_MUX_HEATER, .last = UART_MUX_HCO2T },
+};
+#define BUS_COUNT (sizeof(buses) / sizeof(buses[0]))
+
+static MessageBufferHandle_t frame_buffers[UART_MUX_DEVICE_COUNT];
+static uint32_t slice_ms[UART_MUX_DEVICE_COUNT];
+static uart_mux_stats_t device_stats[UART_MUX_DEVICE_COUNT];
+static portMUX_TYPE mux_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Not a driver event: posted to the event queue to wake the scheduler
+#define UART_MUX_EVENT_WAKE UART_EVENT_MAX
 
 // UART configurations
 static uart_config_t com_uart_config = {
@@ -42,39 +113,315 @@ static uart_config_t sensor_uart_config = {
     .source_clk = UART_SCLK_DEFAULT
 };
 
+static uart_mux_bus_t* bus_of(uart_mux_device_t device) {
+    for (size_t b = 0; b < BUS_COUNT; b++) {
+        if (device >= buses[b].first && device <= buses[b].last) {
+            return &buses[b];
+        }
+    }
+    return NULL;
+}
+
+// ============================================================================
+// SCHEDULER
+// ============================================================================
+
+static void end_frame(uart_mux_bus_t *bus) {
+    uart_mux_stats_t *stats = &device_stats[bus->active];
+
+    if (bus->frame_truncated) {
+        stats->frames_truncated++;
+    } else if (xMessageBufferSend(frame_buffers[bus->active], bus->frame, bus->frame_len, 0) == 0) {
+        stats->frames_dropped++;
+    } else {
+        stats->frames++;
+    }
+    bus->frame_len = 0;
+    bus->frame_truncated = false;
+}
+
+// Hardware end-of-frame detection of the active device
+static void setup_frame_detection(uart_mux_bus_t *bus, const uart_mux_device_config_t *config) {
+    // UART_DATA with timeout_flag once the line is silent for idle_gap_ms
+    uint32_t symbols = config->idle_gap_ms * config->baud_rate / 10 / 1000;
+    if (symbols > UART_MUX_RX_TOUT_MAX) symbols = UART_MUX_RX_TOUT_MAX;
+    if (symbols < 1) symbols = 1;
+    uart_set_rx_timeout(bus->port, (uint8_t)symbols);
+}
+
+static void switch_to(uart_mux_bus_t *bus, uart_mux_device_t device, TickType_t now) {
+    const uart_mux_device_config_t *config = &device_configs[device];
+
+    portENTER_CRITICAL(&mux_lock);
+    device_stats[bus->active].active_ms += pdTICKS_TO_MS(now - bus->slice_start);
+    if (bus->frame_len > 0) {
+        // Cut in the middle of a frame
+        device_stats[bus->active].frames_truncated++;
+        device_stats[bus->active].forced_switches++;
+    }
+    device_stats[device].slices++;
+    portEXIT_CRITICAL(&mux_lock);
+
+    if (bus->active != device) {
+        const uart_mux_device_config_t *previous = &device_configs[bus->active];
+        ESP_LOGD(TAG, "UART%d -> %s (RX pin %d)", bus->port, config->name, config->rx_pin);
+        if (previous->tx_pin != UART_PIN_NO_CHANGE && previous->tx_pin != config->tx_pin) {
+            // uart_set_pin() does not detach the previous TX pin
+            gpio_reset_pin(previous->tx_pin);
+        }
+        uart_set_pin(bus->port, config->tx_pin, config->rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+        if (config->one_wire) {
+            // The device answers on the wire we transmit on (our bytes are echoed)
+            gpio_set_direction(config->rx_pin, GPIO_MODE_INPUT_OUTPUT_OD);
+            gpio_set_pull_mode(config->rx_pin, GPIO_PULLUP_ONLY);
+        }
+        uart_set_baudrate(bus->port, config->baud_rate);
+        setup_frame_detection(bus, config);
+        uart_flush_input(bus->port);
+        // Events of the previous device are meaningless now
+        xQueueReset(bus->events);
+    }
+
+    bus->active = device;
+    bus->synced = false;
+    bus->frame_len = 0;
+    bus->frame_truncated = false;
+    bus->slice_start = now;
+    bus->last_rx = now;
+}
+
+// Next device of the plan with a time slice (the active one if it is alone)
+static uart_mux_device_t next_in_plan(const uart_mux_bus_t *bus) {
+    uart_mux_device_t device = bus->active;
+    for (int i = 0; i <= bus->last - bus->first; i++) {
+        device = (device == bus->last) ? bus->first : device + 1;
+        if (slice_ms[device] > 0) return device;
+    }
+    return bus->active;
+}
+
+// Frame boundary reached, or the current frame is hopeless
+static bool can_switch(const uart_mux_bus_t *bus, TickType_t now) {
+    return bus->frame_len == 0 || (now - bus->frame_start) >= pdMS_TO_TICKS(UART_MUX_MAX_FRAME_MS);
+}
+
+// Bytes arriving after a silence start a frame
+static void check_sync(uart_mux_bus_t *bus, TickType_t now) {
+    const uart_mux_device_config_t *config = &device_configs[bus->active];
+    if (!bus->synced && (now - bus->last_rx) >= pdMS_TO_TICKS(config->idle_gap_ms)) {
+        bus->synced = true;
+    }
+    bus->last_rx = now;
+}
+
+static void append_bytes(uart_mux_bus_t *bus, const uint8_t *data, int len, TickType_t now) {
+    if (!bus->synced) {
+        device_stats[bus->active].bytes_discarded += len;
+        return;
+    }
+    if (bus->frame_len == 0) bus->frame_start = now;
+
+    int room = UART_MUX_FRAME_MAX - bus->frame_len;
+    if (len > room) {
+        len = room;
+        bus->frame_truncated = true;
+    }
+    memcpy(&bus->frame[bus->frame_len], data, len);
+    bus->frame_len += len;
+}
+
+// Read what the driver has, the frame ends on the RX timeout
+static void handle_data(uart_mux_bus_t *bus, const uart_event_t *event, TickType_t now) {
+    uint8_t data[128];
+    size_t pending = event->size;
+
+    check_sync(bus, now);
+    while (pending > 0) {
+        int len = uart_read_bytes(bus->port, data, pending < sizeof(data) ? pending : sizeof(data), 0);
+        if (len <= 0) break;
+        append_bytes(bus, data, len, now);
+        pending -= len;
+    }
+
+    if (event->timeout_flag) {
+        if (bus->frame_len > 0) end_frame(bus);
+        bus->synced = true;
+    }
+}
+
+static void handle_event(uart_mux_bus_t *bus, const uart_event_t *event, TickType_t now) {
+    const uart_mux_device_config_t *config = &device_configs[bus->active];
+
+    switch (event->type) {
+        case UART_DATA:
+            handle_data(bus, event, now);
+            break;
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            ESP_LOGW(TAG, "UART%d overflow on %s", bus->port, config->name);
+            uart_flush_input(bus->port);
+            xQueueReset(bus->events);
+            if (bus->frame_len > 0) bus->frame_truncated = true;
+            bus->synced = false;
+            break;
+        default:
+            break;                  // UART_MUX_EVENT_WAKE, line errors
+    }
+}
+
+// Apply hold requests and the time-slice plan
+static void schedule_bus(uart_mux_bus_t *bus, TickType_t now) {
+    const uart_mux_device_config_t *config = &device_configs[bus->active];
+
+    // Silence while waiting: frame complete, line synced
+    if ((now - bus->last_rx) >= pdMS_TO_TICKS(config->idle_gap_ms)) {
+        if (bus->frame_len > 0) end_frame(bus);
+        bus->synced = true;
+    }
+
+    portENTER_CRITICAL(&mux_lock);
+    int request = bus->hold_request;
+    bool held = bus->held;
+    portEXIT_CRITICAL(&mux_lock);
+
+    if (held) return;
+
+    if (request >= 0) {
+        if (bus->active != (uart_mux_device_t)request) {
+            if (!can_switch(bus, now)) return;
+            switch_to(bus, (uart_mux_device_t)request, now);
+        }
+        if (!bus->synced) {
+            // The client speaks first: its echo and the answer come within the
+            // idle gap, waiting for a silence would discard them
+            uart_flush_input(bus->port);
+            bus->frame_len = 0;
+            bus->frame_truncated = false;
+            bus->synced = true;
+        }
+        portENTER_CRITICAL(&mux_lock);
+        bus->held = true;
+        portEXIT_CRITICAL(&mux_lock);
+        xSemaphoreGive(bus->grant);
+        return;
+    }
+
+    uint32_t slice = slice_ms[bus->active];
+    bool expired = slice == 0 || (now - bus->slice_start) >= pdMS_TO_TICKS(slice);
+    if (expired && can_switch(bus, now)) {
+        uart_mux_device_t next = next_in_plan(bus);
+        if (next != bus->active) {
+            switch_to(bus, next, now);
+        } else if (slice_ms[next] > 0) {
+            // Alone in the plan: keep the line and its sync, only start a new slice
+            portENTER_CRITICAL(&mux_lock);
+            device_stats[bus->active].active_ms += pdTICKS_TO_MS(now - bus->slice_start);
+            portEXIT_CRITICAL(&mux_lock);
+            bus->slice_start = now;
+        }
+    }
+}
+
+// Time until the scheduler has something to decide without any event
+static TickType_t next_wait(const uart_mux_bus_t *bus, TickType_t now) {
+    const uart_mux_device_config_t *config = &device_configs[bus->active];
+    TickType_t wait = portMAX_DELAY;
+
+    portENTER_CRITICAL(&mux_lock);
+    bool held = bus->held;
+    bool requested = bus->hold_request >= 0;
+    portEXIT_CRITICAL(&mux_lock);
+
+    if (!held) {
+        uint32_t slice = slice_ms[bus->active];
+        TickType_t elapsed = now - bus->slice_start;
+        if (requested || slice == 0 || elapsed >= pdMS_TO_TICKS(slice)) {
+            // Waiting for a boundary
+            wait = pdMS_TO_TICKS(UART_MUX_TICK_MS);
+        } else {
+            wait = pdMS_TO_TICKS(slice) - elapsed;
+        }
+    }
+    if (!bus->synced || bus->frame_len > 0) {
+        // Silence detection when the driver gives no RX timeout event
+        TickType_t gap = pdMS_TO_TICKS(config->idle_gap_ms);
+        if (gap < wait) wait = gap;
+    }
+    return (wait > 0) ? wait : 1;
+}
+
+static void uart_mux_bus_task(void *parameters) {
+    uart_mux_bus_t *bus = (uart_mux_bus_t *)parameters;
+    ESP_LOGI(TAG, "UART%d multiplexer scheduler started", bus->port);
+
+    while (1) {
+        uart_event_t event;
+        TickType_t wait = next_wait(bus, xTaskGetTickCount());
+        if (xQueueReceive(bus->events, &event, wait) == pdTRUE) {
+            handle_event(bus, &event, xTaskGetTickCount());
+        }
+        schedule_bus(bus, xTaskGetTickCount());
+    }
+}
+
+// Wake the scheduler of a bus (hold request or release)
+static void wake_bus(uart_mux_bus_t *bus) {
+    uart_event_t event = { .type = UART_MUX_EVENT_WAKE };
+    xQueueSend(bus->events, &event, 0);
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
 esp_err_t uart_multiplexer_init(void) {
     esp_err_t ret;
-    
+
     // Create mutexes
     uart0_mutex = xSemaphoreCreateMutex();
-    uart1_mutex = xSemaphoreCreateMutex();
-    uart2_mutex = xSemaphoreCreateMutex();
-
-    if (uart0_mutex == NULL || uart1_mutex == NULL || uart2_mutex == NULL) {
+    if (uart0_mutex == NULL) {
         ESP_LOGE(TAG, "Failed to create mutexes");
         return ESP_FAIL;
     }
+    for (size_t b = 0; b < BUS_COUNT; b++) {
+        buses[b].owner_mutex = xSemaphoreCreateMutex();
+        buses[b].grant = xSemaphoreCreateBinary();
+        buses[b].hold_request = -1;
+        if (buses[b].owner_mutex == NULL || buses[b].grant == NULL) {
+            ESP_LOGE(TAG, "Failed to create mutexes");
+            return ESP_FAIL;
+        }
+    }
+    for (int d = 0; d < UART_MUX_DEVICE_COUNT; d++) {
+        frame_buffers[d] = xMessageBufferCreate(device_configs[d].buffer_size);
+        if (frame_buffers[d] == NULL) {
+            ESP_LOGE(TAG, "Failed to create frame buffer for %s", device_configs[d].name);
+            return ESP_ERR_NO_MEM;
+        }
+        slice_ms[d] = device_configs[d].default_slice_ms;
+    }
+
     // Install UART0 driver for general communication
     ret = uart_driver_install(UART_NUM_0, 1024, 0, 0, NULL, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to install UART0 driver");
         return ret;
     }
-    
+
     // Install UART1 driver for MPPT devices
-    ret = uart_driver_install(UART_NUM_1, 1024, 0, 0, NULL, 0);
+    ret = uart_driver_install(UART_NUM_1, 1024, 0, UART_MUX_EVENT_QUEUE_SIZE, &buses[0].events, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to install UART1 driver");
         return ret;
     }
-    
+
     // Install UART2 driver for sensor devices
-    ret = uart_driver_install(UART_NUM_2, 1024, 0, 0, NULL, 0);
+    ret = uart_driver_install(UART_NUM_2, 1024, 0, UART_MUX_EVENT_QUEUE_SIZE, &buses[1].events, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to install UART2 driver");
         return ret;
     }
-    
+
     // Configure UART0 for general communication
     ret = uart_param_config(UART_NUM_0, &com_uart_config);
     if (ret != ESP_OK) {
@@ -87,122 +434,172 @@ esp_err_t uart_multiplexer_init(void) {
         return ret;
     }
 
-    // Configure UART1 for MPPT (start with MPPT 100|50)
+    // Configure UART1 for MPPT
     ret = uart_param_config(UART_NUM_1, &mppt_uart_config);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure UART1");
         return ret;
     }
-    
-    ret = uart_set_pin(UART_NUM_1, UART_PIN_NO_CHANGE, VE_DIRECT_RX0, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set UART1 pins");
-        return ret;
-    }
-    
-    // Configure UART2 for sensors (start with heater)
+
+    // Configure UART2 for sensors
     ret = uart_param_config(UART_NUM_2, &sensor_uart_config);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure UART2");
         return ret;
     }
-    
-    ret = uart_set_pin(UART_NUM_2, UART_PIN_NO_CHANGE, HEATER_TX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set UART2 pins");
-        return ret;
+
+    // Pins are set by the scheduler, starting with the first device of each UART
+    TickType_t now = xTaskGetTickCount();
+    for (size_t b = 0; b < BUS_COUNT; b++) {
+        buses[b].active = buses[b].last;    // Forces the pin setup below
+        buses[b].slice_start = now;
+        switch_to(&buses[b], buses[b].first, now);
+    }
+    memset(device_stats, 0, sizeof(device_stats));
+    for (size_t b = 0; b < BUS_COUNT; b++) {
+        device_stats[buses[b].first].slices = 1;
     }
-    
+
+    // One scheduler per UART, woken by its driver events
+    for (size_t b = 0; b < BUS_COUNT; b++) {
+        BaseType_t result = xTaskCreatePinnedToCore(
+            uart_mux_bus_task,
+            (b == 0) ? "uart_mux1" : "uart_mux2",
+            4096,
+            &buses[b],
+            6,
+            &buses[b].task,
+            1  // CPU1
+        );
+        if (result != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create UART multiplexer task");
+            return ESP_FAIL;
+        }
+    }
+
     ESP_LOGI(TAG, "UART multiplexer initialized");
     return ESP_OK;
 }
 
-esp_err_t uart_mux_switch_mppt(mppt_device_t device) {
-    if (xSemaphoreTake(uart1_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
-        ESP_LOGW(TAG, "Failed to take UART1 mutex");
+// ============================================================================
+// CLIENT API
+// ============================================================================
+
+int uart_mux_receive(uart_mux_device_t device, uint8_t *data, size_t max_len, uint32_t timeout_ms) {
+    if (device >= UART_MUX_DEVICE_COUNT || !data) {
+        return -1;
+    }
+    return (int)xMessageBufferReceive(frame_buffers[device], data, max_len, pdMS_TO_TICKS(timeout_ms));
+}
+
+esp_err_t uart_mux_acquire(uart_mux_device_t device, uint32_t timeout_ms) {
+    uart_mux_bus_t *bus = bus_of(device);
+    if (!bus) return ESP_ERR_INVALID_ARG;
+
+    TickType_t start = xTaskGetTickCount();
+    if (xSemaphoreTake(bus->owner_mutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
         return ESP_ERR_TIMEOUT;
     }
-    
-    if (current_mppt_device == device) {
-        xSemaphoreGive(uart1_mutex);
-        return ESP_OK; // Already connected to this device
-    }
-    
-    esp_err_t ret = ESP_OK;
-    
-    // Flush any pending data
-    uart_flush(UART_NUM_1);
-    
-    // Switch pins based on device
-    switch (device) {
-        case MPPT_100_50:
-            ESP_LOGI(TAG, "Switching UART1 to MPPT 100|50 (RX pin %d)", VE_DIRECT_RX0);
-            ret = uart_set_pin(UART_NUM_1, UART_PIN_NO_CHANGE, VE_DIRECT_RX0, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-            break;
-        case MPPT_70_15:
-            ESP_LOGI(TAG, "Switching UART1 to MPPT 70|15 (RX pin %d)", VE_DIRECT_RX1);
-            ret = uart_set_pin(UART_NUM_1, UART_PIN_NO_CHANGE, VE_DIRECT_RX1, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-            break;
-        default:
-            ret = ESP_ERR_INVALID_ARG;
-            break;
+
+    portENTER_CRITICAL(&mux_lock);
+    bus->hold_request = device;
+    portEXIT_CRITICAL(&mux_lock);
+    wake_bus(bus);
+
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    TickType_t remaining = (elapsed < pdMS_TO_TICKS(timeout_ms)) ? pdMS_TO_TICKS(timeout_ms) - elapsed : 0;
+    if (xSemaphoreTake(bus->grant, remaining) == pdTRUE) {
+        return ESP_OK;
     }
-    
-    if (ret == ESP_OK) {
-        current_mppt_device = device;
-        ESP_LOGD(TAG, "Successfully switched UART1 to MPPT device %d", device);
-        // Small delay to ensure pin switching is complete
-        vTaskDelay(pdMS_TO_TICKS(10));
-    } else {
-        ESP_LOGE(TAG, "Failed to switch UART1 to MPPT device %d: %s", device, esp_err_to_name(ret));
+
+    // The scheduler may have granted the line right after the timeout
+    portENTER_CRITICAL(&mux_lock);
+    bool granted = bus->held;
+    if (!granted) bus->hold_request = -1;
+    portEXIT_CRITICAL(&mux_lock);
+    if (granted) {
+        xSemaphoreTake(bus->grant, 0);
+        return ESP_OK;
+    }
+
+    xSemaphoreGive(bus->owner_mutex);
+    ESP_LOGW(TAG, "Timeout waiting for the line to %s", device_configs[device].name);
+    return ESP_ERR_TIMEOUT;
+}
+
+void uart_mux_release(uart_mux_device_t device) {
+    uart_mux_bus_t *bus = bus_of(device);
+    if (!bus) return;
+
+    portENTER_CRITICAL(&mux_lock);
+    bool was_held = bus->held && bus->hold_request == (int)device;
+    if (was_held) {
+        bus->held = false;
+        bus->hold_request = -1;
+    }
+    portEXIT_CRITICAL(&mux_lock);
+
+    if (was_held) {
+        xSemaphoreGive(bus->owner_mutex);
+        wake_bus(bus);
     }
-    
-    xSemaphoreGive(uart1_mutex);
-    return ret;
 }
 
-esp_err_t uart_mux_switch_sensor(sensor_device_t device) {
-    if (xSemaphoreTake(uart2_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
-        ESP_LOGW(TAG, "Failed to take UART2 mutex");
-        return ESP_ERR_TIMEOUT;
+bool uart_mux_has_tx(uart_mux_device_t device) {
+    if (device >= UART_MUX_DEVICE_COUNT) return false;
+    return device_configs[device].tx_pin != UART_PIN_NO_CHANGE;
+}
+
+int uart_mux_write(uart_mux_device_t device, const uint8_t *data, size_t len) {
+    uart_mux_bus_t *bus = bus_of(device);
+    if (!bus || !uart_mux_has_tx(device)) {
+        return -1;
     }
-    
-    if (current_sensor_device == device) {
-        xSemaphoreGive(uart2_mutex);
-        return ESP_OK; // Already connected to this device
-    }
-    
-    esp_err_t ret = ESP_OK;
-    
-    // Flush any pending data
-    uart_flush(UART_NUM_2);
-    
-    // Switch pins based on device  
-    switch (device) {
-        case SENSOR_HEATER:
-            ESP_LOGI(TAG, "Switching UART2 to Heater (RX pin %d)", HEATER_TX);
-            ret = uart_set_pin(UART_NUM_2, UART_PIN_NO_CHANGE, HEATER_TX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-            break;
-        case SENSOR_HCO2T:
-            ESP_LOGI(TAG, "Switching UART2 to HCO2T sensor (RX pin %d)", HCO2T_TX);
-            ret = uart_set_pin(UART_NUM_2, UART_PIN_NO_CHANGE, HCO2T_TX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-            break;
-        default:
-            ret = ESP_ERR_INVALID_ARG;
-            break;
+
+    portENTER_CRITICAL(&mux_lock);
+    bool owner = bus->held && bus->hold_request == (int)device;
+    portEXIT_CRITICAL(&mux_lock);
+    if (!owner) {
+        ESP_LOGW(TAG, "Write to %s without holding the line", device_configs[device].name);
+        return -1;
     }
-    
-    if (ret == ESP_OK) {
-        current_sensor_device = device;
-        ESP_LOGD(TAG, "Successfully switched UART2 to sensor device %d", device);
-        // Small delay to ensure pin switching is complete
-        vTaskDelay(pdMS_TO_TICKS(10));
-    } else {
-        ESP_LOGE(TAG, "Failed to switch UART2 to sensor device %d: %s", device, esp_err_to_name(ret));
+
+    return uart_write_bytes(bus->port, data, len);
+}
+
+void uart_mux_set_slice(uart_mux_device_t device, uint32_t new_slice_ms) {
+    if (device >= UART_MUX_DEVICE_COUNT) return;
+    slice_ms[device] = new_slice_ms;
+}
+
+esp_err_t uart_mux_get_stats(uart_mux_device_t device, uart_mux_stats_t *stats) {
+    if (device >= UART_MUX_DEVICE_COUNT || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uart_mux_bus_t *bus = bus_of(device);
+
+    portENTER_CRITICAL(&mux_lock);
+    *stats = device_stats[device];
+    if (bus->active == device) {
+        // Include the current slice
+        stats->active_ms += pdTICKS_TO_MS(xTaskGetTickCount() - bus->slice_start);
+    }
+    portEXIT_CRITICAL(&mux_lock);
+    return ESP_OK;
+}
+
+void uart_mux_print_stats(void) {
+    for (int d = 0; d < UART_MUX_DEVICE_COUNT; d++) {
+        uart_mux_stats_t stats;
+        uart_mux_get_stats(d, &stats);
+
+        // Frames per minute of line time
+        uint32_t yield = stats.active_ms ? (uint32_t)((uint64_t)stats.frames * 60000 / stats.active_ms) : 0;
+        ESP_LOGI(TAG, "%-12s frames:%" PRIu32 " (%" PRIu32 "/min on line) dropped:%" PRIu32 " truncated:%" PRIu32
+                 " discarded:%" PRIu32 "B slices:%" PRIu32 " forced:%" PRIu32,
+                 device_configs[d].name, stats.frames, yield, stats.frames_dropped, stats.frames_truncated,
+                 stats.bytes_discarded, stats.slices, stats.forced_switches);
     }
-    
-    xSemaphoreGive(uart2_mutex);
-    return ret;
 }
 
 // void uart_com_reader_task(void *pvParameters) {
@@ -225,31 +622,3 @@ bool uart_com_reader() {
     }
     return false;
 }
-
-int uart_mux_read_mppt(uint8_t *data, size_t max_len, uint32_t timeout_ms) {
-    if (xSemaphoreTake(uart1_mutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
-        ESP_LOGW(TAG, "Failed to take UART1 mutex for read");
-        return -1;
-    }
-    
-    ESP_LOGD(TAG, "Reading from UART1 (current device: %d), timeout: %lu ms", current_mppt_device, timeout_ms);
-    int len = uart_read_bytes(UART_NUM_1, data, max_len, pdMS_TO_TICKS(timeout_ms));
-    ESP_LOGD(TAG, "UART1 read returned %d bytes", len);
-    
-    xSemaphoreGive(uart1_mutex);
-    return len;
-}
-
-int uart_mux_read_sensor(uint8_t *data, size_t max_len, uint32_t timeout_ms) {
-    if (xSemaphoreTake(uart2_mutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
-        ESP_LOGW(TAG, "Failed to take UART2 mutex for read");
-        return -1;
-    }
-    
-    ESP_LOGD(TAG, "Reading from UART2 (current device: %d), timeout: %lu ms", current_sensor_device, timeout_ms);
-    int len = uart_read_bytes(UART_NUM_2, data, max_len, pdMS_TO_TICKS(timeout_ms));
-    ESP_LOGD(TAG, "UART2 read returned %d bytes", len);
-    
-    xSemaphoreGive(uart2_mutex);
-    return len;
-}
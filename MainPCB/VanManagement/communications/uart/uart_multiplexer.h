@@ -9,56 +9,104 @@
 // #include "log_level.h"
 
 #include "../../peripherals_devices/mppt_manager.h"
+#include "../../peripherals_devices/heater_protocol.h"
 #include "../../common_includes/gpio_pinout.h"
 
-// Use the same MPPT device enum from mppt_manager.h
-typedef mppt_id_t mppt_device_t;
+// UART1 is shared by the two MPPTs, UART2 by the heater and the HCO2T sensor.
+// A scheduler task owns both UARTs: each device gets the line for its time
+// slice, the line is switched only between two frames, and every complete
+// frame is delivered to the device's own buffer.
 
-// UART multiplexer for sensor devices (UART2)  
 typedef enum {
-    SENSOR_HEATER = 0,
-    SENSOR_HCO2T  = 1
-} sensor_device_t;
+    UART_MUX_MPPT_100_50 = 0,       // UART1 (same order as mppt_id_t)
+    UART_MUX_MPPT_70_15,            // UART1
+    UART_MUX_HEATER,                // UART2
+    UART_MUX_HCO2T,                 // UART2
+    UART_MUX_DEVICE_COUNT
+} uart_mux_device_t;
+
+#define UART_MUX_MPPT(id) ((uart_mux_device_t)(UART_MUX_MPPT_100_50 + (id)))
+
+// Default time slices (ms). VE.Direct sends a block every second. The HCO2T
+// sensor only talks when asked, so it only gets the line through uart_mux_acquire().
+#define UART_MUX_SLICE_MPPT_MS    1200
+#define UART_MUX_SLICE_HEATER_MS  1000    // Listening between the heater polls
+#define UART_MUX_SLICE_HCO2T_MS   0
+
+#define UART_MUX_TICK_MS          10      // Re-check period while waiting for a frame boundary
+#define UART_MUX_EVENT_QUEUE_SIZE 20      // Driver events (UART_DATA, overflows...)
+#define UART_MUX_RX_TOUT_MAX      100     // Longest RX timeout accepted by the UART (symbols)
+#define UART_MUX_FRAME_MAX        512     // Longest frame (VE.Direct text block)
+#define UART_MUX_MAX_FRAME_MS     1000    // A frame still incomplete after this is cut to switch
+
+// Frame yield of a device
+typedef struct {
+    uint32_t frames;                // Complete frames delivered
+    uint32_t frames_dropped;        // Complete frames lost because the reader was too slow
+    uint32_t frames_truncated;      // Frames cut (too long, or switch forced)
+    uint32_t bytes_discarded;       // Bytes received before the first boundary of a slice
+    uint32_t slices;                // Times the device got the line
+    uint32_t forced_switches;       // Slices that could not end on a boundary
+    uint32_t active_ms;             // Total time on the line
+} uart_mux_stats_t;
 
 /**
- * @brief Initialize UART multiplexers
+ * @brief Initialize UART drivers and start the scheduler task
  */
 esp_err_t uart_multiplexer_init(void);
 
 /**
- * @brief Switch UART1 to specified MPPT device
- * @param device MPPT device to connect
- * @return ESP_OK on success
+ * @brief Receive the next complete frame of a device
+ * @param device Device
+ * @param data Buffer to store the frame
+ * @param max_len Size of the buffer (UART_MUX_FRAME_MAX holds any frame)
+ * @param timeout_ms Timeout in milliseconds
+ * @return Length of the frame, 0 on timeout
  */
-esp_err_t uart_mux_switch_mppt(mppt_device_t device);
+int uart_mux_receive(uart_mux_device_t device, uint8_t *data, size_t max_len, uint32_t timeout_ms);
 
 /**
- * @brief Switch UART2 to specified sensor device  
- * @param device Sensor device to connect
- * @return ESP_OK on success
+ * @brief Keep the line on a device (switched at the next frame boundary)
+ *
+ * Needed to send a command and wait for its answer. Must be followed by
+ * uart_mux_release() from the same task.
+ * @return ESP_OK when the line is on the device, ESP_ERR_TIMEOUT otherwise
  */
-esp_err_t uart_mux_switch_sensor(sensor_device_t device);
+esp_err_t uart_mux_acquire(uart_mux_device_t device, uint32_t timeout_ms);
 
-// void uart_com_reader_task(void *pvParameters);
-bool uart_com_reader(void);
+/**
+ * @brief Give the line back to the time-slice plan
+ */
+void uart_mux_release(uart_mux_device_t device);
+
+/**
+ * @brief Check if a TX line is wired to a device (VE_DIRECT_TXx for the MPPTs)
+ * @return true if commands can be sent to the device
+ */
+bool uart_mux_has_tx(uart_mux_device_t device);
 
+/**
+ * @brief Write data to a device held with uart_mux_acquire()
+ * @return Number of bytes written, or -1 on error
+ */
+int uart_mux_write(uart_mux_device_t device, const uint8_t *data, size_t len);
 
 /**
- * @brief Read data from current MPPT device on UART1
- * @param data Buffer to store data
- * @param max_len Maximum length to read
- * @param timeout_ms Timeout in milliseconds
- * @return Number of bytes read, or -1 on error
+ * @brief Change the time slice of a device (0 = only when acquired)
  */
-int uart_mux_read_mppt(uint8_t *data, size_t max_len, uint32_t timeout_ms);
+void uart_mux_set_slice(uart_mux_device_t device, uint32_t slice_ms);
 
 /**
- * @brief Read data from current sensor device on UART2
- * @param data Buffer to store data
- * @param max_len Maximum length to read  
- * @param timeout_ms Timeout in milliseconds
- * @return Number of bytes read, or -1 on error
+ * @brief Get the frame yield statistics of a device
  */
-int uart_mux_read_sensor(uint8_t *data, size_t max_len, uint32_t timeout_ms);
+esp_err_t uart_mux_get_stats(uart_mux_device_t device, uart_mux_stats_t *stats);
+
+/**
+ * @brief Log the frame yield of every device
+ */
+void uart_mux_print_stats(void);
+
+// void uart_com_reader_task(void *pvParameters);
+bool uart_com_reader(void);
 
 #endif // UART_MULTIPLEXER_H
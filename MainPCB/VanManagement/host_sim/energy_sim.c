@@ -0,0 +1,299 @@
+/**
+ * @file energy_sim.c
+ * @brief Accelerated host run of the energy simulation
+ *
+ * Runs the device code of the energy chain (energy_simulation.c, simulated
+ * MPPT, inverter/chargers and battery) tick by tick, as update_van_state()
+ * does once per second on the van, without waiting. Writes a CSV trace and
+ * compares it with a golden trace.
+ *
+ * The load profile repeats every SIM_TICKS_PER_DAY ticks (a "model day"),
+ * but the device, like this run, integrates the battery at 1 s per tick: a
+ * model day lasts 40 minutes of device time, and the energy totals are for
+ * that duration.
+ *
+ * Usage: energy_sim [--days N] [--ticks N] [--seed S] [--every K]
+ *                   [--csv FILE] [--golden FILE] [--tolerance T] [--verbose]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "../peripherals_devices/energy_simulation.h"
+#include "../peripherals_devices/mppt_manager.h"
+#include "../peripherals_devices/inverter_chargers_manager.h"
+#include "../peripherals_devices/battery_manager.h"
+
+extern bool host_log_verbose;
+
+#define SIM_TICKS_PER_DAY   2400        // Model day: load profile period of inverter_chargers_manager.c
+#define SIM_TICK_US         1000000LL   // One update_van_state() per second on the device
+#define SIM_LINE_MAX        512
+#define SIM_COLUMNS_MAX     16
+
+static const char *CSV_HEADER =
+    "tick,day_cycle,ac_mains,engine,solar_w,ac_charge_w,alternator_w,load_12v_w,load_220v_w,"
+    "battery_a,battery_v,soc_percent";
+
+typedef struct {
+    uint32_t ticks;
+    uint32_t every;
+    unsigned int seed;
+    const char *csv_path;
+    const char *golden_path;
+    double tolerance;               // Relative, plus the same value absolute
+} sim_options_t;
+
+typedef struct {
+    double solar_wh;
+    double ac_wh;
+    double alternator_wh;
+    double load_wh;
+    double soc_start;
+    double soc_min;
+    double soc_max;
+} sim_totals_t;
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "Usage: %s [--days N] [--ticks N] [--seed S] [--every K] [--csv FILE]\n"
+            "          [--golden FILE] [--tolerance T] [--verbose]\n"
+            "  --days N       simulated model days of %d ticks (default 7)\n"
+            "  --ticks N      simulated ticks (1 tick = 1 device update)\n"
+            "  --seed S       seed of the random loads (default 1)\n"
+            "  --every K      write one CSV row every K ticks (default 100)\n"
+            "  --csv FILE     CSV trace (default stdout, '-' = stdout)\n"
+            "  --golden FILE  compare the trace with this golden CSV (exit 1 if different)\n"
+            "  --tolerance T  relative and absolute tolerance of the comparison (default 1e-3)\n"
+            "  --verbose      print the ESP_LOG output of the managers\n",
+            name, SIM_TICKS_PER_DAY);
+}
+
+static int parse_options(int argc, char **argv, sim_options_t *opt) {
+    *opt = (sim_options_t){
+        .ticks = 7 * SIM_TICKS_PER_DAY,
+        .every = 100,
+        .seed = 1,
+        .csv_path = "-",
+        .tolerance = 1e-3,
+    };
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--verbose") == 0) {
+            host_log_verbose = true;
+            continue;
+        }
+        if (!value) {
+            usage(argv[0]);
+            return -1;
+        }
+        if (strcmp(arg, "--days") == 0) {
+            opt->ticks = (uint32_t)(atof(value) * SIM_TICKS_PER_DAY);
+        } else if (strcmp(arg, "--ticks") == 0) {
+            opt->ticks = (uint32_t)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--seed") == 0) {
+            opt->seed = (unsigned int)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--every") == 0) {
+            opt->every = (uint32_t)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--csv") == 0) {
+            opt->csv_path = value;
+        } else if (strcmp(arg, "--golden") == 0) {
+            opt->golden_path = value;
+        } else if (strcmp(arg, "--tolerance") == 0) {
+            opt->tolerance = atof(value);
+        } else {
+            usage(argv[0]);
+            return -1;
+        }
+        i++;
+    }
+    if (opt->every == 0) {
+        opt->every = 1;
+    }
+    return 0;
+}
+
+// One device update cycle of the energy chain (same order as main.c)
+static void sim_step(van_state_t *van_state) {
+    energy_simulation_update_time();
+    mppt_manager_update_van_state(van_state);
+    inverter_chargers_manager_update_van_state(van_state);
+    battery_manager_update_van_state(van_state);
+    host_clock_advance_us(SIM_TICK_US);
+}
+
+static void format_row(char *line, size_t size, const energy_simulation_context_t *ctx) {
+    snprintf(line, size, "%lu,%.4f,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.4f,%.4f",
+             (unsigned long)ctx->time_ticks, ctx->day_cycle, ctx->ac_mains_available, ctx->engine_running,
+             ctx->solar_power_w, ctx->ac_charger_power_w, ctx->alternator_power_w,
+             ctx->load_12v_w, ctx->load_220v_w,
+             ctx->battery_net_current_a, ctx->battery_voltage_v, ctx->battery_soc_percent);
+}
+
+// ============================================================================
+// GOLDEN COMPARISON
+// ============================================================================
+
+static int split_columns(char *line, double *values, int max) {
+    int count = 0;
+    char *save = NULL;
+    for (char *tok = strtok_r(line, ",\r\n", &save); tok && count < max; tok = strtok_r(NULL, ",\r\n", &save)) {
+        values[count++] = atof(tok);
+    }
+    return count;
+}
+
+typedef struct {
+    FILE *file;
+    unsigned long line;
+    unsigned long mismatches;
+    unsigned long rows;
+    double tolerance;
+} golden_t;
+
+static int golden_open(golden_t *g, const char *path, double tolerance) {
+    memset(g, 0, sizeof(*g));
+    g->tolerance = tolerance;
+    g->file = fopen(path, "r");
+    if (!g->file) {
+        fprintf(stderr, "Cannot open golden file %s\n", path);
+        return -1;
+    }
+    char line[SIM_LINE_MAX];
+    if (!fgets(line, sizeof(line), g->file) || strncmp(line, CSV_HEADER, strlen(CSV_HEADER)) != 0) {
+        fprintf(stderr, "Golden file %s: unexpected header\n", path);
+        fclose(g->file);
+        g->file = NULL;
+        return -1;
+    }
+    g->line = 1;
+    return 0;
+}
+
+static void golden_check(golden_t *g, const char *row) {
+    static const char *names[] = {
+        "tick", "day_cycle", "ac_mains", "engine", "solar_w", "ac_charge_w", "alternator_w",
+        "load_12v_w", "load_220v_w", "battery_a", "battery_v", "soc_percent",
+    };
+    char expected_line[SIM_LINE_MAX], actual_line[SIM_LINE_MAX];
+    double expected[SIM_COLUMNS_MAX], actual[SIM_COLUMNS_MAX];
+
+    g->rows++;
+    g->line++;
+    if (!fgets(expected_line, sizeof(expected_line), g->file)) {
+        if (g->mismatches++ == 0) {
+            fprintf(stderr, "Golden line %lu: missing (trace is longer)\n", g->line);
+        }
+        return;
+    }
+    snprintf(actual_line, sizeof(actual_line), "%s", row);
+    int n_expected = split_columns(expected_line, expected, SIM_COLUMNS_MAX);
+    int n_actual = split_columns(actual_line, actual, SIM_COLUMNS_MAX);
+    if (n_expected != n_actual) {
+        if (g->mismatches++ == 0) {
+            fprintf(stderr, "Golden line %lu: %d columns, trace has %d\n", g->line, n_expected, n_actual);
+        }
+        return;
+    }
+    for (int c = 0; c < n_actual; c++) {
+        double limit = g->tolerance * (1.0 + fabs(expected[c]));
+        if (fabs(actual[c] - expected[c]) > limit) {
+            if (g->mismatches++ == 0) {
+                fprintf(stderr, "Golden line %lu: %s = %g, expected %g\n",
+                        g->line, names[c], actual[c], expected[c]);
+            }
+            return;
+        }
+    }
+}
+
+static int golden_close(golden_t *g) {
+    char extra[SIM_LINE_MAX];
+    if (fgets(extra, sizeof(extra), g->file)) {
+        if (g->mismatches++ == 0) {
+            fprintf(stderr, "Golden line %lu: trace is shorter than the golden file\n", g->line + 1);
+        }
+    }
+    fclose(g->file);
+    if (g->mismatches > 0) {
+        fprintf(stderr, "GOLDEN MISMATCH: %lu of %lu rows differ\n", g->mismatches, g->rows);
+        return 1;
+    }
+    fprintf(stderr, "Golden OK (%lu rows)\n", g->rows);
+    return 0;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    sim_options_t opt;
+    if (parse_options(argc, argv, &opt) != 0) {
+        return 2;
+    }
+
+    FILE *csv = stdout;
+    if (strcmp(opt.csv_path, "-") != 0) {
+        csv = fopen(opt.csv_path, "w");
+        if (!csv) {
+            fprintf(stderr, "Cannot write %s\n", opt.csv_path);
+            return 2;
+        }
+    }
+    golden_t golden = {0};
+    if (opt.golden_path && golden_open(&golden, opt.golden_path, opt.tolerance) != 0) {
+        return 2;
+    }
+
+    // Same initialization as app_main (simulation part)
+    srand(opt.seed);
+    energy_simulation_init();
+    inverter_chargers_manager_init();
+    van_state_t van_state;
+    memset(&van_state, 0, sizeof(van_state));
+    const energy_simulation_context_t *ctx = energy_simulation_get_context();
+
+    fprintf(csv, "%s\n", CSV_HEADER);
+    sim_totals_t totals = { .soc_start = ctx->battery_soc_percent, .soc_min = ctx->battery_soc_percent, .soc_max = ctx->battery_soc_percent };
+    const double tick_h = SIM_TICK_US / 3600e6;
+    clock_t start = clock();
+
+    for (uint32_t t = 0; t < opt.ticks; t++) {
+        sim_step(&van_state);
+
+        totals.solar_wh += ctx->solar_power_w * tick_h;
+        totals.ac_wh += ctx->ac_charger_power_w * tick_h;
+        totals.alternator_wh += ctx->alternator_power_w * tick_h;
+        totals.load_wh += (ctx->load_12v_w + ctx->load_220v_w + ctx->inverter_loss_w) * tick_h;
+        if (ctx->battery_soc_percent < totals.soc_min) totals.soc_min = ctx->battery_soc_percent;
+        if (ctx->battery_soc_percent > totals.soc_max) totals.soc_max = ctx->battery_soc_percent;
+
+        if ((t + 1) % opt.every == 0) {
+            char row[SIM_LINE_MAX];
+            format_row(row, sizeof(row), ctx);
+            fprintf(csv, "%s\n", row);
+            if (golden.file) {
+                golden_check(&golden, row);
+            }
+        }
+    }
+
+    double elapsed_ms = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    if (csv != stdout) {
+        fclose(csv);
+    }
+
+    fprintf(stderr, "%lu ticks (%.1f model days, %.1f h of device time) in %.1f ms, seed %u\n",
+            (unsigned long)opt.ticks, (double)opt.ticks / SIM_TICKS_PER_DAY, opt.ticks * tick_h, elapsed_ms, opt.seed);
+    fprintf(stderr, "Solar %.0f Wh, AC %.0f Wh, alternator %.0f Wh, loads %.0f Wh (at 1 s per tick)\n",
+            totals.solar_wh, totals.ac_wh, totals.alternator_wh, totals.load_wh);
+    fprintf(stderr, "SOC %.1f%% -> %.1f%% (min %.1f%%, max %.1f%%), battery %.2f V\n",
+            totals.soc_start, ctx->battery_soc_percent, totals.soc_min, totals.soc_max, ctx->battery_voltage_v);
+
+    return golden.file ? golden_close(&golden) : 0;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file host_shim.c
+ * @brief ESP-IDF / FreeRTOS / drivers shim to run the energy model on a Linux host
+ *
+ * Single-threaded: tasks are never started, delays advance a simulated clock,
+ * hardware (UART multiplexer, BLE battery monitor) is absent.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "../communications/uart/uart_multiplexer.h"
+#include "../communications/ble/ble_manager_nimble.h"
+
+bool host_log_verbose = false;
+
+static int64_t sim_clock_us = 0;
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:                return "ESP_OK";
+        case ESP_FAIL:              return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:       return "ESP_ERR_TIMEOUT";
+        default:                    return "ESP_ERR_UNKNOWN";
+    }
+}
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+
+int64_t esp_timer_get_time(void) {
+    return sim_clock_us;
+}
+
+void host_clock_advance_us(int64_t us) {
+    sim_clock_us += us;
+}
+
+// ============================================================================
+// FREERTOS
+// ============================================================================
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                       UBaseType_t prio, TaskHandle_t *handle) {
+    return pdFAIL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *handle, BaseType_t core) {
+    return pdFAIL;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    sim_clock_us += (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+void vTaskDelayUntil(TickType_t *previous, TickType_t period) {
+    *previous += period;
+    int64_t target_us = (int64_t)*previous * portTICK_PERIOD_MS * 1000;
+    if (target_us > sim_clock_us) {
+        sim_clock_us = target_us;
+    }
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(sim_clock_us / (portTICK_PERIOD_MS * 1000));
+}
+
+int xPortGetCoreID(void) {
+    return 0;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    static int dummy;
+    return &dummy;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout) {
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    return pdTRUE;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    return NULL;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t timeout) {
+    return pdFAIL;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t timeout) {
+    return pdFAIL;
+}
+
+// ============================================================================
+// HARDWARE (absent)
+// ============================================================================
+
+esp_err_t uart_mux_acquire(uart_mux_device_t device, uint32_t timeout_ms) {
+    return ESP_ERR_TIMEOUT;
+}
+
+void uart_mux_release(uart_mux_device_t device) {
+}
+
+bool uart_mux_has_tx(uart_mux_device_t device) {
+    return false;
+}
+
+int uart_mux_write(uart_mux_device_t device, const uint8_t *data, size_t len) {
+    return -1;
+}
+
+int uart_mux_receive(uart_mux_device_t device, uint8_t *data, size_t max_len, uint32_t timeout_ms) {
+    return 0;
+}
+
+esp_err_t ble_add_device_by_mac(const uint8_t mac_address[6], const char* device_name) {
+    return ESP_OK;
+}
+
+bool ble_is_device_connected(const uint8_t mac_address[6]) {
+    return false;
+}
+
+esp_err_t ble_request_battery_update(const uint8_t mac_address[6]) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t ble_request_battery_cells(const uint8_t mac_address[6]) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t ble_get_device_data(const uint8_t mac_address[6], uint8_t* out_buffer, size_t buf_size, size_t* out_len) {
+    return ESP_ERR_NOT_FOUND;
+}
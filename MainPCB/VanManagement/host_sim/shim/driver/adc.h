@@ -0,0 +1,3 @@
+// Host shim (pin numbers only)
+#pragma once
+#define ADC_CHANNEL_3 3
@@ -0,0 +1,21 @@
+// Host shim of ESP-IDF esp_log.h: logs go to stderr when host_log_verbose is set
+#pragma once
+#include <stdio.h>
+#include <stdbool.h>
+
+extern bool host_log_verbose;
+
+#define HOST_LOG(level, tag, fmt, ...) \
+    do { if (host_log_verbose) fprintf(stderr, level " (%s) " fmt "\n", tag, ##__VA_ARGS__); } while (0)
+
+#define ESP_LOGE(tag, fmt, ...) HOST_LOG("E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) HOST_LOG("W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) HOST_LOG("I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) do { (void)(tag); } while (0)
+#define ESP_LOGV(tag, fmt, ...) do { (void)(tag); } while (0)
+#define ESP_LOG_BUFFER_HEX(tag, buf, len) do { (void)(buf); (void)(len); } while (0)
+#define ESP_LOG_BUFFER_HEX_LEVEL(tag, buf, len, level) do { (void)(buf); (void)(len); } while (0)
+#define ESP_LOG_BUFFER_HEXDUMP(tag, buf, len, level) do { (void)(buf); (void)(len); } while (0)
+
+typedef enum { ESP_LOG_NONE, ESP_LOG_ERROR, ESP_LOG_WARN, ESP_LOG_INFO, ESP_LOG_DEBUG, ESP_LOG_VERBOSE } esp_log_level_t;
+#define esp_log_level_set(tag, level) do { (void)(tag); (void)(level); } while (0)
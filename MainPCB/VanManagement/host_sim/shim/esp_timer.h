@@ -0,0 +1,6 @@
+// Host shim of ESP-IDF esp_timer.h: simulated clock (host_shim.c)
+#pragma once
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+void host_clock_advance_us(int64_t us);
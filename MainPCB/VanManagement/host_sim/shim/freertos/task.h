@@ -0,0 +1,12 @@
+#pragma once
+#include "FreeRTOS.h"
+
+// Tasks are never started on the host: the harness calls the update functions
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                       UBaseType_t prio, TaskHandle_t *handle);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *handle, BaseType_t core);
+void vTaskDelay(TickType_t ticks);                      // Advances the simulated clock
+void vTaskDelayUntil(TickType_t *previous, TickType_t period);
+TickType_t xTaskGetTickCount(void);
+int xPortGetCoreID(void);
@@ -0,0 +1,2 @@
+// Host shim: the BLE stack is not simulated, ble_manager_nimble.h API is stubbed in host_shim.c
+#pragma once
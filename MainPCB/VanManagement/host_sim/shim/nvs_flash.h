@@ -0,0 +1,2 @@
+// Host shim (nothing used by the energy model)
+#pragma once
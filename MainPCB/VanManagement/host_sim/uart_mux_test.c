@@ -0,0 +1,262 @@
+/**
+ * @file uart_mux_test.c
+ * @brief Host test of the UART multiplexer scheduler, on a fake UART driver
+ *
+ * The bus task is not started: each test calls the scheduler functions the
+ * way uart_mux_bus_task() would, at simulated ticks, after putting the
+ * received bytes in the fake driver buffer.
+ */
+
+#include "../communications/uart/uart_multiplexer.c"
+#include <stdio.h>
+
+bool host_log_verbose = false;
+
+static TickType_t sim_tick = 0;
+static int failures = 0;
+
+#define EXPECT(cond) do { \
+    if (!(cond)) { fprintf(stderr, "  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++; } \
+} while (0)
+
+const char *esp_err_to_name(esp_err_t code) {
+    return (code == ESP_OK) ? "ESP_OK" : "ESP_ERR";
+}
+
+// ============================================================================
+// FREERTOS (single-threaded)
+// ============================================================================
+
+TickType_t xTaskGetTickCount(void) {
+    return sim_tick;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *handle, BaseType_t core) {
+    return pdPASS;      // Never run: the tests drive the scheduler
+}
+
+// Semaphores are counters, a take never waits
+static int semaphores[8];
+static int semaphore_count = 0;
+
+static SemaphoreHandle_t semaphore_create(int initial) {
+    if (semaphore_count >= (int)(sizeof(semaphores) / sizeof(semaphores[0]))) return NULL;
+    semaphores[semaphore_count] = initial;
+    return &semaphores[semaphore_count++];
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return semaphore_create(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return semaphore_create(0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout) {
+    int *count = (int *)sem;
+    if (*count == 0) return pdFALSE;
+    (*count)--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    *(int *)sem = 1;
+    return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t timeout) {
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t timeout) {
+    return pdFAIL;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    return pdPASS;
+}
+
+// Message buffers keep the last frames sent
+#define FAKE_FRAMES 4
+
+typedef struct {
+    uint8_t data[FAKE_FRAMES][UART_MUX_FRAME_MAX];
+    size_t len[FAKE_FRAMES];
+    int count;
+} fake_message_buffer_t;
+
+static fake_message_buffer_t message_buffers[UART_MUX_DEVICE_COUNT];
+static int message_buffer_count = 0;
+
+MessageBufferHandle_t xMessageBufferCreate(size_t size) {
+    if (message_buffer_count >= UART_MUX_DEVICE_COUNT) return NULL;
+    return &message_buffers[message_buffer_count++];
+}
+
+size_t xMessageBufferSend(MessageBufferHandle_t buffer, const void *data, size_t len, TickType_t timeout) {
+    fake_message_buffer_t *mb = (fake_message_buffer_t *)buffer;
+    if (mb->count >= FAKE_FRAMES) return 0;
+    memcpy(mb->data[mb->count], data, len);
+    mb->len[mb->count++] = len;
+    return len;
+}
+
+size_t xMessageBufferReceive(MessageBufferHandle_t buffer, void *data, size_t max_len, TickType_t timeout) {
+    fake_message_buffer_t *mb = (fake_message_buffer_t *)buffer;
+    if (mb->count == 0 || mb->len[0] > max_len) return 0;
+    size_t len = mb->len[0];
+    memcpy(data, mb->data[0], len);
+    memmove(&mb->data[0], &mb->data[1], (size_t)(mb->count - 1) * UART_MUX_FRAME_MAX);
+    memmove(&mb->len[0], &mb->len[1], (size_t)(mb->count - 1) * sizeof(size_t));
+    mb->count--;
+    return len;
+}
+
+// ============================================================================
+// UART / GPIO DRIVERS
+// ============================================================================
+
+typedef struct {
+    uint8_t data[1024];
+    size_t len;
+} fake_rx_t;
+
+static fake_rx_t fake_rx[3];
+
+esp_err_t uart_driver_install(uart_port_t port, int rx_buffer_size, int tx_buffer_size, int queue_size,
+                              QueueHandle_t *queue, int intr_alloc_flags) {
+    if (queue) *queue = &fake_rx[port];     // Any non-NULL handle
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t *config) { return ESP_OK; }
+esp_err_t uart_set_pin(uart_port_t port, int tx, int rx, int rts, int cts) { return ESP_OK; }
+esp_err_t uart_set_baudrate(uart_port_t port, uint32_t baud_rate) { return ESP_OK; }
+esp_err_t uart_set_rx_timeout(uart_port_t port, uint8_t tout_thresh) { return ESP_OK; }
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) { return ESP_OK; }
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) { return ESP_OK; }
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio_num, gpio_pull_mode_t pull) { return ESP_OK; }
+
+esp_err_t uart_flush_input(uart_port_t port) {
+    fake_rx[port].len = 0;
+    return ESP_OK;
+}
+
+int uart_read_bytes(uart_port_t port, void *buf, uint32_t length, TickType_t ticks_to_wait) {
+    fake_rx_t *rx = &fake_rx[port];
+    size_t len = (length < rx->len) ? length : rx->len;
+    memcpy(buf, rx->data, len);
+    memmove(rx->data, &rx->data[len], rx->len - len);
+    rx->len -= len;
+    return (int)len;
+}
+
+int uart_write_bytes(uart_port_t port, const void *src, size_t size) {
+    return (int)size;
+}
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static void setup(void) {
+    memset(semaphores, 0, sizeof(semaphores));
+    semaphore_count = 0;
+    memset(message_buffers, 0, sizeof(message_buffers));
+    message_buffer_count = 0;
+    memset(fake_rx, 0, sizeof(fake_rx));
+    for (size_t b = 0; b < BUS_COUNT; b++) {
+        buses[b].held = false;
+    }
+    sim_tick = 0;
+    uart_multiplexer_init();
+}
+
+// A chunk read by the driver, followed by a silence (RX timeout)
+static void receive_chunk(uart_mux_bus_t *bus, const char *bytes, TickType_t at) {
+    size_t len = strlen(bytes);
+    fake_rx_t *rx = &fake_rx[bus->port];
+    memcpy(&rx->data[rx->len], bytes, len);
+    rx->len += len;
+
+    sim_tick = at;
+    uart_event_t event = { .type = UART_DATA, .size = len, .timeout_flag = true };
+    handle_event(bus, &event, sim_tick);
+    schedule_bus(bus, sim_tick);
+}
+
+// What uart_mux_acquire() asks the scheduler, true once the line is granted
+static bool hold(uart_mux_bus_t *bus, uart_mux_device_t device, TickType_t at) {
+    sim_tick = at;
+    bus->hold_request = device;
+    schedule_bus(bus, sim_tick);
+    return xSemaphoreTake(bus->grant, 0) == pdTRUE;
+}
+
+static bool received(uart_mux_device_t device, const char *expected) {
+    uint8_t frame[UART_MUX_FRAME_MAX];
+    int len = uart_mux_receive(device, frame, sizeof(frame), 0);
+    return len == (int)strlen(expected) && memcmp(frame, expected, len) == 0;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+// HCO2T: the request echo and the answer come back ~13 ms after the switch,
+// within the 20 ms idle gap of the device
+static void test_answer_within_idle_gap(void) {
+    setup();
+    uart_mux_bus_t *bus = bus_of(UART_MUX_HCO2T);
+    EXPECT(bus->active == UART_MUX_HEATER);
+
+    EXPECT(hold(bus, UART_MUX_HCO2T, 5));
+    EXPECT(bus->active == UART_MUX_HCO2T);
+    receive_chunk(bus, "request+answer", 5 + 13);
+    EXPECT(received(UART_MUX_HCO2T, "request+answer"));
+    EXPECT(device_stats[UART_MUX_HCO2T].bytes_discarded == 0);
+}
+
+// VE.Direct HEX: the answer comes within the 50 ms idle gap of the MPPTs
+static void test_hex_answer_within_idle_gap(void) {
+    setup();
+    uart_mux_bus_t *bus = bus_of(UART_MUX_MPPT_70_15);
+    EXPECT(bus->active == UART_MUX_MPPT_100_50);
+
+    EXPECT(hold(bus, UART_MUX_MPPT_70_15, 100));
+    receive_chunk(bus, ":51641F9\n", 100 + 30);
+    EXPECT(received(UART_MUX_MPPT_70_15, ":51641F9\n"));
+}
+
+// Time-slice switch: the device streams on its own, the first chunk may be
+// the tail of a frame and is discarded until a silence is seen
+static void test_slice_switch_waits_for_silence(void) {
+    setup();
+    uart_mux_bus_t *bus = bus_of(UART_MUX_MPPT_70_15);
+
+    sim_tick = UART_MUX_SLICE_MPPT_MS;
+    schedule_bus(bus, sim_tick);
+    EXPECT(bus->active == UART_MUX_MPPT_70_15);
+
+    receive_chunk(bus, "tail\r\n", sim_tick + 10);
+    EXPECT(!received(UART_MUX_MPPT_70_15, "tail\r\n"));
+    EXPECT(device_stats[UART_MUX_MPPT_70_15].bytes_discarded == 6);
+
+    receive_chunk(bus, "\r\nV\t12800", sim_tick + 900);
+    EXPECT(received(UART_MUX_MPPT_70_15, "\r\nV\t12800"));
+}
+
+int main(void) {
+    test_answer_within_idle_gap();
+    test_hex_answer_within_idle_gap();
+    test_slice_switch_waits_for_silence();
+
+    if (failures > 0) {
+        fprintf(stderr, "uart_mux_test: %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("uart_mux_test OK\n");
+    return 0;
+}
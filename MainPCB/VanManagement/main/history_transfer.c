@@ -0,0 +1,238 @@
+#include "history_transfer.h"
+#include <string.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "../communications/ble/ble_manager_nimble.h"
+#include "../peripherals_devices/telemetry_log.h"
+#include "../peripherals_devices/van_clock.h"
+
+static const char *TAG = "HISTORY";
+
+#define HISTORY_READ_BATCH      32      // Records read from flash at once
+#define HISTORY_CHUNK_MAX       500     // Largest notification (BLE_MAX_FRAGMENT_SIZE)
+#define HISTORY_RETRY_MS        5       // Wait when the BLE stack is congested
+#define HISTORY_STALL_MS        5000    // Give up if nothing can be sent for this long
+
+typedef struct {
+    uint16_t conn_handle;
+    history_query_t query;
+} history_request_t;
+
+// Field of a record selected by a metric bit
+typedef struct {
+    uint8_t metric;
+    uint8_t offset;
+    uint8_t size;
+} history_field_t;
+
+static const history_field_t raw_fields[] = {
+    { HISTORY_METRIC_CURRENT, offsetof(telemetry_log_raw_t, battery_current_ca), 2 },
+    { HISTORY_METRIC_VOLTAGE, offsetof(telemetry_log_raw_t, battery_voltage_mv), 2 },
+    { HISTORY_METRIC_SOLAR,   offsetof(telemetry_log_raw_t, solar_power_w), 2 },
+    { HISTORY_METRIC_SOC,     offsetof(telemetry_log_raw_t, soc_percent), 1 },
+    { HISTORY_METRIC_TANKS,   offsetof(telemetry_log_raw_t, tank_percent), 5 },
+};
+
+// Consecutive fields of telemetry_log_rollup_t
+static const history_field_t rollup_fields[] = {
+    { HISTORY_METRIC_CURRENT, offsetof(telemetry_log_rollup_t, battery_current_mean_ca), 6 },
+    { HISTORY_METRIC_VOLTAGE, offsetof(telemetry_log_rollup_t, battery_voltage_min_mv), 4 },
+    { HISTORY_METRIC_SOLAR,   offsetof(telemetry_log_rollup_t, solar_power_mean_w), 6 },
+    { HISTORY_METRIC_SOC,     offsetof(telemetry_log_rollup_t, soc_percent), 1 },
+    { HISTORY_METRIC_TANKS,   offsetof(telemetry_log_rollup_t, tank_percent), 5 },
+    { HISTORY_METRIC_CHARGE,  offsetof(telemetry_log_rollup_t, battery_charge_mah), 8 },
+};
+
+static QueueHandle_t request_queue = NULL;
+
+// Transfer buffers (history task only)
+static uint8_t records[HISTORY_READ_BATCH * sizeof(telemetry_log_rollup_t)];
+static uint8_t chunk[HISTORY_CHUNK_MAX];
+
+// NimBLE host task: only queue the request (a new one replaces the pending one)
+static void on_history_request(uint16_t conn_handle, const uint8_t* data, size_t length) {
+    history_request_t request = { .conn_handle = conn_handle };
+
+    if (length >= 1 && data[0] == HISTORY_OP_QUERY && length >= sizeof(history_query_t)) {
+        memcpy(&request.query, data, sizeof(history_query_t));
+    } else if (length >= 1 && data[0] == HISTORY_OP_SET_TIME && length >= sizeof(history_set_time_t)) {
+        history_set_time_t set_time;
+        memcpy(&set_time, data, sizeof(set_time));
+        if (van_clock_set(set_time.time) != ESP_OK) {
+            ESP_LOGW(TAG, "Time refused: %" PRIu32, set_time.time);
+        }
+        return;
+    } else if (length >= 1 && data[0] == HISTORY_OP_CANCEL) {
+        request.query.op = HISTORY_OP_CANCEL;
+        request.query.query_id = (length >= 2) ? data[1] : 0;
+    } else {
+        ESP_LOGW(TAG, "Invalid history request (%u bytes)", (unsigned)length);
+        return;
+    }
+    xQueueOverwrite(request_queue, &request);
+}
+
+// Send one notification, waiting while the stack is congested
+static history_end_status_t send_blocking(uint16_t conn_handle, const uint8_t* data, size_t length, bool cancellable) {
+    TickType_t start = xTaskGetTickCount();
+    while (1) {
+        if (cancellable && uxQueueMessagesWaiting(request_queue) > 0) {
+            return HISTORY_END_CANCELLED;
+        }
+        esp_err_t ret = ble_send_history(conn_handle, data, length);
+        if (ret == ESP_OK) {
+            return HISTORY_END_COMPLETE;
+        }
+        if (ret != ESP_ERR_NO_MEM || (xTaskGetTickCount() - start) > pdMS_TO_TICKS(HISTORY_STALL_MS)) {
+            return HISTORY_END_DISCONNECTED;
+        }
+        vTaskDelay(pdMS_TO_TICKS(HISTORY_RETRY_MS));
+    }
+}
+
+static void send_end(const history_request_t* request, uint32_t total, history_end_status_t status) {
+    uint32_t now = 0;
+    van_clock_now(&now);
+    history_end_t end = {
+        .type = HISTORY_MSG_END,
+        .query_id = request->query.query_id,
+        .total = total,
+        .status = status,
+        .device_time = now,
+    };
+    if (status != HISTORY_END_DISCONNECTED) {
+        send_blocking(request->conn_handle, (const uint8_t*)&end, sizeof(end), false);
+    }
+}
+
+static void run_query(const history_request_t* request) {
+    const history_query_t *q = &request->query;
+    if (q->op != HISTORY_OP_QUERY) {
+        return;                     // Cancel with nothing running
+    }
+    if (q->resolution >= TELEMETRY_LOG_TIER_COUNT || q->metrics == 0 || (q->metrics & ~HISTORY_METRIC_ALL) ||
+        q->to_time < q->from_time) {
+        send_end(request, q->offset, HISTORY_END_INVALID);
+        return;
+    }
+
+    // Layout of the records sent
+    telemetry_log_tier_t tier = q->resolution;
+    const history_field_t *fields = (tier == TELEMETRY_LOG_RAW) ? raw_fields : rollup_fields;
+    size_t field_count = (tier == TELEMETRY_LOG_RAW) ? sizeof(raw_fields) / sizeof(raw_fields[0])
+                                                     : sizeof(rollup_fields) / sizeof(rollup_fields[0]);
+    size_t record_size = sizeof(uint32_t);
+    for (size_t f = 0; f < field_count; f++) {
+        if (q->metrics & fields[f].metric) record_size += fields[f].size;
+    }
+
+    size_t payload = ble_get_history_payload_size(request->conn_handle);
+    if (payload > sizeof(chunk)) payload = sizeof(chunk);
+    size_t per_chunk = (payload > sizeof(history_chunk_header_t)) ? (payload - sizeof(history_chunk_header_t)) / record_size : 0;
+    if (per_chunk > UINT8_MAX) per_chunk = UINT8_MAX;
+    if (per_chunk == 0) {
+        send_end(request, q->offset, HISTORY_END_DISCONNECTED);
+        return;
+    }
+
+    // Staged records are part of the answer
+    telemetry_log_flush();
+    telemetry_log_cursor_t cursor;
+    esp_err_t ret = telemetry_log_seek(tier, q->from_time, &cursor);
+    if (ret == ESP_ERR_INVALID_STATE) {
+        send_end(request, q->offset, HISTORY_END_UNAVAILABLE);
+        return;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    size_t source_size = telemetry_log_record_size(tier);
+    history_chunk_header_t *header = (history_chunk_header_t *)chunk;
+    uint8_t *out = chunk + sizeof(history_chunk_header_t);
+    uint32_t index = 0;             // Records of the result seen
+    uint32_t chunk_first = q->offset;
+    size_t chunk_count = 0;
+    history_end_status_t status = HISTORY_END_COMPLETE;
+    bool done = (ret != ESP_OK);
+
+    // Read to the end of the log: times are not sorted if the clock was set back
+    while (!done && status == HISTORY_END_COMPLETE) {
+        size_t n = telemetry_log_read(&cursor, records, HISTORY_READ_BATCH);
+        if (n == 0) break;
+
+        for (size_t r = 0; r < n; r++) {
+            const uint8_t *src = &records[r * source_size];
+            uint32_t time;
+            memcpy(&time, src, sizeof(time));
+            if (time < q->from_time || time > q->to_time) {
+                continue;
+            }
+            if (index++ < q->offset) {
+                continue;           // Already received before the resume
+            }
+
+            uint8_t *dst = &out[chunk_count * record_size];
+            memcpy(dst, &time, sizeof(time));
+            dst += sizeof(time);
+            for (size_t f = 0; f < field_count; f++) {
+                if (q->metrics & fields[f].metric) {
+                    memcpy(dst, &src[fields[f].offset], fields[f].size);
+                    dst += fields[f].size;
+                }
+            }
+
+            if (++chunk_count == per_chunk) {
+                *header = (history_chunk_header_t){
+                    .type = HISTORY_MSG_DATA, .query_id = q->query_id, .offset = chunk_first,
+                    .count = chunk_count, .record_size = record_size,
+                };
+                status = send_blocking(request->conn_handle, chunk, sizeof(*header) + chunk_count * record_size, true);
+                if (status != HISTORY_END_COMPLETE) break;
+                chunk_first += chunk_count;
+                chunk_count = 0;
+            }
+        }
+    }
+
+    if (status == HISTORY_END_COMPLETE && chunk_count > 0) {
+        *header = (history_chunk_header_t){
+            .type = HISTORY_MSG_DATA, .query_id = q->query_id, .offset = chunk_first,
+            .count = chunk_count, .record_size = record_size,
+        };
+        status = send_blocking(request->conn_handle, chunk, sizeof(*header) + chunk_count * record_size, true);
+        if (status == HISTORY_END_COMPLETE) chunk_first += chunk_count;
+    }
+    send_end(request, chunk_first, status);
+
+    ESP_LOGI(TAG, "Query %u (tier %u): %" PRIu32 " records from offset %" PRIu32 " in %" PRIu32 " ms, status %d",
+             q->query_id, tier, chunk_first - q->offset, q->offset,
+             (uint32_t)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS), status);
+}
+
+static void history_task(void* pv) {
+    (void) pv;
+    history_request_t request;
+    while (1) {
+        if (xQueueReceive(request_queue, &request, portMAX_DELAY) == pdTRUE) {
+            run_query(&request);
+        }
+    }
+}
+
+esp_err_t history_transfer_init(void) {
+    request_queue = xQueueCreate(1, sizeof(history_request_t));
+    if (!request_queue) {
+        return ESP_ERR_NO_MEM;
+    }
+    // Same priority as the update loop (app_main), below the BLE host
+    if (xTaskCreate(history_task, "history", 4096, NULL, 1, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create history task");
+        return ESP_FAIL;
+    }
+    ble_set_history_callback(on_history_request);
+    ESP_LOGI(TAG, "History transfer ready");
+    return ESP_OK;
+}
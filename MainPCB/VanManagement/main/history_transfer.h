@@ -0,0 +1,85 @@
+#ifndef HISTORY_TRANSFER_H
+#define HISTORY_TRANSFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Bulk download of the flash telemetry log (telemetry_log.h) over BLE, on its
+// own characteristic so the 1 Hz state stream is untouched.
+// The app writes a binary query; the device answers with MTU-sized DATA
+// chunks of packed records, then one END message. All fields little endian.
+// Offsets count records of the result: to resume after a disconnection, send
+// the same query with offset = records already received.
+// Record times come from the van clock (van_clock.h), which the app sets with
+// HISTORY_OP_SET_TIME when it connects. Every END carries the device time, so
+// an app that did not set the clock can still place the records (e.g. ask for
+// the last hour with from_time = device_time - 3600).
+
+#define HISTORY_OP_QUERY        0x01
+#define HISTORY_OP_CANCEL       0x02
+#define HISTORY_OP_SET_TIME     0x03
+
+#define HISTORY_MSG_DATA        0x81
+#define HISTORY_MSG_END         0x82
+
+// Metric set (query bitmask). Record = uint32 time + the selected fields in bit order:
+//                                   raw                 minute/hour rollup
+#define HISTORY_METRIC_CURRENT  (1 << 0)    // int16 A x100     int16 mean, min, max
+#define HISTORY_METRIC_VOLTAGE  (1 << 1)    // uint16 mV        uint16 min, max
+#define HISTORY_METRIC_SOLAR    (1 << 2)    // uint16 W         uint16 mean, max W, energy Wh x10
+#define HISTORY_METRIC_SOC      (1 << 3)    // uint8 %          uint8 % (end of period)
+#define HISTORY_METRIC_TANKS    (1 << 4)    // uint8 % x5       uint8 % x5
+#define HISTORY_METRIC_CHARGE   (1 << 5)    // -                int32 net mAh, uint32 discharge mAh
+#define HISTORY_METRIC_ALL      0x3F
+
+typedef enum {
+    HISTORY_END_COMPLETE = 0,
+    HISTORY_END_CANCELLED,          // Cancelled or replaced by a new query
+    HISTORY_END_INVALID,            // Bad query
+    HISTORY_END_UNAVAILABLE,        // No telemetry log
+    HISTORY_END_DISCONNECTED,
+} history_end_status_t;
+
+// App -> device
+typedef struct __attribute__((packed)) {
+    uint8_t op;                     // HISTORY_OP_QUERY
+    uint8_t query_id;               // Echoed in every answer
+    uint8_t resolution;             // telemetry_log_tier_t: 0 raw, 1 minute, 2 hour
+    uint8_t metrics;                // HISTORY_METRIC_*
+    uint32_t from_time;             // Seconds, inclusive
+    uint32_t to_time;               // Seconds, inclusive (0xFFFFFFFF = now)
+    uint32_t offset;                // Records to skip (resume)
+} history_query_t;
+
+// App -> device: set the van clock
+typedef struct __attribute__((packed)) {
+    uint8_t op;                     // HISTORY_OP_SET_TIME
+    uint32_t time;                  // Unix seconds
+} history_set_time_t;
+
+// Device -> app, followed by count records of record_size bytes
+typedef struct __attribute__((packed)) {
+    uint8_t type;                   // HISTORY_MSG_DATA
+    uint8_t query_id;
+    uint32_t offset;                // Index of the first record of the chunk
+    uint8_t count;
+    uint8_t record_size;
+} history_chunk_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t type;                   // HISTORY_MSG_END
+    uint8_t query_id;
+    uint32_t total;                 // Offset after the last record sent
+    uint8_t status;                 // history_end_status_t
+    uint32_t device_time;           // Van clock when the answer ended, 0 if unknown
+} history_end_t;
+
+/**
+ * @brief Register the history characteristic callback and start the transfer task
+ *
+ * Call after ble_init() and telemetry_log_init().
+ */
+esp_err_t history_transfer_init(void);
+
+#endif // HISTORY_TRANSFER_H
@@ -20,6 +20,8 @@
 #include "../peripherals_devices/led_manager.h"
 #include "../peripherals_devices/led_coordinator.h"
 #include "../peripherals_devices/led_command_handler.h"
+#include "../peripherals_devices/led_metrics.h"
+#include "../peripherals_devices/led_scenes.h"
 #include "../peripherals_devices/hood_manager.h"
 #include "../peripherals_devices/heater_manager.h"
 #include "../peripherals_devices/battery_manager.h"
@@ -28,11 +30,22 @@
 #include "../peripherals_devices/energy_simulation.h"
 #include "../peripherals_devices/videoprojecteur_manager.h"
 #include "../peripherals_devices/htco2_sensor_manager.h"
+#include "../peripherals_devices/telemetry_aggregator.h"
+#include "../peripherals_devices/telemetry_log.h"
+#include "../peripherals_devices/van_clock.h"
+#include "history_transfer.h"
+#include "update_scheduler.h"
 #include "../utils/battery_parser.h"
 
 static const char *TAG = "MAIN";
 
 #define PRINT_DEBUG_VAN_STATE 0
+#define PRINT_DEBUG_LED_METRICS 0
+#define PRINT_DEBUG_UART_MUX 0
+#define PRINT_DEBUG_TELEMETRY 0
+#define PRINT_DEBUG_SCHEDULER 0
+
+#define VAN_STATE_SEND_PERIOD_MS 1000
 
 // ============================================================================
 // COMMAND EXECUTION FUNCTIONS
@@ -108,11 +121,104 @@ void handle_van_command(van_command_t* cmd) {
 static fragment_handler_t g_fragment_handlers[MAX_BLE_CONNECTIONS];
 static bool g_handlers_initialized = false;
 
+// Upload progressif des animations LED: les keyframes sont transmises au rendu
+// dès qu'un fragment les complète (un seul upload à la fois, toutes connexions confondues)
+#define NO_LED_STREAM -1
+static led_stream_parser_t g_led_streams[MAX_BLE_CONNECTIONS];
+static int g_led_stream_owner = NO_LED_STREAM;
+
+// L'upload modifie le rendu LED (stream_timeline) comme une commande complète:
+// il prend g_command_mutex, en attendant la fin d'une commande en cours
+// pour ne pas perdre de fragment
+static void led_stream_lock(void) {
+    if (g_command_mutex) xSemaphoreTake(g_command_mutex, portMAX_DELAY);
+}
+
+static void led_stream_unlock(void) {
+    if (g_command_mutex) xSemaphoreGive(g_command_mutex);
+}
+
+// Abandonne l'upload de cette connexion (g_command_mutex pris)
+static void led_stream_stop(int handler_idx) {
+    if (g_led_stream_owner == handler_idx) {
+        led_stream_end(false);
+        g_led_stream_owner = NO_LED_STREAM;
+    }
+    led_stream_parser_reset(&g_led_streams[handler_idx]);
+}
+
+static void led_stream_abort(int handler_idx) {
+    led_stream_lock();
+    led_stream_stop(handler_idx);
+    led_stream_unlock();
+}
+
+// Parse les keyframes déjà reçues et les publie vers le rendu LED (g_command_mutex pris)
+static void led_stream_feed(int handler_idx, const uint8_t* data, size_t len) {
+    led_stream_parser_t* stream = &g_led_streams[handler_idx];
+    if (g_led_stream_owner != NO_LED_STREAM && g_led_stream_owner != handler_idx) {
+        return; // Un autre upload est en cours: cette commande suivra le chemin normal
+    }
+
+    led_stream_state_t state = led_stream_parser_feed(stream, data, len);
+    if (state == LED_STREAM_HEADER_READY) {
+        led_dynamic_command_t header = {
+            .strip_target = stream->strip_target,
+            .loop_duration_ms = stream->loop_duration_ms,
+            .keyframe_count = stream->keyframe_count,
+            .loop_behavior = stream->loop_behavior,
+        };
+        led_stream_parser_set_target(stream, led_stream_begin(&header));
+        if (stream->state == LED_STREAM_KEYFRAMES) {
+            g_led_stream_owner = handler_idx;
+            state = led_stream_parser_feed(stream, data, len);
+        }
+    }
+
+    if (g_led_stream_owner != handler_idx) return;
+
+    if (state == LED_STREAM_ERROR || led_stream_commit(stream->keyframes_parsed) != ESP_OK) {
+        ESP_LOGE(TAG, "❌ Upload progressif de l'animation interrompu");
+        led_stream_stop(handler_idx);
+        stream->state = LED_STREAM_ERROR; // Ignorer la suite de cette commande
+    }
+}
+
+static void led_stream_process(int handler_idx, const uint8_t* data, size_t len) {
+    led_stream_lock();
+    led_stream_feed(handler_idx, data, len);
+    led_stream_unlock();
+}
+
+// Publie les dernières keyframes et termine l'upload, false si cette connexion
+// n'avait pas d'upload en cours
+static bool led_stream_finish(int handler_idx, const uint8_t* data, size_t len) {
+    led_stream_lock();
+    bool owner = (g_led_stream_owner == handler_idx);
+    if (owner) {
+        led_stream_feed(handler_idx, data, len);
+        if (g_led_stream_owner == handler_idx) {
+            bool stream_complete = (g_led_streams[handler_idx].state == LED_STREAM_DONE);
+            if (!stream_complete) {
+                ESP_LOGE(TAG, "❌ Animation incomplète (%d/%d keyframes)",
+                         g_led_streams[handler_idx].keyframes_parsed,
+                         g_led_streams[handler_idx].keyframe_count);
+            }
+            led_stream_end(stream_complete);
+            g_led_stream_owner = NO_LED_STREAM;
+        }
+        led_stream_parser_reset(&g_led_streams[handler_idx]);
+    }
+    led_stream_unlock();
+    return owner;
+}
+
 void on_receive(uint16_t conn_handle, const uint8_t* data, size_t len) {
     // Initialiser les handlers au premier appel
     if (!g_handlers_initialized) {
         for (int i = 0; i < MAX_BLE_CONNECTIONS; i++) {
             fragment_handler_init(&g_fragment_handlers[i], 5000); // 5s timeout
+            led_stream_parser_reset(&g_led_streams[i]);
         }
         g_handlers_initialized = true;
     }
@@ -129,6 +235,11 @@ void on_receive(uint16_t conn_handle, const uint8_t* data, size_t len) {
         ESP_LOG_BUFFER_HEX_LEVEL(TAG, data, len < 32 ? len : 32, ESP_LOG_INFO);
     }
     
+    // Un premier fragment démarre une nouvelle commande (abandonne la précédente)
+    if (len > 0 && data[0] == PACKET_TYPE_FIRST_FRAGMENT) {
+        led_stream_abort(handler_idx);
+    }
+    
     // === ÉTAPE 1: Traiter la fragmentation ===
     uint8_t* complete_data = NULL;
     size_t complete_len = 0;
@@ -146,6 +257,20 @@ void on_receive(uint16_t conn_handle, const uint8_t* data, size_t len) {
             // Données complètes disponibles, on peut parser la commande
             ESP_LOGI(TAG, "✅ Données complètes prêtes (%d bytes)", complete_len);
             
+            // Animation LED déjà en lecture: publier les dernières keyframes et terminer l'upload
+            if (led_stream_finish(handler_idx, complete_data, complete_len)) {
+                fragment_handler_cleanup(handler);
+                break;
+            }
+            // Upload progressif interrompu (données invalides ou remplacé par une autre commande)
+            if (g_led_streams[handler_idx].state == LED_STREAM_ERROR) {
+                ESP_LOGW(TAG, "⚠️ Animation abandonnée pendant l'upload, commande ignorée");
+                led_stream_parser_reset(&g_led_streams[handler_idx]);
+                fragment_handler_cleanup(handler);
+                break;
+            }
+            led_stream_parser_reset(&g_led_streams[handler_idx]);
+            
             // === ÉTAPE 2: Parser la commande VAN ===
             van_command_t* cmd = NULL;
             command_parse_result_t parse_result = parse_van_command(
@@ -172,73 +297,127 @@ void on_receive(uint16_t conn_handle, const uint8_t* data, size_t len) {
             }
             break;
             
-        case FRAGMENT_RESULT_INCOMPLETE:
+        case FRAGMENT_RESULT_INCOMPLETE: {
             ESP_LOGD(TAG, "⏳ Fragment reçu, attente des suivants...");
+            const uint8_t* partial_data = NULL;
+            size_t partial_len = 0;
+            if (fragment_handler_get_partial(handler, &partial_data, &partial_len)) {
+                led_stream_process(handler_idx, partial_data, partial_len);
+            }
             break;
+        }
             
         case FRAGMENT_RESULT_ERROR_MEMORY:
             ESP_LOGE(TAG, "❌ Erreur mémoire lors du réassemblage (conn_handle=%d)", conn_handle);
+            led_stream_abort(handler_idx);
             fragment_handler_cleanup(handler);
             break;
             
         case FRAGMENT_RESULT_ERROR_INVALID:
             ESP_LOGE(TAG, "❌ Fragment invalide (conn_handle=%d)", conn_handle);
+            led_stream_abort(handler_idx);
             fragment_handler_cleanup(handler);
             break;
             
         case FRAGMENT_RESULT_ERROR_TIMEOUT:
             ESP_LOGE(TAG, "❌ Timeout réassemblage (conn_handle=%d)", conn_handle);
+            led_stream_abort(handler_idx);
             break;
     }
 }
 
 
 
+// ============================================================================
+// VAN STATE UPDATE
+// ============================================================================
+
+// Updates without a manager function of the scheduler signature
+static esp_err_t update_system(van_state_t* van_state) {
+    #if ENABLE_ENERGY_SIMULATION
+        // Shared simulation time (MUST BE FIRST of the energy chain)
+        energy_simulation_update_time();
+    #endif
+    protocol_update_uptime();
+    return ESP_OK;
+}
+
+static esp_err_t update_door(van_state_t* van_state) {
+    van_state->sensors.door_open = get_door_state(); // Update door state mannually since no manager yet
+    return ESP_OK;
+}
+
+static esp_err_t update_telemetry_log(van_state_t* van_state) {
+    return telemetry_log_update_van_state(van_state);
+}
+
+static esp_err_t print_debug(van_state_t* van_state) {
+    #if PRINT_DEBUG_VAN_STATE
+        protocol_print_state_summary();
+    #endif
+    #if PRINT_DEBUG_LED_METRICS
+        led_metrics_print_summary();
+    #endif
+    #if PRINT_DEBUG_UART_MUX
+        uart_mux_print_stats();
+    #endif
+    #if PRINT_DEBUG_TELEMETRY
+        telemetry_aggregator_print_summary();
+    #endif
+    #if PRINT_DEBUG_SCHEDULER
+        update_scheduler_print_stats();
+    #endif
+    return ESP_OK;
+}
+
+/**
+ * Register every update with its period, in dependency order: updates sharing
+ * a period run in this order within the same pass.
+ */
+static esp_err_t register_van_state_updates(void) {
+    // Energy chain, all at 1 s (the simulation and the battery integration assume it)
+    ESP_ERROR_CHECK(update_scheduler_register("system", update_system, 1000, 5));
+    // STEP 1: MPPT data (calculates solar current, stores in shared context)
+    ESP_ERROR_CHECK(update_scheduler_register("mppt", mppt_manager_update_van_state, 1000, 10));
+    #if ENABLE_ENERGY_SIMULATION
+        // STEP 2: Inverter/chargers (calculates net current, stores in shared context)
+        ESP_ERROR_CHECK(update_scheduler_register("inverter", inverter_chargers_manager_update_van_state, 1000, 10));
+    #endif
+    // STEP 3: Battery data (integrates net current → voltage/SOC, MUST BE LAST of the chain)
+    ESP_ERROR_CHECK(update_scheduler_register("battery", battery_manager_update_van_state, 1000, 10));
+
+    // Fast-changing inputs
+    ESP_ERROR_CHECK(update_scheduler_register("door", update_door, 200, 2));
+    ESP_ERROR_CHECK(update_scheduler_register("projector", videoprojecteur_manager_update_van_state, 500, 5));
+    ESP_ERROR_CHECK(update_scheduler_register("leds", led_manager_update_van_state, 1000, 5));
+    // Slow data (fuel level, temperatures, CO2)
+    ESP_ERROR_CHECK(update_scheduler_register("heater", heater_manager_update_van_state, 2000, 5));
+    ESP_ERROR_CHECK(update_scheduler_register("htco2", htco2_sensor_manager_update_van_state, 5000, 5));
+
+    // Rolling aggregates of the values above (MUST BE LAST), sampled at 1 Hz
+    ESP_ERROR_CHECK(update_scheduler_register("telemetry", telemetry_aggregator_update_van_state, 1000, 5));
+    // History in flash (uses the aggregates)
+    ESP_ERROR_CHECK(update_scheduler_register("telemetry_log", update_telemetry_log, 1000, 5));
+    // Periodic save of the clock in NVS
+    ESP_ERROR_CHECK(update_scheduler_register("clock", van_clock_update_van_state, 1000, 20));
+    ESP_ERROR_CHECK(update_scheduler_register("debug", print_debug, 1000, 50));
+    return ESP_OK;
+}
+
 esp_err_t update_van_state(void) {
 
     van_state_t* van_state = protocol_get_van_state();
-    if (van_state) {
-        #if ENABLE_ENERGY_SIMULATION
-            // STEP 0: Update shared simulation time (MUST BE FIRST)
-            energy_simulation_update_time();
-        #endif
-        
-        // Update uptime
-        protocol_update_uptime();
-        
-        // STEP 1: Update MPPT data (calculates solar current, stores in shared context)
-        mppt_manager_update_van_state(van_state);
-        
-        #if ENABLE_ENERGY_SIMULATION
-            // STEP 2: Update inverter/chargers (calculates net current, stores in shared context)
-            inverter_chargers_manager_update_van_state(van_state);
-        #endif
-        
-        // STEP 3: Update battery data (integrates net current → voltage/SOC, MUST BE LAST)
-        battery_manager_update_van_state(van_state);
-        // Update sensor data
-        // TODO
-        van_state->sensors.door_open = get_door_state(); // Update door state mannually since no manager yet
-        // Update heater data
-        heater_manager_update_van_state(van_state);
-        // Update LED data
-        led_manager_update_van_state(van_state);
-        // Update video projector data
-        videoprojecteur_manager_update_van_state(van_state);
-        // Update HCO2T sensor data
-        htco2_sensor_manager_update_van_state(van_state);
-
-        // Finally, print the updated state for debugging
-        #if PRINT_DEBUG_VAN_STATE
-            protocol_print_state_summary();
-        #endif
-
-    } else {
+    if (!van_state) {
         ESP_LOGE(TAG, "Failed to get van state for update");
         return ESP_ERR_INVALID_STATE;
     }
-    
-    ESP_LOGD(TAG, "Van state updated successfully");
+
+    // Run the updates that are due, then make the new state visible to the
+    // other tasks (BLE serializer...)
+    if (update_scheduler_run(van_state) > 0) {
+        protocol_publish_van_state();
+        ESP_LOGD(TAG, "Van state updated successfully");
+    }
     return ESP_OK;
 }
 
@@ -284,6 +463,9 @@ void app_main(void) {
     ESP_LOGI(TAG, "Initializing led coordinator...");
     ESP_ERROR_CHECK(led_coordinator_init());
 
+    ESP_LOGI(TAG, "Initializing LED scenes...");
+    ESP_ERROR_CHECK(led_scenes_init());
+
     ESP_LOGI(TAG, "Initializing UART multiplexer...");
     ESP_ERROR_CHECK(uart_multiplexer_init());
 
@@ -302,6 +484,22 @@ void app_main(void) {
     ESP_LOGI(TAG, "Initializing video projector manager...");
     ESP_ERROR_CHECK(videoprojecteur_manager_init());
 
+    ESP_LOGI(TAG, "Initializing telemetry aggregator...");
+    ESP_ERROR_CHECK(telemetry_aggregator_init());
+
+    ESP_LOGI(TAG, "Initializing van clock...");
+    if (van_clock_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Clock storage unavailable, time kept until the next reboot only");
+    }
+
+    ESP_LOGI(TAG, "Initializing telemetry log...");
+    if (telemetry_log_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Telemetry log unavailable, continuing without history");
+    }
+
+    ESP_LOGI(TAG, "Initializing history transfer...");
+    ESP_ERROR_CHECK(history_transfer_init());
+
 #if ENABLE_ENERGY_SIMULATION
     ESP_LOGI(TAG, "Initializing energy simulation context...");
     energy_simulation_init();
@@ -321,25 +519,42 @@ void app_main(void) {
     ESP_LOGI(TAG, "MainPCB Van Controller is running...");
     
     
-    // Main loop - Send van state via BLE & monitor battery device
+    // Main loop - Update van state at each manager's rate & send it via BLE
+    ESP_ERROR_CHECK(register_van_state_updates());
     #if ENABLE_ENERGY_SIMULATION
         uint32_t loop_counter = 0;
     #endif
+    int64_t next_send_us = esp_timer_get_time();
     
     while(1) {
         
         update_van_state();
-        app_main_send_van_state_to_app();
-        
-        #if ENABLE_ENERGY_SIMULATION
-            // Print energy simulation summary every 10 seconds
-            loop_counter++;
-            // if (loop_counter % 10 == 0) {
-            //     energy_simulation_print_summary();
-            // }
-        #endif
+
+        int64_t now_us = esp_timer_get_time();
+        if (now_us >= next_send_us) {
+            app_main_send_van_state_to_app();
+            next_send_us += VAN_STATE_SEND_PERIOD_MS * 1000LL;
+            if (next_send_us <= now_us) {
+                next_send_us = now_us + VAN_STATE_SEND_PERIOD_MS * 1000LL;
+            }
+
+            #if ENABLE_ENERGY_SIMULATION
+                // Print energy simulation summary every 10 seconds
+                loop_counter++;
+                // if (loop_counter % 10 == 0) {
+                //     energy_simulation_print_summary();
+                // }
+            #endif
+        }
         
-        vTaskDelay(pdMS_TO_TICKS(1000));  // Update every 0.5 second
+        // Sleep until the next update or send
+        int64_t wake_us = update_scheduler_next_release_us();
+        if (next_send_us < wake_us) {
+            wake_us = next_send_us;
+        }
+        int64_t wait_ms = (wake_us - esp_timer_get_time() + 999) / 1000;
+        TickType_t wait = (wait_ms > 0) ? pdMS_TO_TICKS(wait_ms) : 0;
+        vTaskDelay(wait > 0 ? wait : 1);
     }
     
  
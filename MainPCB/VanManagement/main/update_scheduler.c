@@ -0,0 +1,136 @@
+#include "update_scheduler.h"
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "UPDATE_SCHED";
+
+#define OVERRUN_LOG_INTERVAL_US     (60LL * 1000000LL)  // One warning per minute per update
+
+typedef struct {
+    van_state_update_fn_t update;
+    int64_t next_release_us;
+    int64_t last_warning_us;
+    bool warned;
+    update_scheduler_stats_t stats;
+} schedule_entry_t;
+
+static schedule_entry_t entries[UPDATE_SCHEDULER_MAX_ENTRIES];
+static int entry_count = 0;
+static int64_t start_us = 0;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t update_scheduler_register(const char* name, van_state_update_fn_t update,
+                                    uint32_t period_ms, uint32_t deadline_ms) {
+    if (!name || !update || period_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (entry_count >= UPDATE_SCHEDULER_MAX_ENTRIES) {
+        ESP_LOGE(TAG, "Too many updates, %s not registered", name);
+        return ESP_ERR_NO_MEM;
+    }
+    if (start_us == 0) {
+        start_us = esp_timer_get_time();
+    }
+
+    schedule_entry_t *e = &entries[entry_count];
+    memset(e, 0, sizeof(*e));
+    e->update = update;
+    e->next_release_us = start_us;      // Same phase: equal periods run in the same pass
+    e->stats.name = name;
+    e->stats.period_ms = period_ms;
+    e->stats.deadline_ms = deadline_ms ? deadline_ms : period_ms;
+    entry_count++;
+
+    ESP_LOGI(TAG, "%s: every %" PRIu32 " ms, deadline %" PRIu32 " ms", name, period_ms, e->stats.deadline_ms);
+    return ESP_OK;
+}
+
+static void run_entry(schedule_entry_t *e, van_state_t* van_state, int64_t now) {
+    update_scheduler_stats_t *s = &e->stats;
+    int64_t period_us = (int64_t)s->period_ms * 1000;
+    int64_t lateness = now - e->next_release_us;
+
+    int64_t begin = esp_timer_get_time();
+    esp_err_t ret = e->update(van_state);
+    int64_t end = esp_timer_get_time();
+    uint32_t exec_us = (uint32_t)(end - begin);
+
+    // Next release, skipping the periods already over
+    uint32_t missed = 0;
+    e->next_release_us += period_us;
+    while (e->next_release_us <= end) {
+        e->next_release_us += period_us;
+        missed++;
+    }
+
+    bool overrun = exec_us > s->deadline_ms * 1000;
+    portENTER_CRITICAL(&stats_lock);
+    s->runs++;
+    s->last_us = exec_us;
+    s->avg_us = (s->runs == 1) ? exec_us : s->avg_us + ((int32_t)exec_us - (int32_t)s->avg_us) / 8;
+    if (exec_us > s->max_us) s->max_us = exec_us;
+    if (lateness > s->max_lateness_us) s->max_lateness_us = (uint32_t)lateness;
+    if (overrun) s->overruns++;
+    s->missed += missed;
+    if (ret != ESP_OK) s->errors++;
+    portEXIT_CRITICAL(&stats_lock);
+
+    if ((overrun || missed) && (!e->warned || end - e->last_warning_us >= OVERRUN_LOG_INTERVAL_US)) {
+        ESP_LOGW(TAG, "%s took %" PRIu32 " us (deadline %" PRIu32 " ms), %" PRIu32 " overruns, %" PRIu32 " missed periods",
+                 s->name, exec_us, s->deadline_ms, s->overruns, s->missed);
+        e->warned = true;
+        e->last_warning_us = end;
+    }
+}
+
+int update_scheduler_run(van_state_t* van_state) {
+    if (!van_state) {
+        return 0;
+    }
+
+    int run = 0;
+    for (int i = 0; i < entry_count; i++) {
+        int64_t now = esp_timer_get_time();
+        if (now >= entries[i].next_release_us) {
+            run_entry(&entries[i], van_state, now);
+            run++;
+        }
+    }
+    return run;
+}
+
+int64_t update_scheduler_next_release_us(void) {
+    int64_t next = INT64_MAX;
+    for (int i = 0; i < entry_count; i++) {
+        if (entries[i].next_release_us < next) {
+            next = entries[i].next_release_us;
+        }
+    }
+    return next;
+}
+
+esp_err_t update_scheduler_get_stats(int index, update_scheduler_stats_t* stats) {
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (index < 0 || index >= entry_count) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    portENTER_CRITICAL(&stats_lock);
+    *stats = entries[index].stats;
+    portEXIT_CRITICAL(&stats_lock);
+    return ESP_OK;
+}
+
+void update_scheduler_print_stats(void) {
+    ESP_LOGI(TAG, "Update          | period | runs   | last / avg / max us | late max us | overruns | missed | errors");
+    update_scheduler_stats_t s;
+    for (int i = 0; update_scheduler_get_stats(i, &s) == ESP_OK; i++) {
+        ESP_LOGI(TAG, "%-15s | %6" PRIu32 " | %6" PRIu32 " | %5" PRIu32 " / %5" PRIu32 " / %5" PRIu32 " | %11" PRIu32 " | %8" PRIu32 " | %6" PRIu32 " | %6" PRIu32,
+                 s.name, s.period_ms, s.runs, s.last_us, s.avg_us, s.max_us, s.max_lateness_us,
+                 s.overruns, s.missed, s.errors);
+    }
+}
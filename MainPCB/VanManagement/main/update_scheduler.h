@@ -0,0 +1,61 @@
+#ifndef UPDATE_SCHEDULER_H
+#define UPDATE_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "../communications/protocol.h"
+
+// Rate scheduler of the *_update_van_state() functions.
+// Each manager registers its period and deadline. update_scheduler_run()
+// runs the due ones in registration order (dependencies such as MPPT ->
+// battery -> telemetry keep their order when they share a period), all from
+// the update task, which stays the only writer of van_state (snapshots).
+// Releases are fixed-rate: a late update runs once and the missed periods
+// are counted, instead of piling up.
+
+#define UPDATE_SCHEDULER_MAX_ENTRIES    16
+
+typedef esp_err_t (*van_state_update_fn_t)(van_state_t* van_state);
+
+typedef struct {
+    const char *name;
+    uint32_t period_ms;
+    uint32_t deadline_ms;           // Maximum execution time
+    uint32_t runs;
+    uint32_t last_us;               // Execution time
+    uint32_t avg_us;
+    uint32_t max_us;
+    uint32_t max_lateness_us;       // Start delay after the release
+    uint32_t overruns;              // Executions longer than the deadline
+    uint32_t missed;                // Releases skipped because the update ran late
+    uint32_t errors;                // Update returned an error
+} update_scheduler_stats_t;
+
+/**
+ * @brief Register an update (before the first update_scheduler_run())
+ * @param deadline_ms Execution time budget, 0 = the period
+ * @return ESP_OK, ESP_ERR_NO_MEM if the table is full
+ */
+esp_err_t update_scheduler_register(const char* name, van_state_update_fn_t update,
+                                    uint32_t period_ms, uint32_t deadline_ms);
+
+/**
+ * @brief Run the updates that are due
+ * @return Number of updates run (publish van_state if > 0)
+ */
+int update_scheduler_run(van_state_t* van_state);
+
+// Time of the next release (esp_timer time, us)
+int64_t update_scheduler_next_release_us(void);
+
+/**
+ * @brief Copy the statistics of an update
+ * @return ESP_OK, ESP_ERR_NOT_FOUND past the last entry
+ */
+esp_err_t update_scheduler_get_stats(int index, update_scheduler_stats_t* stats);
+
+// Print execution time and overruns of every update (debug)
+void update_scheduler_print_stats(void);
+
+#endif // UPDATE_SCHEDULER_H
@@ -13,6 +13,7 @@
 
 #include <string.h>
 #include <math.h>
+#include <inttypes.h>
 #include "esp_log.h"
 
 static const char *TAG = "ENERGY_SIM";
@@ -49,7 +50,7 @@ void energy_simulation_print_summary(void) {
     ESP_LOGI(TAG, "╔════════════════════════════════════════════════════════════════╗");
     ESP_LOGI(TAG, "║          ENERGY SIMULATION COHERENCE CHECK                     ║");
     ESP_LOGI(TAG, "╠════════════════════════════════════════════════════════════════╣");
-    ESP_LOGI(TAG, "║ 🕐 TIME: tick=%lu (%.1fs) | Day: %.1f%% | AC:%s Eng:%s        ║",
+    ESP_LOGI(TAG, "║ 🕐 TIME: tick=%" PRIu32 " (%.1fs) | Day: %.1f%% | AC:%s Eng:%s        ║",
              g_sim_context.time_ticks, 
              g_sim_context.time_ticks * 0.02f,
              g_sim_context.day_cycle * 100.0f,
@@ -0,0 +1,135 @@
+#include "fuel_gauge.h"
+#include <inttypes.h>
+
+static const char *TAG = "FUEL_GAUGE";
+
+static adc_oneshot_unit_handle_t adc2_handle;
+static TaskHandle_t fuel_task_handle = NULL;
+
+static uint32_t filtered_q = 0;         // Raw ADC << FUEL_GAUGE_IIR_SHIFT
+static bool filter_ready = false;
+static volatile uint16_t filtered_raw = 0;
+static volatile uint8_t fuel_level = 0;
+static uint32_t refused_reads = 0;
+
+// The sender is 0 to 190 ohm in series with 220 ohm to GND:
+//   V = 3.3 * R / (R + 220), raw = V / 3.9 * 4095 (12 bits, DB_11 attenuation)
+// ADC value at every 5% of the sender range (R = 0, 9.5, ... 190 ohm)
+static const uint16_t level_table[] = {
+       0,  143,  275,  397,  510,  615,  713,  804,  890,  970, 1045,
+    1116, 1183, 1246, 1306, 1362, 1416, 1467, 1515, 1562, 1606,
+};
+#define LEVEL_TABLE_SIZE (sizeof(level_table) / sizeof(level_table[0]))
+#define LEVEL_TABLE_STEP 5              // % between entries
+
+static uint8_t raw_to_level(uint16_t raw) {
+    if (raw >= level_table[LEVEL_TABLE_SIZE - 1]) {
+        return 100;
+    }
+    size_t i = 1;
+    while (raw >= level_table[i]) {
+        i++;
+    }
+    // Linear between the two entries around raw
+    uint32_t span = level_table[i] - level_table[i - 1];
+    uint32_t into = raw - level_table[i - 1];
+    return (uint8_t)((i - 1) * LEVEL_TABLE_STEP + (into * LEVEL_TABLE_STEP + span / 2) / span);
+}
+
+// Insertion sort, the burst is short
+static uint16_t median(uint16_t *values, int count) {
+    for (int i = 1; i < count; i++) {
+        uint16_t v = values[i];
+        int j = i - 1;
+        while (j >= 0 && values[j] > v) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = v;
+    }
+    return values[count / 2];
+}
+
+static void fuel_gauge_task(void *pv) {
+    (void) pv;
+    TickType_t last_wake_time = xTaskGetTickCount();
+
+    while (1) {
+        uint16_t burst[FUEL_GAUGE_BURST];
+        int count = 0;
+        for (int i = 0; i < FUEL_GAUGE_BURST; i++) {
+            int reading;
+            if (adc_oneshot_read(adc2_handle, FUEL_GAUGE_ADC_CHANNEL, &reading) == ESP_OK) {
+                burst[count++] = (uint16_t)reading;
+            } else {
+                refused_reads++;            // ADC2 busy with the radio
+            }
+        }
+
+        if (count > 0) {
+            uint16_t sample = median(burst, count);
+            if (!filter_ready) {
+                filtered_q = (uint32_t)sample << FUEL_GAUGE_IIR_SHIFT;
+                filter_ready = true;
+            } else {
+                // y += (x - y) / 2^shift, in fixed point
+                filtered_q = filtered_q - (filtered_q >> FUEL_GAUGE_IIR_SHIFT) + sample;
+            }
+            uint16_t raw = (uint16_t)(filtered_q >> FUEL_GAUGE_IIR_SHIFT);
+            filtered_raw = raw;
+            fuel_level = raw_to_level(raw);
+        } else {
+            ESP_LOGD(TAG, "No fuel gauge reading in this burst (%" PRIu32 " refused)", refused_reads);
+        }
+
+        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(FUEL_GAUGE_PERIOD_MS));
+    }
+}
+
+esp_err_t fuel_gauge_init(void) {
+    // Set the fuel level gauge pin as input
+    gpio_config_t fuel_level_cfg = {
+        .pin_bit_mask = (1ULL << FUEL_GAUGE),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_DISABLE
+    };
+    gpio_config(&fuel_level_cfg);
+
+    // Initialize ADC2 for fuel gauge
+    adc_oneshot_unit_init_cfg_t adc_config = {
+        .unit_id = ADC_UNIT_2,
+        .ulp_mode = ADC_ULP_MODE_DISABLE
+    };
+    esp_err_t ret = adc_oneshot_new_unit(&adc_config, &adc2_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize ADC2");
+        return ret;
+    }
+    adc_oneshot_chan_cfg_t adc_chan_config = {
+        .bitwidth = ADC_BITWIDTH_12,
+        .atten = ADC_ATTEN_DB_11
+    };
+    ret = adc_oneshot_config_channel(adc2_handle, FUEL_GAUGE_ADC_CHANNEL, &adc_chan_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure ADC2 channel");
+        return ret;
+    }
+
+    BaseType_t r = xTaskCreate(fuel_gauge_task, "fuel_gauge", 3072, NULL, tskIDLE_PRIORITY + 2, &fuel_task_handle);
+    if (r != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create fuel gauge task");
+        fuel_task_handle = NULL;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+uint8_t fuel_gauge_get_level(void) {
+    return fuel_level;
+}
+
+uint16_t fuel_gauge_get_raw(void) {
+    return filtered_raw;
+}
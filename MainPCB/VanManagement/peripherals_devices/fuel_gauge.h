@@ -0,0 +1,34 @@
+#ifndef FUEL_GAUGE_H
+#define FUEL_GAUGE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "esp_adc/adc_oneshot.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "../common_includes/gpio_pinout.h"
+
+// The sender is on ADC2, which has no DMA mode on the ESP32-S3 and is shared
+// with the radio: bursts of oneshot reads, reads refused by the radio are skipped.
+#define FUEL_GAUGE_PERIOD_MS    1000    // One burst per period
+#define FUEL_GAUGE_BURST        9       // Reads per burst (median, odd)
+#define FUEL_GAUGE_IIR_SHIFT    4       // IIR weight 1/16: ~16 s time constant against slosh
+
+/**
+ * @brief Configure the ADC and start the background sampler
+ */
+esp_err_t fuel_gauge_init(void);
+
+/**
+ * @brief Filtered fuel level (0-100%), 0 until the first burst
+ */
+uint8_t fuel_gauge_get_level(void);
+
+/**
+ * @brief Filtered ADC value (for calibration)
+ */
+uint16_t fuel_gauge_get_raw(void);
+
+#endif // FUEL_GAUGE_H
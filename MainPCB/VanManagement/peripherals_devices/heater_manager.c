@@ -1,7 +1,113 @@
 #include "heater_manager.h"
+#include <string.h>
+#include <inttypes.h>
 
 static const char *TAG = "HEATER_MGR";
-static adc_oneshot_unit_handle_t adc2_handle;
+
+// Heater wire (protected by heater_lock)
+static portMUX_TYPE heater_lock = portMUX_INITIALIZER_UNLOCKED;
+static heater_cmd_t pending_command = HEATER_CMD_NONE;     // Sent until the heater answers
+static uint8_t target_temperature = 20;
+static int8_t room_temperature = 20;
+static heater_status_t heater_status;
+static TickType_t status_tick;
+static bool status_valid = false;
+
+static TaskHandle_t heater_task_handle = NULL;
+static TickType_t foreign_tick;
+static bool foreign_seen = false;
+static uint32_t frame_crc_errors = 0;
+static uint32_t missed_responses = 0;
+static uint32_t foreign_frames = 0;
+
+// Frames received while we were not talking: another controller is on the wire
+static void check_foreign_frames(uint8_t *buf, size_t buf_size) {
+    int len;
+    while ((len = uart_mux_receive(UART_MUX_HEATER, buf, buf_size, 0)) > 0) {
+        size_t offset = 0;
+        const uint8_t *frame;
+        while (heater_frame_next(buf, len, &offset, &frame, &frame_crc_errors)) {
+            foreign_frames++;
+            foreign_seen = true;
+            foreign_tick = xTaskGetTickCount();
+        }
+    }
+}
+
+// Send one controller frame and wait for the heater status, holding UART2
+static esp_err_t heater_exchange(uint8_t *buf, size_t buf_size) {
+    heater_request_t request;
+    portENTER_CRITICAL(&heater_lock);
+    request.command = pending_command;
+    request.target_temperature = target_temperature;
+    request.actual_temperature = room_temperature;
+    portEXIT_CRITICAL(&heater_lock);
+
+    uint8_t tx[HEATER_FRAME_LEN];
+    heater_encode_request(&request, tx);
+
+    esp_err_t ret = uart_mux_acquire(UART_MUX_HEATER, HEATER_ACQUIRE_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = ESP_ERR_TIMEOUT;
+    if (uart_mux_write(UART_MUX_HEATER, tx, sizeof(tx)) == sizeof(tx)) {
+        TickType_t start = xTaskGetTickCount();
+        while (ret != ESP_OK && xTaskGetTickCount() - start < pdMS_TO_TICKS(HEATER_RESPONSE_TIMEOUT_MS)) {
+            int len = uart_mux_receive(UART_MUX_HEATER, buf, buf_size, HEATER_RESPONSE_TIMEOUT_MS);
+            if (len <= 0) continue;
+
+            size_t offset = 0;
+            const uint8_t *frame;
+            while (heater_frame_next(buf, len, &offset, &frame, &frame_crc_errors)) {
+                if (memcmp(frame, tx, HEATER_FRAME_LEN) == 0) {
+                    continue;       // Our own frame, echoed on the single wire
+                }
+                heater_status_t status;
+                heater_decode_status(frame, &status);
+
+                portENTER_CRITICAL(&heater_lock);
+                heater_status = status;
+                status_tick = xTaskGetTickCount();
+                status_valid = true;
+                if (pending_command == request.command) {
+                    pending_command = HEATER_CMD_NONE;
+                }
+                portEXIT_CRITICAL(&heater_lock);
+                ret = ESP_OK;
+            }
+        }
+    } else {
+        ret = ESP_FAIL;
+    }
+
+    uart_mux_release(UART_MUX_HEATER);
+    return ret;
+}
+
+static void heater_task(void *pv) {
+    (void) pv;
+    static uint8_t buf[UART_MUX_FRAME_MAX];
+    ESP_LOGI(TAG, "Heater bus task started");
+
+    TickType_t last_wake_time = xTaskGetTickCount();
+    while (1) {
+        check_foreign_frames(buf, sizeof(buf));
+        if (foreign_seen && xTaskGetTickCount() - foreign_tick < pdMS_TO_TICKS(HEATER_FOREIGN_HOLDOFF_MS)) {
+            // Never talk over the stock controller
+            ESP_LOGW(TAG, "Another controller is on the heater wire (%" PRIu32 " frames), not polling", foreign_frames);
+        } else {
+            esp_err_t ret = heater_exchange(buf, sizeof(buf));
+            if (ret != ESP_OK) {
+                missed_responses++;
+                ESP_LOGD(TAG, "No answer from heater (%s, %" PRIu32 " missed)", esp_err_to_name(ret), missed_responses);
+            }
+        }
+
+        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(HEATER_POLL_INTERVAL_MS));
+    }
+}
 
 esp_err_t heater_manager_init(void){
     ESP_LOGI(TAG, "Initializing heater manager...");
@@ -15,45 +121,13 @@ esp_err_t heater_manager_init(void){
         .intr_type = GPIO_INTR_DISABLE
     };
 
-    // Set diesel heater Communication pin as bi-directional (handled by UART mux)
-    gpio_config_t comms_cfg = {
-        .pin_bit_mask = (1ULL << HEATER_TX),
-        .mode = GPIO_MODE_INPUT_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-
-    // Set the fuel level gauge pin as input
-    gpio_config_t fuel_level_cfg = {
-        .pin_bit_mask = (1ULL << FUEL_GAUGE),
-        .mode = GPIO_MODE_INPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_ENABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-
     gpio_config(&diesel_cfg);
-    gpio_config(&comms_cfg);
-    gpio_config(&fuel_level_cfg);
+    // The heater communication pin (HEATER_TX) is configured by the UART mux
 
-    // Initialize ADC2 for fuel gauge
-    adc_oneshot_unit_init_cfg_t adc_config = {
-        .unit_id = ADC_UNIT_2,
-        .ulp_mode = ADC_ULP_MODE_DISABLE
-    };
-    esp_err_t ret = adc_oneshot_new_unit(&adc_config, &adc2_handle);
+    // Fuel gauge sampler (ADC2)
+    esp_err_t ret = fuel_gauge_init();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize ADC2");
-        return ret;
-    }
-    adc_oneshot_chan_cfg_t adc_chan_config = {
-        .bitwidth = ADC_BITWIDTH_12,
-        .atten = ADC_ATTEN_DB_11
-    };
-    ret = adc_oneshot_config_channel(adc2_handle, FUEL_GAUGE_ADC_CHANNEL, &adc_chan_config);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure ADC2 channel");
+        ESP_LOGE(TAG, "Failed to initialize fuel gauge");
         return ret;
     }
 
@@ -64,39 +138,20 @@ esp_err_t heater_manager_init(void){
     ESP_LOGI(TAG, "Initializing fan manager...");
     ESP_ERROR_CHECK(fan_manager_init());
 
+    // Heater serial protocol, polled on UART2
+    BaseType_t r = xTaskCreate(heater_task, "heater_task", 4096, NULL, tskIDLE_PRIORITY + 5, &heater_task_handle);
+    if (r != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create heater task");
+        heater_task_handle = NULL;
+        return ESP_FAIL;
+    }
+
     return ESP_OK;
 }
 
 uint8_t heater_manager_get_fuel_level(void){
-    // The fuel gauge is a resisor 0 to 190 ohm in series with a 220 ohm resistor to GND
-    // The voltage at the fuel gauge pin is then:
-    // V_fuel = 3.3 * (R_fuel / (R_fuel + 220))
-    int adc_reading = 0;
-    esp_err_t ret = adc_oneshot_read(adc2_handle, FUEL_GAUGE_ADC_CHANNEL, &adc_reading);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to read fuel level ADC");
-        return 0;
-    }
-    // ESP_LOGI(TAG, "Fuel level ADC reading: %d", adc_reading);
-    float voltage = (adc_reading / 4095.0) * 3.9; // Assuming 12-bit ADC with DB_11 attenuation (0-3.9V)
-    // ESP_LOGI(TAG, "Fuel level voltage: %.2f V", voltage);
-
-    // Calculate R_fuel from voltage
-    float r_fuel = 0.0;
-    float ratio = voltage / 3.3;
-    float denom = 1.0 - ratio;
-    if (ratio >= 1.0) {
-        r_fuel = 190.0; // Max resistance when voltage >= 3.3V
-    } else if (fabs(denom) < 0.001) {
-        r_fuel = 190.0; // Max resistance when voltage ≈ 3.3V
-    } else {
-        r_fuel = (ratio * 220.0) / denom;
-    }
-    // ESP_LOGI(TAG, "Calculated fuel gauge resistance: %.2f ohms", r_fuel);
-    // Calculate fuel level percentage
-    uint8_t fuel_level_percent = (r_fuel / 190.0) * 100.0;
-
-    return fuel_level_percent;
+    // Filtered in the background (fuel_gauge.c)
+    return fuel_gauge_get_level();
 }
 
 esp_err_t heater_manager_set_air_heater(bool state, uint8_t fan_speed_percent){
@@ -120,28 +175,55 @@ esp_err_t heater_manager_set_air_heater(bool state, uint8_t fan_speed_percent){
 }
 
 esp_err_t heater_manager_set_diesel_water_heater(bool state, uint8_t temperature){
-    // TODO: Found how the heater communication protocol work to set target temperature and read status
     ESP_LOGI(TAG, "Setting diesel water heater to %s with target temperature %d°C", state ? "ON" : "OFF", temperature);
 
     // Control the diesel heater power signal
     gpio_set_level(HEATER_ON_SIG, state ? 1 : 0);
 
-    // Here you would add code to send the target temperature to the diesel heater via UART mux
+    // Start/stop command and setpoint go in the next controller frame
+    portENTER_CRITICAL(&heater_lock);
+    pending_command = state ? HEATER_CMD_START : HEATER_CMD_STOP;
+    target_temperature = temperature;
+    portEXIT_CRITICAL(&heater_lock);
 
     return ESP_OK;
 }
 
+esp_err_t heater_manager_get_status(heater_status_t* status){
+    if(!status){
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&heater_lock);
+    bool fresh = status_valid && (xTaskGetTickCount() - status_tick) < pdMS_TO_TICKS(HEATER_STATUS_TIMEOUT_MS);
+    *status = heater_status;
+    portEXIT_CRITICAL(&heater_lock);
+
+    return fresh ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
 esp_err_t heater_manager_update_van_state(van_state_t* van_state){
     if(!van_state){
         return ESP_ERR_INVALID_ARG;
     }
 
-    van_state->heater.heater_on = gpio_get_level(HEATER_ON_SIG) ? true : false; // TODO: Undersntant the protocol of the heater to get actual heater state
-    van_state->heater.target_air_temperature = 22.0; // TODO: get actual target temperature
-    van_state->heater.actual_air_temperature = 20.0; // TODO: get actual air temperature from sensor
-    van_state->heater.antifreeze_temperature = 15.0; // TODO: get actual antifreeze temperature
+    // The cabin temperature is the thermostat input sent to the heater
+    portENTER_CRITICAL(&heater_lock);
+    room_temperature = (int8_t)lroundf(van_state->sensors.cabin_temperature);
+    van_state->heater.target_air_temperature = target_temperature;
+    portEXIT_CRITICAL(&heater_lock);
+    van_state->heater.actual_air_temperature = van_state->sensors.cabin_temperature;
+
+    heater_status_t status;
+    if (heater_manager_get_status(&status) == ESP_OK) {
+        van_state->heater.heater_on = status.on || status.run_state != HEATER_STATE_OFF;
+        van_state->heater.antifreeze_temperature = status.body_temperature;
+        van_state->heater.error_code = status.error;
+    } else {
+        // No answer on the heater wire: only the power signal is known
+        van_state->heater.heater_on = gpio_get_level(HEATER_ON_SIG) ? true : false;
+    }
     van_state->heater.fuel_level_percent = heater_manager_get_fuel_level();
-    van_state->heater.error_code = 0; // TODO: get actual error code from heater
     van_state->heater.pump_active = pump_manager_get_state();
     van_state->heater.radiator_fan_speed = fan_manager_get_speed();
     return ESP_OK;
@@ -4,18 +4,43 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
-#include "esp_adc/adc_oneshot.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include <math.h>
 
 #include "../common_includes/gpio_pinout.h"
 #include "../communications/protocol.h"
+#include "../communications/uart/uart_multiplexer.h"
 #include "fan_manager.h"
 #include "pump_manager.h"
+#include "fuel_gauge.h"
+#include "heater_protocol.h"
+
+#define HEATER_POLL_INTERVAL_MS     1000    // Frame rate of the stock controller
+#define HEATER_RESPONSE_TIMEOUT_MS  200     // Heater answers ~50 ms after our frame
+#define HEATER_ACQUIRE_TIMEOUT_MS   500
+#define HEATER_STATUS_TIMEOUT_MS    5000    // Status older than this is not reported
+#define HEATER_FOREIGN_HOLDOFF_MS   10000   // Silent this long after another controller was heard
 
 esp_err_t heater_manager_init(void);
 uint8_t heater_manager_get_fuel_level(void);
 esp_err_t heater_manager_set_air_heater(bool state, uint8_t fan_speed_percent);
+
+/**
+ * @brief Switch the diesel heater on/off and set its thermostat
+ *
+ * Drives HEATER_ON_SIG and sends the start/stop command in the next
+ * controller frame on the heater wire (see heater_protocol.h).
+ * @param temperature Setpoint (°C), clamped to HEATER_TEMP_MIN..HEATER_TEMP_MAX
+ */
 esp_err_t heater_manager_set_diesel_water_heater(bool state, uint8_t temperature);
+
+/**
+ * @brief Get the last status frame of the heater
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if no recent answer from the heater
+ */
+esp_err_t heater_manager_get_status(heater_status_t* status);
+
 esp_err_t heater_manager_update_van_state(van_state_t* van_state);
 
 #endif // HEATER_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "heater_protocol.h"
+#include <string.h>
+
+static inline uint16_t read_u16(const uint8_t* p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline void write_u16(uint8_t* p, uint16_t value)
+{
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+}
+
+uint16_t heater_crc16(const uint8_t* data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+void heater_encode_request(const heater_request_t* request, uint8_t* out)
+{
+    uint8_t target = request->target_temperature;
+    if (target < HEATER_TEMP_MIN) target = HEATER_TEMP_MIN;
+    if (target > HEATER_TEMP_MAX) target = HEATER_TEMP_MAX;
+
+    memset(out, 0, HEATER_FRAME_LEN);
+    out[0] = HEATER_FRAME_START;
+    out[1] = HEATER_FRAME_SIZE_BYTE;
+    out[HEATER_TX_COMMAND] = (uint8_t)request->command;
+    out[HEATER_TX_ACTUAL_TEMP] = (uint8_t)request->actual_temperature;
+    out[HEATER_TX_TARGET_TEMP] = target;
+    out[HEATER_TX_MIN_PUMP] = HEATER_DEFAULT_MIN_PUMP;
+    out[HEATER_TX_MAX_PUMP] = HEATER_DEFAULT_MAX_PUMP;
+    write_u16(&out[HEATER_TX_MIN_FAN], HEATER_DEFAULT_MIN_FAN);
+    write_u16(&out[HEATER_TX_MAX_FAN], HEATER_DEFAULT_MAX_FAN);
+    out[HEATER_TX_VOLTAGE] = HEATER_DEFAULT_VOLTAGE;
+    out[HEATER_TX_FAN_MAGNETS] = HEATER_DEFAULT_FAN_MAGNETS;
+    out[HEATER_TX_MODE] = HEATER_MODE_THERMOSTAT;
+    out[HEATER_TX_MIN_TEMP] = HEATER_TEMP_MIN;
+    out[HEATER_TX_MAX_TEMP] = HEATER_TEMP_MAX;
+    out[HEATER_TX_GLOW_POWER] = HEATER_DEFAULT_GLOW_POWER;
+
+    write_u16(&out[HEATER_FRAME_LEN - 2], heater_crc16(out, HEATER_FRAME_LEN - 2));
+}
+
+bool heater_frame_next(const uint8_t* buf, size_t len, size_t* offset, const uint8_t** frame,
+                       uint32_t* crc_errors)
+{
+    size_t pos = *offset;
+
+    while (pos + HEATER_FRAME_LEN <= len) {
+        if (buf[pos] != HEATER_FRAME_START || buf[pos + 1] != HEATER_FRAME_SIZE_BYTE) {
+            pos++;
+            continue;
+        }
+
+        const uint8_t* candidate = &buf[pos];
+        if (heater_crc16(candidate, HEATER_FRAME_LEN - 2) != read_u16(&candidate[HEATER_FRAME_LEN - 2])) {
+            if (crc_errors) (*crc_errors)++;
+            pos++;                  // Resync on the next start byte
+            continue;
+        }
+
+        *frame = candidate;
+        *offset = pos + HEATER_FRAME_LEN;
+        return true;
+    }
+
+    *offset = len;
+    return false;
+}
+
+void heater_decode_status(const uint8_t* frame, heater_status_t* status)
+{
+    uint8_t error = frame[HEATER_RX_ERROR];
+    uint8_t stored_error = frame[HEATER_RX_STORED_ERROR];
+
+    status->run_state = frame[HEATER_RX_RUN_STATE];
+    status->on = frame[HEATER_RX_ON] == 1;
+    status->error = (error > 1) ? error - 1 : 0;
+    status->stored_error = (stored_error > 1) ? stored_error - 1 : 0;
+    status->supply_dv = read_u16(&frame[HEATER_RX_SUPPLY]);
+    status->fan_rpm = read_u16(&frame[HEATER_RX_FAN_RPM]);
+    status->fan_dv = read_u16(&frame[HEATER_RX_FAN_VOLTAGE]);
+    status->body_temperature = (int16_t)read_u16(&frame[HEATER_RX_BODY_TEMP]);
+    status->glow_dv = read_u16(&frame[HEATER_RX_GLOW_VOLTAGE]);
+    status->glow_ca = read_u16(&frame[HEATER_RX_GLOW_CURRENT]);
+    status->pump_dhz = frame[HEATER_RX_PUMP_FREQ];
+}
@@ -0,0 +1,120 @@
+#ifndef HEATER_PROTOCOL_H
+#define HEATER_PROTOCOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Chinese diesel heater single-wire ("blue wire") protocol, 25000 baud 8N1.
+// The controller sends a 24-byte frame about once per second, the heater
+// answers with a 24-byte status frame ~50 ms later. Both frames:
+//   0x76 | 0x16 (22 bytes follow) | 20 data bytes | CRC16 MODBUS (big endian)
+// The CRC covers bytes 0 to 21. Multi-byte values are big endian.
+// Here the MainPCB is the controller: the original one must be disconnected.
+
+#define HEATER_BAUD_RATE        25000
+#define HEATER_FRAME_LEN        24
+#define HEATER_FRAME_START      0x76
+#define HEATER_FRAME_SIZE_BYTE  0x16
+
+// Controller frame offsets
+#define HEATER_TX_COMMAND       2       // u8, heater_cmd_t
+#define HEATER_TX_ACTUAL_TEMP   3       // u8, °C measured by the controller (thermostat input)
+#define HEATER_TX_TARGET_TEMP   4       // u8, °C
+#define HEATER_TX_MIN_PUMP      5       // u8, Hz x10
+#define HEATER_TX_MAX_PUMP      6       // u8, Hz x10
+#define HEATER_TX_MIN_FAN       7       // u16, RPM
+#define HEATER_TX_MAX_FAN       9       // u16, RPM
+#define HEATER_TX_VOLTAGE       11      // u8, V x10 (120 or 240)
+#define HEATER_TX_FAN_MAGNETS   12      // u8, fan speed sensor pulses per turn
+#define HEATER_TX_MODE          13      // u8, HEATER_MODE_*
+#define HEATER_TX_MIN_TEMP      14      // u8, °C
+#define HEATER_TX_MAX_TEMP      15      // u8, °C
+#define HEATER_TX_GLOW_POWER    16      // u8, 1-6
+#define HEATER_TX_PRIME         17      // u8, 0x5A = fuel pump priming
+
+// Heater frame offsets
+#define HEATER_RX_RUN_STATE     2       // u8, heater_run_state_t
+#define HEATER_RX_ON            3       // u8, 1 = on
+#define HEATER_RX_ERROR         4       // u8, 0/1 = no error, else E-(n-1)
+#define HEATER_RX_SUPPLY        5       // u16, V x10
+#define HEATER_RX_FAN_RPM       7       // u16, RPM
+#define HEATER_RX_FAN_VOLTAGE   9       // u16, V x10
+#define HEATER_RX_BODY_TEMP     11      // u16, °C (heat exchanger / coolant)
+#define HEATER_RX_GLOW_VOLTAGE  13      // u16, V x10
+#define HEATER_RX_GLOW_CURRENT  15      // u16, A x100
+#define HEATER_RX_PUMP_FREQ     17      // u8, Hz x10
+#define HEATER_RX_STORED_ERROR  18      // u8, last error (same coding)
+
+#define HEATER_MODE_THERMOSTAT  0x32
+#define HEATER_MODE_FIXED_HZ    0xCD
+
+// Installation settings sent in every controller frame (defaults of the stock controller)
+#define HEATER_DEFAULT_MIN_PUMP     14      // 1.4 Hz
+#define HEATER_DEFAULT_MAX_PUMP     43      // 4.3 Hz
+#define HEATER_DEFAULT_MIN_FAN      1450
+#define HEATER_DEFAULT_MAX_FAN      4500
+#define HEATER_DEFAULT_VOLTAGE      120     // 12 V system
+#define HEATER_DEFAULT_FAN_MAGNETS  1
+#define HEATER_DEFAULT_GLOW_POWER   5
+#define HEATER_TEMP_MIN             8       // °C, setpoint range of the heater
+#define HEATER_TEMP_MAX             35
+
+typedef enum {
+    HEATER_CMD_NONE = 0x00,         // Status request
+    HEATER_CMD_STOP = 0x05,
+    HEATER_CMD_START = 0xA0,
+} heater_cmd_t;
+
+typedef enum {
+    HEATER_STATE_OFF = 0,
+    HEATER_STATE_STARTING,
+    HEATER_STATE_PREHEAT,           // Glow plug heating
+    HEATER_STATE_RETRY,             // Ignition failed, retrying
+    HEATER_STATE_IGNITED,
+    HEATER_STATE_RUNNING,
+    HEATER_STATE_STOPPING,
+    HEATER_STATE_COOLDOWN,
+} heater_run_state_t;
+
+typedef struct {
+    heater_cmd_t command;
+    int8_t actual_temperature;      // °C
+    uint8_t target_temperature;     // °C, clamped to HEATER_TEMP_MIN..MAX
+} heater_request_t;
+
+typedef struct {
+    uint8_t run_state;              // heater_run_state_t
+    bool on;
+    uint8_t error;                  // E-xx code, 0 if none
+    uint8_t stored_error;
+    uint16_t supply_dv;             // V x10
+    uint16_t fan_rpm;
+    uint16_t fan_dv;                // V x10
+    int16_t body_temperature;       // °C
+    uint16_t glow_dv;               // V x10
+    uint16_t glow_ca;               // A x100
+    uint8_t pump_dhz;               // Hz x10
+} heater_status_t;
+
+// CRC-16/MODBUS (polynomial 0xA001 reflected, init 0xFFFF)
+uint16_t heater_crc16(const uint8_t* data, size_t len);
+
+// Encode a controller frame into out (HEATER_FRAME_LEN bytes)
+void heater_encode_request(const heater_request_t* request, uint8_t* out);
+
+/**
+ * @brief Find the next valid frame in a buffer, without copying it
+ *
+ * @param offset Where to start, updated past the frame (or to len)
+ * @param frame Receives a pointer to the HEATER_FRAME_LEN bytes of the frame
+ * @param crc_errors Incremented for each frame rejected by its CRC (may be NULL)
+ * @return true if a frame was found
+ */
+bool heater_frame_next(const uint8_t* buf, size_t len, size_t* offset, const uint8_t** frame,
+                       uint32_t* crc_errors);
+
+// Decode a heater status frame
+void heater_decode_status(const uint8_t* frame, heater_status_t* status);
+
+#endif // HEATER_PROTOCOL_H
@@ -0,0 +1,98 @@
+#include "htco2_protocol.h"
+
+static inline uint16_t read_u16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint8_t htco2_crc8(const uint8_t* data, size_t len, uint8_t crc)
+{
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+bool htco2_frame_next(const uint8_t* buf, size_t len, size_t* offset, htco2_frame_t* frame,
+                      uint32_t* crc_errors)
+{
+    size_t pos = *offset;
+
+    while (pos + HTCO2_FRAME_OVERHEAD <= len) {
+        if (buf[pos] != HTCO2_FRAME_SYNC) {
+            pos++;
+            continue;
+        }
+
+        uint8_t payload_len = buf[pos + 1];
+        if (payload_len == 0 || payload_len > HTCO2_PAYLOAD_MAX) {
+            pos++;                  // Not a frame start
+            continue;
+        }
+        if (pos + HTCO2_FRAME_OVERHEAD + payload_len > len) {
+            break;                  // Truncated
+        }
+
+        const uint8_t* payload = &buf[pos + 2];
+        uint8_t crc = htco2_crc8(&buf[pos + 1], 1 + payload_len, 0xFF);
+        if (crc != payload[payload_len]) {
+            if (crc_errors) (*crc_errors)++;
+            pos++;                  // Resync on the next SYNC byte
+            continue;
+        }
+
+        frame->type = payload[0];
+        frame->payload = payload;
+        frame->len = payload_len;
+        *offset = pos + HTCO2_FRAME_OVERHEAD + payload_len;
+        return true;
+    }
+
+    *offset = len;
+    return false;
+}
+
+bool htco2_decode_measurement(const htco2_frame_t* frame, htco2_measurement_t* measurement)
+{
+    if (frame->type != HTCO2_MSG_MEASUREMENT || frame->len < HTCO2_MEAS_LEN) {
+        return false;
+    }
+
+    const uint8_t* p = frame->payload;
+    uint16_t temp_raw = read_u16(&p[HTCO2_MEAS_TEMP_RAW]);
+    uint16_t hum_raw = read_u16(&p[HTCO2_MEAS_HUM_RAW]);
+
+    measurement->co2 = read_u16(&p[HTCO2_MEAS_CO2]);
+    // SCD41 datasheet: T = -45 + 175 * raw / 65535, RH = 100 * raw / 65535
+    measurement->t_tenths = (int16_t)(-450 + ((int32_t)temp_raw * 1750) / 65535);
+    measurement->h_tenths = (uint16_t)(((uint32_t)hum_raw * 1000) / 65535);
+    measurement->light = read_u16(&p[HTCO2_MEAS_LIGHT]);
+    measurement->sensor_crc_errors = p[HTCO2_MEAS_CRC_ERRORS];
+    return true;
+}
+
+bool htco2_decode_config(const htco2_frame_t* frame, htco2_config_t* config)
+{
+    if (frame->type != HTCO2_MSG_CONFIG || frame->len < HTCO2_CONFIG_LEN) {
+        return false;
+    }
+
+    config->interval_s = read_u16(&frame->payload[HTCO2_CONFIG_INTERVAL]);
+    config->mode = (htco2_scd41_mode_t)frame->payload[HTCO2_CONFIG_MODE];
+    return true;
+}
+
+size_t htco2_encode_request(htco2_cmd_t cmd, uint16_t arg, uint8_t* out)
+{
+    size_t len = 0;
+    out[len++] = HTCO2_WAKE_BYTE;
+    out[len++] = (uint8_t)cmd;
+    if (cmd == HTCO2_CMD_SET_INTERVAL) {
+        out[len++] = (uint8_t)arg;
+        out[len++] = (uint8_t)(arg >> 8);
+    }
+    return len;
+}
@@ -0,0 +1,101 @@
+#ifndef HTCO2_PROTOCOL_H
+#define HTCO2_PROTOCOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// The MainPCB sends a request (HTCO2_WAKE_BYTE then a htco2_cmd_t) on the
+// single-wire UART, the ATtiny402 HTCO2 node (HTCO2/ATtiny402_HTCO2.ino)
+// answers with a frame:
+//   SYNC (0xA5) | LEN | payload[LEN] | CRC8
+// CRC8 covers LEN and the payload, with the SCD41 polynomial (0x31, init 0xFF).
+// Payload byte 0 is the message type, values are little endian.
+// Keep these definitions in sync with the sketch.
+
+#define HTCO2_FRAME_SYNC        0xA5
+#define HTCO2_FRAME_OVERHEAD    3       // SYNC + LEN + CRC8
+#define HTCO2_PAYLOAD_MAX       16
+
+// The node sleeps in standby: the start bit of this byte wakes it, the byte
+// itself may be lost or garbled and is ignored
+#define HTCO2_WAKE_BYTE         0xFF
+#define HTCO2_REQUEST_MAX       4       // Wake byte + command + u16 argument
+
+// Requests (never HTCO2_FRAME_SYNC)
+typedef enum {
+    HTCO2_CMD_MEASURE_NOW = 0x11,   // Read the SCD41 if it has new data, answer the measurement
+    HTCO2_CMD_SEND_LAST = 0x12,     // Answer the last measurement again (no sensor access)
+    HTCO2_CMD_SET_INTERVAL = 0x13,  // + u16 interval (s), answered with HTCO2_MSG_CONFIG
+} htco2_cmd_t;
+
+typedef enum {
+    HTCO2_MSG_MEASUREMENT = 0x01,
+    HTCO2_MSG_CONFIG = 0x02,
+} htco2_msg_type_t;
+
+// SCD41 operating mode, chosen by the node from the interval
+typedef enum {
+    HTCO2_MODE_PERIODIC = 0,        // Interval < 30 s (new data every 5 s)
+    HTCO2_MODE_LOW_POWER = 1,       // Interval < 60 s (new data every 30 s)
+    HTCO2_MODE_SINGLE_SHOT = 2,     // One measurement per interval, sensor idle in between
+} htco2_scd41_mode_t;
+
+#define HTCO2_INTERVAL_MIN_S    5
+
+// HTCO2_MSG_MEASUREMENT payload offsets
+#define HTCO2_MEAS_CO2          1       // u16, ppm
+#define HTCO2_MEAS_TEMP_RAW     3       // u16, SCD41 raw temperature
+#define HTCO2_MEAS_HUM_RAW      5       // u16, SCD41 raw humidity
+#define HTCO2_MEAS_LIGHT        7       // u16, photoresistor ADC (0-1023)
+#define HTCO2_MEAS_CRC_ERRORS   9       // u8, SCD41 reads rejected by their CRC (wraps)
+#define HTCO2_MEAS_LEN          10
+
+// HTCO2_MSG_CONFIG payload offsets
+#define HTCO2_CONFIG_INTERVAL   1       // u16, s (after clamping by the node)
+#define HTCO2_CONFIG_MODE       3       // u8, htco2_scd41_mode_t
+#define HTCO2_CONFIG_LEN        4
+
+// A frame found in a receive buffer (payload points into that buffer)
+typedef struct {
+    uint8_t type;
+    const uint8_t* payload;         // Starts with the type byte
+    uint8_t len;
+} htco2_frame_t;
+
+typedef struct {
+    uint16_t co2;                   // ppm
+    int16_t t_tenths;               // °C x10
+    uint16_t h_tenths;              // %RH x10
+    uint16_t light;
+    uint8_t sensor_crc_errors;
+} htco2_measurement_t;
+
+typedef struct {
+    uint16_t interval_s;
+    htco2_scd41_mode_t mode;
+} htco2_config_t;
+
+// Sensirion CRC-8 (polynomial 0x31, init 0xFF)
+uint8_t htco2_crc8(const uint8_t* data, size_t len, uint8_t crc);
+
+/**
+ * @brief Find the next valid frame in a buffer, without copying it
+ *
+ * @param offset Where to start, updated past the frame (or to len)
+ * @param crc_errors Incremented for each frame rejected by its CRC (may be NULL)
+ * @return true if a frame was found
+ */
+bool htco2_frame_next(const uint8_t* buf, size_t len, size_t* offset, htco2_frame_t* frame,
+                      uint32_t* crc_errors);
+
+// Decode a HTCO2_MSG_MEASUREMENT frame (false if it is not one)
+bool htco2_decode_measurement(const htco2_frame_t* frame, htco2_measurement_t* measurement);
+
+// Decode a HTCO2_MSG_CONFIG frame (false if it is not one)
+bool htco2_decode_config(const htco2_frame_t* frame, htco2_config_t* config);
+
+// Encode a request, returns its length (buffer of HTCO2_REQUEST_MAX bytes)
+size_t htco2_encode_request(htco2_cmd_t cmd, uint16_t arg, uint8_t* out);
+
+#endif // HTCO2_PROTOCOL_H
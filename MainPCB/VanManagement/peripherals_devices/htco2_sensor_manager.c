@@ -6,67 +6,98 @@ static TaskHandle_t htco2_task_handle = NULL;
 
 htco2_sensor_t htco2_data = {0};
 
-// Buffer to accumulate a line
-static char line_buf[256];
-static size_t line_pos = 0;
+static uint32_t frame_crc_errors = 0;
+static uint32_t missed_responses = 0;
+
+// Measurement interval of the node, sent again after a missed answer (node reset)
+static uint16_t interval_s = HTCO2_DEFAULT_INTERVAL_S;
+static volatile bool interval_pending = true;
+
+static void store_measurement(const htco2_measurement_t *meas) {
+    htco2_data.co2 = meas->co2;
+    htco2_data.t_tenths = meas->t_tenths;
+    htco2_data.h_tenths = meas->h_tenths;
+    htco2_data.light = meas->light;
+    ESP_LOGD(TAG, "HCO2T: CO2=%u ppm, T=%.1f°C, RH=%.1f%%, light=%u (sensor CRC errors: %u, frame CRC errors: %" PRIu32 ")",
+             meas->co2, meas->t_tenths / 10.0f, meas->h_tenths / 10.0f, meas->light,
+             meas->sensor_crc_errors, frame_crc_errors);
+}
+
+// One request/response exchange while holding UART2. Succeeds when the answer
+// expected by the caller (meas or config, the other one is NULL) is received.
+static esp_err_t htco2_request(htco2_cmd_t cmd, uint16_t arg, htco2_measurement_t *meas, htco2_config_t *config) {
+    esp_err_t ret = uart_mux_acquire(UART_MUX_HCO2T, HTCO2_ACQUIRE_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Frames are decoded in place in the receive buffer
+    static uint8_t buf[UART_MUX_FRAME_MAX];
+    uint8_t request[HTCO2_REQUEST_MAX];
+    size_t request_len = htco2_encode_request(cmd, arg, request);
+    ret = ESP_ERR_TIMEOUT;
+
+    if (uart_mux_write(UART_MUX_HCO2T, request, request_len) == (int)request_len) {
+        TickType_t start = xTaskGetTickCount();
+        while (ret != ESP_OK && xTaskGetTickCount() - start < pdMS_TO_TICKS(HTCO2_RESPONSE_TIMEOUT_MS)) {
+            // Our request is echoed on the single wire, the decoder skips it
+            int len = uart_mux_receive(UART_MUX_HCO2T, buf, sizeof(buf), HTCO2_RESPONSE_TIMEOUT_MS);
+            if (len <= 0) continue;
+
+            size_t offset = 0;
+            htco2_frame_t frame;
+            while (htco2_frame_next(buf, len, &offset, &frame, &frame_crc_errors)) {
+                if (meas && htco2_decode_measurement(&frame, meas)) {
+                    ret = ESP_OK;
+                } else if (config && htco2_decode_config(&frame, config)) {
+                    ret = ESP_OK;
+                } else {
+                    ESP_LOGW(TAG, "Unexpected HCO2T message type 0x%02X (%d bytes)", frame.type, frame.len);
+                }
+            }
+        }
+    } else {
+        ret = ESP_FAIL;
+    }
+
+    uart_mux_release(UART_MUX_HCO2T);
+    return ret;
+}
 
 static void htco2_task(void *pv) {
     (void) pv;
     ESP_LOGI(TAG, "HCO2T task started");
 
     while (1) {
-        // Ensure UART2 is switched to HCO2T
-        esp_err_t err = uart_mux_switch_sensor(SENSOR_HCO2T);
-        if (err != ESP_OK) {
-            ESP_LOGW(TAG, "Failed to switch UART2 to HCO2T: %s", esp_err_to_name(err));
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            continue;
+        if (interval_pending) {
+            interval_pending = false;
+            htco2_config_t config;
+            esp_err_t ret = htco2_request(HTCO2_CMD_SET_INTERVAL, interval_s, NULL, &config);
+            if (ret == ESP_OK) {
+                ESP_LOGI(TAG, "HCO2T interval %us (SCD41 mode %d)", config.interval_s, config.mode);
+            } else {
+                interval_pending = true;
+                ESP_LOGW(TAG, "HCO2T interval not set (%s)", esp_err_to_name(ret));
+            }
         }
 
-        // Ensure baud rate is 115200 for this sensor
-        uart_set_baudrate(UART_NUM_2, 115200);
-
-        // Read available bytes (short timeout so we don't block too long)
-        uint8_t buf[128];
-        int read = uart_mux_read_sensor(buf, sizeof(buf), 200);
-        if (read > 0) {
-            for (int i = 0; i < read; ++i) {
-                char c = (char)buf[i];
-                if (c == '\r') continue; // ignore CR
-                if (c == '\n' || line_pos >= (sizeof(line_buf)-1)) {
-                    // terminate and parse
-                    line_buf[line_pos] = '\0';
-                    if (line_pos > 0) {
-                        // Expected format: CO2,Temp_tenths,Hum_tenths,Light
-                        uint32_t co2 = 0;
-                        int32_t t_tenths = 0;
-                        int32_t h_tenths = 0;
-                        int32_t light = 0;
-
-                        int parsed = sscanf(line_buf, "%" SCNu32 ",%" SCNd32 ",%" SCNd32 ",%" SCNd32, &co2, &t_tenths, &h_tenths, &light);
-                        if (parsed >= 3) {
-                            htco2_data.co2 = co2;
-                            htco2_data.t_tenths = t_tenths;
-                            htco2_data.h_tenths = h_tenths;
-                            htco2_data.light = light;
-                            ESP_LOGD(TAG, "Parsed HCO2T: CO2=%" PRIu32 " ppm, T=%.1f°C, RH=%.1f%%, light=%" PRId32, co2, ((float)t_tenths) / 10.0f, ((float)h_tenths) / 10.0f, light);
-                            
-                        } else {
-                            ESP_LOGW(TAG, "Failed to parse HCO2T line: '%s' (parsed=%d)", line_buf, parsed);
-                        }
-                    }
-                    // reset buffer
-                    line_pos = 0;
-                } else {
-                    line_buf[line_pos++] = c;
-                }
-            }
-        } else if (read == -1) {
-            ESP_LOGW(TAG, "uart_mux_read_sensor timeout or error");
+        htco2_measurement_t meas;
+        esp_err_t ret = htco2_request(HTCO2_CMD_MEASURE_NOW, 0, &meas, NULL);
+        if (ret != ESP_OK) {
+            // Corrupted answer: ask for the same reading again (no new sensor access)
+            ret = htco2_request(HTCO2_CMD_SEND_LAST, 0, &meas, NULL);
         }
 
-        // Wait 5 seconds between polls
-        vTaskDelay(pdMS_TO_TICKS(5000));
+        if (ret == ESP_OK) {
+            store_measurement(&meas);
+        } else {
+            missed_responses++;
+            interval_pending = true;    // The node may have been reset to its default interval
+            ESP_LOGW(TAG, "No answer from HCO2T sensor (%s, %" PRIu32 " missed)", esp_err_to_name(ret), missed_responses);
+        }
+
+        // Woken early by htco2_sensor_set_interval()
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(interval_s * 1000UL));
     }
 }
 
@@ -87,6 +118,18 @@ esp_err_t htco2_sensor_manager_init(void) {
     return ESP_OK;
 }
 
+esp_err_t htco2_sensor_set_interval(uint16_t seconds) {
+    if (seconds < HTCO2_INTERVAL_MIN_S) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    interval_s = seconds;
+    interval_pending = true;
+    if (htco2_task_handle) {
+        xTaskNotifyGive(htco2_task_handle);
+    }
+    return ESP_OK;
+}
+
 esp_err_t htco2_sensor_manager_deinit(void) {
     if (htco2_task_handle) {
         vTaskDelete(htco2_task_handle);
@@ -10,8 +10,13 @@
 
 #include "../communications/protocol.h"
 #include "../communications/uart/uart_multiplexer.h"
+#include "htco2_protocol.h"
 #include "../common_includes/gpio_pinout.h"
 
+#define HTCO2_DEFAULT_INTERVAL_S    30      // SCD41 low power periodic mode
+#define HTCO2_RESPONSE_TIMEOUT_MS   50
+#define HTCO2_ACQUIRE_TIMEOUT_MS    2000    // Wait for UART2 (heater frame in progress)
+
 typedef struct{
     uint32_t co2;
     int32_t t_tenths;
@@ -22,11 +27,23 @@ typedef struct{
 /**
  * @brief Initialize HCO2T sensor manager.
  *
- * Starts a background task that periodically (every 5s) reads the HCO2T sensor
- * via the UART multiplexer and updates `protocol` van state sensor fields.
+ * Starts a background task that polls the HCO2T sensor once per measurement
+ * interval: a short request and its binary answer (see htco2_protocol.h) in a
+ * single short hold of UART2, then updates `protocol` van state sensor fields.
  */
 esp_err_t htco2_sensor_manager_init(void);
 
+/**
+ * @brief Set the measurement interval of the sensor node
+ *
+ * The node picks the SCD41 mode from it (periodic below 30 s, low power
+ * periodic below 60 s, single shot above) and sleeps in between. Sent by the
+ * manager task, which then polls at the same interval.
+ * @param seconds Interval, at least HTCO2_INTERVAL_MIN_S
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if too short
+ */
+esp_err_t htco2_sensor_set_interval(uint16_t seconds);
+
 /**
  * @brief Deinitialize HCO2T sensor manager.
  */
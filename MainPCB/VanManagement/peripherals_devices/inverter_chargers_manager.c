@@ -64,24 +64,6 @@ static float random_float(float min, float max) {
     return min + ((float)rand() / (float)RAND_MAX) * (max - min);
 }
 
-/**
- * @brief Simulate AC mains availability (random but persistent for periods)
- */
-static bool simulate_ac_mains_available(uint32_t time) {
-    // AC available in blocks of ~5 minutes (20% probability)
-    uint32_t block = time / 300; // 5-minute blocks
-    return (block % 5) == 0; // Available 1 out of 5 blocks
-}
-
-/**
- * @brief Simulate engine running (alternator available)
- */
-static bool simulate_engine_running(uint32_t time) {
-    // Engine runs in blocks of ~3 minutes (15% probability)
-    uint32_t block = time / 180; // 3-minute blocks
-    return (block % 7) == 0; // Running 1 out of 7 blocks
-}
-
 /**
  * @brief Calculate battery charge state based on voltage
  */
@@ -2,24 +2,59 @@
 #include "led_manager.h"
 #include "led_static_modes.h"
 #include "led_dynamic_modes.h"
+#include "led_metrics.h"
+#include "led_scenes.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
 #include <string.h>
 
 static const char *TAG = "LED_CMD_HANDLER";
 
-// Task handles for custom dynamic animations
-static TaskHandle_t custom_animation_tasks[LED_STRIP_COUNT] = {NULL};
+// Frame period of custom animations (30 FPS)
+#define CUSTOM_ANIMATION_FRAME_MS 33
 
-// Structure to hold custom animation parameters
+// Largest strip a custom animation can drive (roof strips only)
+#define CUSTOM_ANIMATION_MAX_LEDS \
+    (LED_STRIP_1_COUNT > LED_STRIP_2_COUNT ? LED_STRIP_1_COUNT : LED_STRIP_2_COUNT)
+
+// A timeline plays one dynamic command on every strip of its target from a single
+// clock, so ROOF_LED_ALL animations stay frame-locked on both halves of the ceiling.
 typedef struct {
-    led_strip_t strip;
+    led_strip_t strips[2];
+    int strip_count;
     led_dynamic_command_t* dynamic_cmd;
+    volatile uint16_t keyframe_count;   // Keyframes ready to be played (grows while streaming)
+    volatile bool streaming;            // Keyframes are still being uploaded
+    volatile uint32_t strip_mask;       // Strips still driven by this timeline
     volatile bool stop_requested;
-} custom_animation_task_t;
+    TaskHandle_t task;
+} custom_animation_timeline_t;
+
+static custom_animation_timeline_t custom_animation_timelines[LED_STRIP_COUNT];
+
+// Timeline currently driving each strip (NULL if none)
+static custom_animation_timeline_t* strip_timelines[LED_STRIP_COUNT] = {NULL};
+
+// Timeline receiving a progressive upload (NULL if none)
+static custom_animation_timeline_t* stream_timeline = NULL;
 
-static custom_animation_task_t custom_animation_params[LED_STRIP_COUNT];
+// Protects the ownership of a streaming timeline's command buffer
+static portMUX_TYPE timeline_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Last static colors written to each strip (source of scene snapshots)
+static led_roof1_strip_colors_t static_roof1_colors;
+static led_roof2_strip_colors_t static_roof2_colors;
+static led_ext_av_strip_colors_t static_ext_av_colors;
+static led_ext_ar_strip_colors_t static_ext_ar_colors;
+static led_data_t* const static_colors[LED_STRIP_COUNT] = {
+    static_roof1_colors.color,
+    static_roof2_colors.color,
+    static_ext_av_colors.color,
+    static_ext_ar_colors.color,
+};
+static bool static_colors_valid[LED_STRIP_COUNT] = {false};
 
 // Helper function to convert led_strip_static_target_t to led_strip_t enum(s)
 static void map_static_target_to_strips(led_strip_static_target_t target, 
@@ -96,17 +131,17 @@ static void map_dynamic_target_to_strips(led_strip_dynamic_target_t target,
 }
 
 // Helper function to apply a single LED color to a specific LED in a strip
-static void apply_led_color(led_strip_handle_t handle, int led_index, const led_data_t* color) {
-    if (!handle || !color) return;
+static void apply_led_color(led_strip_t strip, int led_index, const led_data_t* color) {
+    if (!color) return;
     
     // Scale RGBW by brightness
     float scale = color->brightness / 255.0f;
     
-    led_strip_set_pixel_rgbw(handle, led_index,
-                             (uint8_t)(color->r * scale),
-                             (uint8_t)(color->g * scale),
-                             (uint8_t)(color->b * scale),
-                             (uint8_t)(color->w * scale));
+    led_manager_set_pixel(strip, led_index,
+                          (uint8_t)(color->r * scale),
+                          (uint8_t)(color->g * scale),
+                          (uint8_t)(color->b * scale),
+                          (uint8_t)(color->w * scale));
 }
 
 // Helper function to interpolate between two colors
@@ -126,6 +161,28 @@ static float ease_in_out(float t) {
     return t < 0.5f ? 2.0f * t * t : -1.0f + (4.0f - 2.0f * t) * t;
 }
 
+// Detach a strip from the custom animation timeline driving it.
+// The timeline task is stopped (and waited for) once it has no strip left.
+static void stop_custom_animation(led_strip_t strip) {
+    custom_animation_timeline_t* timeline = strip_timelines[strip];
+    if (timeline == NULL) return;
+
+    strip_timelines[strip] = NULL;
+    timeline->strip_mask &= ~(1UL << strip);
+    if (timeline->strip_mask != 0) {
+        ESP_LOGI(TAG, "Strip %d detached from shared animation timeline", strip);
+        return;
+    }
+
+    timeline->stop_requested = true;
+    for (int i = 0; i < 10 && timeline->task != NULL; i++) {
+        vTaskDelay(pdMS_TO_TICKS(CUSTOM_ANIMATION_FRAME_MS));
+    }
+    if (timeline->task != NULL) {
+        ESP_LOGW(TAG, "Animation timeline for strip %d did not stop in time", strip);
+    }
+}
+
 // Apply static LED command
 static esp_err_t apply_static_command(const led_static_command_t* static_cmd) {
     if (!static_cmd) return ESP_ERR_INVALID_ARG;
@@ -141,146 +198,165 @@ static esp_err_t apply_static_command(const led_static_command_t* static_cmd) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Stop any running animations on these strips
+    // Pick the color array of each target strip
+    const led_data_t* colors[LED_STRIP_COUNT] = {NULL};
     for (int s = 0; s < strip_count; s++) {
-        led_dynamic_stop(strips[s]);
-        if (custom_animation_tasks[strips[s]] != NULL) {
-            custom_animation_params[strips[s]].stop_requested = true;
-            vTaskDelay(pdMS_TO_TICKS(50)); // Give task time to stop
+        switch (strips[s]) {
+            case LED_ROOF_STRIP_1: colors[LED_ROOF_STRIP_1] = static_cmd->colors.roof.roof1_colors.color; break;
+            case LED_ROOF_STRIP_2: colors[LED_ROOF_STRIP_2] = static_cmd->colors.roof.roof2_colors.color; break;
+            case LED_EXT_FRONT:    colors[LED_EXT_FRONT] = static_cmd->colors.ext.ext_av_colors.color; break;
+            case LED_EXT_BACK:     colors[LED_EXT_BACK] = static_cmd->colors.ext.ext_ar_colors.color; break;
+            default: break;
         }
     }
     
-    // Apply colors to each strip
-    for (int s = 0; s < strip_count; s++) {
-        led_strip_t strip = strips[s];
+    return led_apply_static_frame(colors);
+}
+
+esp_err_t led_apply_static_frame(const led_data_t* const colors[LED_STRIP_COUNT]) {
+    if (!colors) return ESP_ERR_INVALID_ARG;
+    
+    bool exterior = false;
+    int strip_count = 0;
+    
+    // Stop the animations and fill every pixel buffer before sending anything
+    for (int strip = 0; strip < LED_STRIP_COUNT; strip++) {
+        if (!colors[strip]) continue;
+        
         led_strip_handle_t handle = led_manager_get_handle(strip);
         int num_leds = led_manager_get_led_count(strip);
-        
         if (!handle || num_leds <= 0) {
             ESP_LOGE(TAG, "Invalid handle or LED count for strip %d", strip);
             continue;
         }
         
-        // Get the appropriate color array based on target
-        const led_data_t* colors = NULL;
-        int color_count = 0;
-        
-        // Determine which color array to use
-        if (static_cmd->strip_target == ROOF_LED1 || static_cmd->strip_target == ROOF_LED_ALL) {
-            if (strip == LED_ROOF_STRIP_1) {
-                colors = static_cmd->colors.roof.roof1_colors.color;
-                color_count = LED_STRIP_1_COUNT;
-            }
-        }
+        // Custom mode stops the built-in animations (rainbow, door)
+        led_set_mode(strip, LED_MODE_CUSTOM);
+        stop_custom_animation(strip);
         
-        if (static_cmd->strip_target == ROOF_LED2 || static_cmd->strip_target == ROOF_LED_ALL) {
-            if (strip == LED_ROOF_STRIP_2) {
-                colors = static_cmd->colors.roof.roof2_colors.color;
-                color_count = LED_STRIP_2_COUNT;
-            }
+        if (colors[strip] != static_colors[strip]) {
+            memcpy(static_colors[strip], colors[strip], num_leds * sizeof(led_data_t));
         }
+        static_colors_valid[strip] = true;
         
-        if (static_cmd->strip_target == EXT_AV_LED || static_cmd->strip_target == EXT_LED_ALL) {
-            if (strip == LED_EXT_FRONT) {
-                colors = static_cmd->colors.ext.ext_av_colors.color;
-                color_count = LED_STRIP_EXT_FRONT_COUNT;
-            }
-        }
-        
-        if (static_cmd->strip_target == EXT_AR_LED || static_cmd->strip_target == EXT_LED_ALL) {
-            if (strip == LED_EXT_BACK) {
-                colors = static_cmd->colors.ext.ext_ar_colors.color;
-                color_count = LED_STRIP_EXT_BACK_COUNT;
-            }
-        }
-        
-        if (!colors || color_count == 0) {
-            ESP_LOGE(TAG, "No color data for strip %d", strip);
-            continue;
+        for (int i = 0; i < num_leds; i++) {
+            apply_led_color(strip, i, &static_colors[strip][i]);
         }
         
-        // Apply each LED color
-        ESP_LOGI(TAG, "Applying %d colors to strip %d", color_count, strip);
-        for (int i = 0; i < num_leds && i < color_count; i++) {
-            apply_led_color(handle, i, &colors[i]);
+        if (strip == LED_EXT_FRONT || strip == LED_EXT_BACK) {
+            exterior = true;
         }
-        
-        // Refresh the strip to show the changes
-        esp_err_t ret = led_strip_refresh(handle);
+        strip_count++;
+    }
+    
+    if (strip_count == 0) {
+        ESP_LOGE(TAG, "No color data for static frame");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // Power the exterior strips before sending them the frame
+    if (exterior && !led_get_exterior_power()) {
+        led_set_exterior_power(true);
+    }
+    
+    // Refresh all strips back to back so they latch the same frame
+    for (int strip = 0; strip < LED_STRIP_COUNT; strip++) {
+        if (!colors[strip] || !static_colors_valid[strip] || !led_manager_get_handle(strip)) continue;
+        led_metrics_frame_start(strip, 0);
+        uint32_t stage_start = led_metrics_cycles();
+        esp_err_t ret = led_manager_refresh(strip);
+        led_metrics_stage_done(strip, LED_METRIC_REFRESH, stage_start);
+        led_metrics_frame_end(strip);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Failed to refresh strip %d: %s", strip, esp_err_to_name(ret));
-        } else {
-            ESP_LOGI(TAG, "Strip %d refreshed successfully", strip);
-        }
-        
-        // Enable exterior power if needed
-        if (strip == LED_EXT_FRONT || strip == LED_EXT_BACK) {
-            led_set_exterior_power(true);
         }
     }
     
+    ESP_LOGI(TAG, "Static frame applied to %d strip(s)", strip_count);
     return ESP_OK;
 }
 
-// Custom animation task for dynamic LED commands
+const led_data_t* led_get_static_colors(led_strip_t strip) {
+    if (strip >= LED_STRIP_COUNT || !static_colors_valid[strip]) return NULL;
+    return static_colors[strip];
+}
+
+void led_stop_animations(led_strip_t strip) {
+    if (strip >= LED_STRIP_COUNT) return;
+    led_dynamic_stop(strip);
+    stop_custom_animation(strip);
+}
+
+// Get the keyframe color array for one strip of a dynamic command
+static const led_data_t* get_keyframe_colors(const led_dynamic_command_t* cmd,
+                                             const led_keyframe_t* kf,
+                                             led_strip_t strip) {
+    switch (cmd->strip_target) {
+        case ROOF_LED1_DYNAMIC:
+            return (strip == LED_ROOF_STRIP_1) ? kf->colors.roof1.color : NULL;
+        case ROOF_LED2_DYNAMIC:
+            return (strip == LED_ROOF_STRIP_2) ? kf->colors.roof2.color : NULL;
+        case ROOF_LED_ALL_DYNAMIC:
+            if (strip == LED_ROOF_STRIP_1) return kf->colors.both.roof1.color;
+            if (strip == LED_ROOF_STRIP_2) return kf->colors.both.roof2.color;
+            return NULL;
+        default:
+            return NULL;
+    }
+}
+
+// Custom animation task: one per timeline, whatever the number of strips.
+// The keyframe lookup and the ratio are computed once per frame from the shared
+// clock, then every strip is rendered and all of them are refreshed together.
 static void custom_animation_task(void *param) {
-    custom_animation_task_t* task_params = (custom_animation_task_t*)param;
-    if (!task_params || !task_params->dynamic_cmd) {
+    custom_animation_timeline_t* timeline = (custom_animation_timeline_t*)param;
+    if (!timeline || !timeline->dynamic_cmd) {
         ESP_LOGE(TAG, "Invalid task parameters");
         vTaskDelete(NULL);
         return;
     }
     
-    led_strip_t strip = task_params->strip;
-    led_dynamic_command_t* cmd = task_params->dynamic_cmd;
-    
-    led_strip_handle_t handle = led_manager_get_handle(strip);
-    int num_leds = led_manager_get_led_count(strip);
+    led_dynamic_command_t* cmd = timeline->dynamic_cmd;
+    led_strip_handle_t handles[2] = {NULL};
+    int num_leds[2] = {0};
     
-    if (!handle || num_leds <= 0) {
-        ESP_LOGE(TAG, "Invalid handle or LED count for strip %d", strip);
-        vTaskDelete(NULL);
-        return;
+    for (int s = 0; s < timeline->strip_count; s++) {
+        handles[s] = led_manager_get_handle(timeline->strips[s]);
+        num_leds[s] = led_manager_get_led_count(timeline->strips[s]);
+        if (!handles[s] || num_leds[s] <= 0 || num_leds[s] > CUSTOM_ANIMATION_MAX_LEDS) {
+            ESP_LOGE(TAG, "Invalid handle or LED count for strip %d", timeline->strips[s]);
+            timeline->strip_mask &= ~(1UL << timeline->strips[s]);
+        }
     }
     
-    ESP_LOGI(TAG, "Starting custom animation on strip %d: %d keyframes, %dms duration, loop=%d",
-             strip, cmd->keyframe_count, cmd->loop_duration_ms, cmd->loop_behavior);
+    ESP_LOGI(TAG, "Starting custom animation on %d strip(s): %d/%d keyframes, %dms duration, loop=%d",
+             timeline->strip_count, timeline->keyframe_count, cmd->keyframe_count,
+             cmd->loop_duration_ms, cmd->loop_behavior);
     
-    // Debug: Print keyframe timestamps and first color values
-    // ESP_LOGI(TAG, "Keyframe timestamps for strip %d (target=%d):", strip, cmd->strip_target);
-    // for (int i = 0; i < cmd->keyframe_count; i++) {
-    //     led_keyframe_t* kf = &cmd->keyframes[i];
-    //     ESP_LOGI(TAG, "  KF[%d]: %dms, transition=%d", i, 
-    //              kf->timestamp_ms, kf->transition);
+    // Shared animation clock (microsecond resolution, independent of tick rounding)
+    int64_t animation_start_us = esp_timer_get_time();
+    TickType_t last_wake = xTaskGetTickCount();
+    
+    // Interpolated colors of the strip being rendered, before conversion
+    led_data_t frame[CUSTOM_ANIMATION_MAX_LEDS];
+    
+    while (!timeline->stop_requested && timeline->strip_mask != 0) {
+        for (int s = 0; s < timeline->strip_count; s++) {
+            led_metrics_frame_start(timeline->strips[s], CUSTOM_ANIMATION_FRAME_MS);
+        }
         
-    //     // Debug: Print first LED color from this keyframe
-    //     if (cmd->strip_target == ROOF_LED1_DYNAMIC && strip == LED_ROOF_STRIP_1) {
-    //         led_data_t* c = &kf->colors.roof1.color[0];
-    //         ESP_LOGI(TAG, "    First LED: R=%d G=%d B=%d W=%d Bright=%d", 
-    //                  c->r, c->g, c->b, c->w, c->brightness);
-    //     } else if (cmd->strip_target == ROOF_LED2_DYNAMIC && strip == LED_ROOF_STRIP_2) {
-    //         led_data_t* c = &kf->colors.roof2.color[0];
-    //         ESP_LOGI(TAG, "    First LED: R=%d G=%d B=%d W=%d Bright=%d", 
-    //                  c->r, c->g, c->b, c->w, c->brightness);
-    //     } else if (cmd->strip_target == ROOF_LED_ALL_DYNAMIC) {
-    //         if (strip == LED_ROOF_STRIP_1) {
-    //             led_data_t* c = &kf->colors.both.roof1.color[0];
-    //             ESP_LOGI(TAG, "    First LED (BOTH.ROOF1): R=%d G=%d B=%d W=%d Bright=%d", 
-    //                      c->r, c->g, c->b, c->w, c->brightness);
-    //         } else if (strip == LED_ROOF_STRIP_2) {
-    //             led_data_t* c = &kf->colors.both.roof2.color[0];
-    //             ESP_LOGI(TAG, "    First LED (BOTH.ROOF2): R=%d G=%d B=%d W=%d Bright=%d", 
-    //                      c->r, c->g, c->b, c->w, c->brightness);
-    //         }
-    //     }
-    // }
-    
-    uint32_t animation_start = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    bool forward = true;
-    
-    while (!task_params->stop_requested) {
-        uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-        uint32_t elapsed = current_time - animation_start;
+        int64_t now_us = esp_timer_get_time();
+        uint32_t elapsed = (uint32_t)((now_us - animation_start_us) / 1000);
+        uint16_t keyframe_count = timeline->keyframe_count;
+        
+        // While uploading, hold the clock on the last received keyframe until the next one arrives
+        if (timeline->streaming) {
+            uint32_t last_ready_ms = cmd->keyframes[keyframe_count - 1].timestamp_ms;
+            if (elapsed > last_ready_ms) {
+                elapsed = last_ready_ms;
+                animation_start_us = now_us - (int64_t)last_ready_ms * 1000;
+            }
+        }
         
         // Calculate position in animation based on loop behavior
         uint32_t position_in_loop = elapsed % cmd->loop_duration_ms;
@@ -297,27 +373,28 @@ static void custom_animation_task(void *param) {
             }
         }
         
-        // Find the two keyframes to interpolate between
+        // Find the last keyframe at or before the current position
         int keyframe_index = 0;
-        for (int i = 0; i < cmd->keyframe_count - 1; i++) {
-            if (position_in_loop >= cmd->keyframes[i].timestamp_ms &&
-                position_in_loop < cmd->keyframes[i + 1].timestamp_ms) {
+        for (int i = 0; i < keyframe_count; i++) {
+            if (position_in_loop >= cmd->keyframes[i].timestamp_ms) {
                 keyframe_index = i;
+            } else {
                 break;
             }
         }
         
-        // Get the two keyframes
+        // Get the two keyframes (the last one wraps to the first at the end of the loop)
         led_keyframe_t* kf1 = &cmd->keyframes[keyframe_index];
-        led_keyframe_t* kf2 = (keyframe_index < cmd->keyframe_count - 1) 
-                              ? &cmd->keyframes[keyframe_index + 1] 
-                              : &cmd->keyframes[0];
+        bool wraps = (keyframe_index == keyframe_count - 1);
+        led_keyframe_t* kf2 = wraps ? &cmd->keyframes[0] : &cmd->keyframes[keyframe_index + 1];
+        uint32_t kf2_time = wraps ? cmd->loop_duration_ms : kf2->timestamp_ms;
         
         // Calculate interpolation ratio
         float ratio = 0.0f;
-        if (kf2->timestamp_ms > kf1->timestamp_ms) {
+        if (kf2_time > kf1->timestamp_ms && position_in_loop > kf1->timestamp_ms) {
             ratio = (float)(position_in_loop - kf1->timestamp_ms) / 
-                    (float)(kf2->timestamp_ms - kf1->timestamp_ms);
+                    (float)(kf2_time - kf1->timestamp_ms);
+            if (ratio > 1.0f) ratio = 1.0f;
         }
         
         // Apply transition function
@@ -327,77 +404,171 @@ static void custom_animation_task(void *param) {
             ratio = 0.0f; // Stay at first keyframe
         }
         
-        // Get color arrays based on strip target
-        const led_data_t* colors1 = NULL;
-        const led_data_t* colors2 = NULL;
-        int expected_led_count = 0;
-        
-        if (cmd->strip_target == ROOF_LED1_DYNAMIC) {
-            if (strip == LED_ROOF_STRIP_1) {
-                colors1 = kf1->colors.roof1.color;
-                colors2 = kf2->colors.roof1.color;
-                expected_led_count = LED_STRIP_1_COUNT;
-                ESP_LOGD(TAG, "Using ROOF1 colors for strip %d", strip);
+        // Render every strip still attached to this timeline
+        for (int s = 0; s < timeline->strip_count; s++) {
+            led_strip_t strip = timeline->strips[s];
+            if (!(timeline->strip_mask & (1UL << strip))) continue;
+            
+            const led_data_t* colors1 = get_keyframe_colors(cmd, kf1, strip);
+            const led_data_t* colors2 = get_keyframe_colors(cmd, kf2, strip);
+            if (!colors1 || !colors2) {
+                ESP_LOGE(TAG, "No color data for animation (target=%d, strip=%d)", 
+                         cmd->strip_target, strip);
+                timeline->strip_mask &= ~(1UL << strip);
+                continue;
             }
-        } else if (cmd->strip_target == ROOF_LED2_DYNAMIC) {
-            if (strip == LED_ROOF_STRIP_2) {
-                colors1 = kf1->colors.roof2.color;
-                colors2 = kf2->colors.roof2.color;
-                expected_led_count = LED_STRIP_2_COUNT;
-                ESP_LOGD(TAG, "Using ROOF2 colors for strip %d", strip);
+            
+            // Interpolate all LEDs, then write them into the strip pixel buffer
+            uint32_t stage_start = led_metrics_cycles();
+            for (int i = 0; i < num_leds[s]; i++) {
+                interpolate_colors(&colors1[i], &colors2[i], ratio, &frame[i]);
             }
-        } else if (cmd->strip_target == ROOF_LED_ALL_DYNAMIC) {
-            if (strip == LED_ROOF_STRIP_1) {
-                colors1 = kf1->colors.both.roof1.color;
-                colors2 = kf2->colors.both.roof1.color;
-                expected_led_count = LED_STRIP_1_COUNT;
-                ESP_LOGD(TAG, "Using BOTH.ROOF1 colors for strip %d", strip);
-            } else if (strip == LED_ROOF_STRIP_2) {
-                colors1 = kf1->colors.both.roof2.color;
-                colors2 = kf2->colors.both.roof2.color;
-                expected_led_count = LED_STRIP_2_COUNT;
-                ESP_LOGD(TAG, "Using BOTH.ROOF2 colors for strip %d", strip);
+            led_metrics_stage_done(strip, LED_METRIC_RENDER, stage_start);
+            
+            stage_start = led_metrics_cycles();
+            for (int i = 0; i < num_leds[s]; i++) {
+                apply_led_color(strip, i, &frame[i]);
             }
+            led_metrics_stage_done(strip, LED_METRIC_CONVERT, stage_start);
         }
         
-        if (!colors1 || !colors2) {
-            ESP_LOGE(TAG, "No color data for animation (target=%d, strip=%d)", 
-                     cmd->strip_target, strip);
-            ESP_LOGE(TAG, "kf1=%p, kf2=%p, colors1=%p, colors2=%p", 
-                     kf1, kf2, colors1, colors2);
-            break;
-        }
-        
-        ESP_LOGD(TAG, "Animation frame: keyframe %d->%d, ratio=%.2f, leds=%d", 
-                 keyframe_index, keyframe_index + 1, ratio, num_leds);
-        
-        // Interpolate and apply colors to all LEDs
-        for (int i = 0; i < num_leds; i++) {
-            led_data_t interpolated;
-            interpolate_colors(&colors1[i], &colors2[i], ratio, &interpolated);
-            apply_led_color(handle, i, &interpolated);
+        // Refresh all strips back to back so they latch the same frame
+        for (int s = 0; s < timeline->strip_count; s++) {
+            led_strip_t strip = timeline->strips[s];
+            if (timeline->strip_mask & (1UL << strip)) {
+                uint32_t stage_start = led_metrics_cycles();
+                led_manager_refresh(strip);
+                led_metrics_stage_done(strip, LED_METRIC_REFRESH, stage_start);
+                led_metrics_frame_end(strip);
+            }
         }
         
-        // Refresh the strip
-        led_strip_refresh(handle);
-        
-        // Control frame rate (30 FPS = 33ms per frame)
-        vTaskDelay(pdMS_TO_TICKS(33));
+        // Fixed frame rate without cumulative drift
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(CUSTOM_ANIMATION_FRAME_MS));
     }
     
-    ESP_LOGI(TAG, "Custom animation stopped on strip %d", strip);
+    ESP_LOGI(TAG, "Custom animation timeline stopped");
     
-    // Clean up - free the command copy for this strip
-    if (task_params->dynamic_cmd != NULL) {
-        ESP_LOGI(TAG, "Freeing command copy for strip %d", strip);
-        free(task_params->dynamic_cmd);
-        task_params->dynamic_cmd = NULL;
+    // Release strips still pointing to this timeline (animation finished by itself)
+    for (int s = 0; s < timeline->strip_count; s++) {
+        if (strip_timelines[timeline->strips[s]] == timeline) {
+            strip_timelines[timeline->strips[s]] = NULL;
+        }
     }
+    timeline->strip_mask = 0;
+    
+    // Clean up - free the command copy shared by all strips, unless the upload
+    // is still writing into it (the stream owner frees it when it ends)
+    led_dynamic_command_t* to_free = NULL;
+    portENTER_CRITICAL(&timeline_lock);
+    if (!timeline->streaming) {
+        to_free = timeline->dynamic_cmd;
+        timeline->dynamic_cmd = NULL;
+    }
+    timeline->task = NULL;
+    portEXIT_CRITICAL(&timeline_lock);
+    free(to_free);
     
-    custom_animation_tasks[strip] = NULL;
     vTaskDelete(NULL);
 }
 
+// Stop the target strips and prepare a free timeline holding an empty copy of the
+// command header with room for all of its keyframes (keyframe_count starts at 0)
+static custom_animation_timeline_t* setup_timeline(const led_dynamic_command_t* header,
+                                                   const led_strip_t* strips,
+                                                   int strip_count) {
+    // Stop any existing animation on these strips
+    for (int s = 0; s < strip_count; s++) {
+        led_dynamic_stop(strips[s]);
+        stop_custom_animation(strips[s]);
+        static_colors_valid[strips[s]] = false;
+    }
+    
+    // Find a free timeline slot
+    custom_animation_timeline_t* timeline = NULL;
+    for (int i = 0; i < LED_STRIP_COUNT; i++) {
+        if (custom_animation_timelines[i].task == NULL &&
+            custom_animation_timelines[i].dynamic_cmd == NULL) {
+            timeline = &custom_animation_timelines[i];
+            break;
+        }
+    }
+    if (!timeline) {
+        ESP_LOGE(TAG, "No free animation timeline");
+        return NULL;
+    }
+    
+    size_t total_size = sizeof(led_dynamic_command_t) + 
+                        header->keyframe_count * sizeof(led_keyframe_t);
+    
+    ESP_LOGI(TAG, "Allocating %d bytes for command copy (%d keyframes, %d strips)",
+             total_size, header->keyframe_count, strip_count);
+    
+    led_dynamic_command_t* cmd_copy = (led_dynamic_command_t*)malloc(total_size);
+    if (!cmd_copy) {
+        ESP_LOGE(TAG, "Failed to allocate memory for command copy");
+        return NULL;
+    }
+    memcpy(cmd_copy, header, sizeof(led_dynamic_command_t));
+    
+    // Setup the timeline
+    timeline->strip_count = strip_count;
+    timeline->strip_mask = 0;
+    for (int s = 0; s < strip_count; s++) {
+        timeline->strips[s] = strips[s];
+        timeline->strip_mask |= (1UL << strips[s]);
+        strip_timelines[strips[s]] = timeline;
+    }
+    timeline->dynamic_cmd = cmd_copy;
+    timeline->keyframe_count = 0;
+    timeline->streaming = false;
+    timeline->stop_requested = false;
+    
+    return timeline;
+}
+
+// Release a timeline whose task is not running
+static void release_timeline(custom_animation_timeline_t* timeline) {
+    for (int s = 0; s < timeline->strip_count; s++) {
+        if (strip_timelines[timeline->strips[s]] == timeline) {
+            strip_timelines[timeline->strips[s]] = NULL;
+        }
+    }
+    free(timeline->dynamic_cmd);
+    timeline->dynamic_cmd = NULL;
+    timeline->strip_mask = 0;
+    timeline->streaming = false;
+}
+
+// Start the animation task of a prepared timeline
+static esp_err_t start_timeline(custom_animation_timeline_t* timeline) {
+    // Create the animation task with high priority
+    char task_name[32];
+    snprintf(task_name, sizeof(task_name), "led_anim_%d", timeline->strips[0]);
+    
+    BaseType_t res = xTaskCreatePinnedToCore(
+        custom_animation_task,
+        task_name,
+        8192, // Larger stack for animation calculations
+        timeline,
+        6, // High priority (same as LED manager)
+        &timeline->task,
+        0  // CPU0 (same as LED manager)
+    );
+    
+    if (res != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create animation task for target %d", timeline->dynamic_cmd->strip_target);
+        timeline->task = NULL;
+        if (!timeline->streaming) {
+            release_timeline(timeline);
+        }
+        return ESP_FAIL;
+    }
+    
+    ESP_LOGI(TAG, "Animation timeline created for %d strip(s)", timeline->strip_count);
+    return ESP_OK;
+}
+
 // Apply dynamic LED command
 static esp_err_t apply_dynamic_command(led_dynamic_command_t* dynamic_cmd) {
     if (!dynamic_cmd) return ESP_ERR_INVALID_ARG;
@@ -420,76 +591,16 @@ static esp_err_t apply_dynamic_command(led_dynamic_command_t* dynamic_cmd) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Calculate size needed for a copy of the dynamic command (including keyframes)
-    size_t total_size = sizeof(led_dynamic_command_t) + 
-                        dynamic_cmd->keyframe_count * sizeof(led_keyframe_t);
-    
-    ESP_LOGI(TAG, "Allocating %d bytes per strip for command copy (%d keyframes)",
-             total_size, dynamic_cmd->keyframe_count);
-    
-    // Create animation task for each strip (each gets its own copy)
-    for (int s = 0; s < strip_count; s++) {
-        led_strip_t strip = strips[s];
-        
-        // Stop any existing animation on this strip
-        led_dynamic_stop(strip);
-        if (custom_animation_tasks[strip] != NULL) {
-            custom_animation_params[strip].stop_requested = true;
-            vTaskDelay(pdMS_TO_TICKS(100)); // Wait for task to stop
-            
-            // Free the old command copy if it exists
-            if (custom_animation_params[strip].dynamic_cmd != NULL) {
-                free(custom_animation_params[strip].dynamic_cmd);
-                custom_animation_params[strip].dynamic_cmd = NULL;
-            }
-        }
-        
-        // Create a persistent copy of the command for this strip's animation task
-        led_dynamic_command_t* cmd_copy = (led_dynamic_command_t*)malloc(total_size);
-        if (!cmd_copy) {
-            ESP_LOGE(TAG, "Failed to allocate memory for command copy (strip %d)", strip);
-            // Clean up any previous allocations
-            for (int i = 0; i < s; i++) {
-                if (custom_animation_params[strips[i]].dynamic_cmd != NULL) {
-                    free(custom_animation_params[strips[i]].dynamic_cmd);
-                    custom_animation_params[strips[i]].dynamic_cmd = NULL;
-                }
-            }
-            return ESP_ERR_NO_MEM;
-        }
-        
-        // Copy the entire structure including keyframes
-        memcpy(cmd_copy, dynamic_cmd, total_size);
-        ESP_LOGI(TAG, "Command copied successfully for strip %d", strip);
-        
-        // Setup task parameters with the persistent copy
-        custom_animation_params[strip].strip = strip;
-        custom_animation_params[strip].dynamic_cmd = cmd_copy;
-        custom_animation_params[strip].stop_requested = false;
-        
-        // Create the animation task with high priority
-        char task_name[32];
-        snprintf(task_name, sizeof(task_name), "led_anim_%d", strip);
-        
-        BaseType_t res = xTaskCreatePinnedToCore(
-            custom_animation_task,
-            task_name,
-            8192, // Larger stack for animation calculations
-            &custom_animation_params[strip],
-            6, // High priority (same as LED manager)
-            &custom_animation_tasks[strip],
-            0  // CPU0 (same as LED manager)
-        );
-        
-        if (res != pdPASS) {
-            ESP_LOGE(TAG, "Failed to create animation task for strip %d", strip);
-            return ESP_FAIL;
-        }
-        
-        ESP_LOGI(TAG, "Animation task created for strip %d", strip);
+    // Single persistent copy of the command (including keyframes) for the whole timeline
+    custom_animation_timeline_t* timeline = setup_timeline(dynamic_cmd, strips, strip_count);
+    if (!timeline) {
+        return ESP_ERR_NO_MEM;
     }
+    memcpy(timeline->dynamic_cmd->keyframes, dynamic_cmd->keyframes,
+           dynamic_cmd->keyframe_count * sizeof(led_keyframe_t));
+    timeline->keyframe_count = dynamic_cmd->keyframe_count;
     
-    return ESP_OK;
+    return start_timeline(timeline);
 }
 
 // Main function to apply LED commands
@@ -507,7 +618,8 @@ esp_err_t led_apply_command(const van_command_t* cmd) {
     const led_command_t* led_cmd = &cmd->command.led_cmd;
     
     ESP_LOGI(TAG, "📡 Applying LED command: type=%s", 
-             led_cmd->led_type == LED_STATIC ? "STATIC" : "DYNAMIC");
+             led_cmd->led_type == LED_STATIC ? "STATIC" :
+             led_cmd->led_type == LED_DYNAMIC ? "DYNAMIC" : "SCENE");
     
     esp_err_t ret = ESP_OK;
     
@@ -515,6 +627,8 @@ esp_err_t led_apply_command(const van_command_t* cmd) {
         ret = apply_static_command(&led_cmd->command.static_cmd);
     } else if (led_cmd->led_type == LED_DYNAMIC) {
         ret = apply_dynamic_command(led_cmd->command.dynamic_cmd);
+    } else if (led_cmd->led_type == LED_SCENE) {
+        ret = led_scene_apply_command(&led_cmd->command.scene_cmd);
     } else {
         ESP_LOGE(TAG, "Unknown LED type: %d", led_cmd->led_type);
         ret = ESP_ERR_INVALID_ARG;
@@ -528,3 +642,109 @@ esp_err_t led_apply_command(const van_command_t* cmd) {
     
     return ret;
 }
+
+// ============================================================================
+// PROGRESSIVE UPLOAD (STREAMING)
+// ============================================================================
+
+// True once the streaming timeline's task has been started
+static bool stream_playback_started = false;
+
+led_dynamic_command_t* led_stream_begin(const led_dynamic_command_t* header) {
+    if (!header) return NULL;
+    
+    // Only one upload at a time
+    if (stream_timeline != NULL) {
+        ESP_LOGW(TAG, "New animation upload, aborting the previous one");
+        led_stream_end(false);
+    }
+    
+    led_strip_t strips[2];
+    int strip_count;
+    map_dynamic_target_to_strips(header->strip_target, strips, &strip_count);
+    
+    if (strip_count == 0 || header->keyframe_count < 2 || header->loop_duration_ms == 0) {
+        ESP_LOGE(TAG, "Invalid streamed animation header (target=%d, keyframes=%d, duration=%dms)",
+                 header->strip_target, header->keyframe_count, header->loop_duration_ms);
+        return NULL;
+    }
+    
+    custom_animation_timeline_t* timeline = setup_timeline(header, strips, strip_count);
+    if (!timeline) return NULL;
+    
+    timeline->streaming = true;
+    stream_timeline = timeline;
+    stream_playback_started = false;
+    
+    ESP_LOGI(TAG, "Animation upload started: target=%d, %d keyframes expected",
+             header->strip_target, header->keyframe_count);
+    return timeline->dynamic_cmd;
+}
+
+esp_err_t led_stream_commit(uint16_t keyframes_ready) {
+    custom_animation_timeline_t* timeline = stream_timeline;
+    if (!timeline) return ESP_ERR_INVALID_STATE;
+    
+    if (timeline->stop_requested) {
+        ESP_LOGW(TAG, "Streamed animation was replaced before the end of its upload");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    const led_dynamic_command_t* cmd = timeline->dynamic_cmd;
+    if (keyframes_ready > cmd->keyframe_count || keyframes_ready < timeline->keyframe_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (keyframes_ready == timeline->keyframe_count) {
+        return ESP_OK;
+    }
+    
+    // Keyframe data must be visible to the animation task (other core) before the count
+    __sync_synchronize();
+    timeline->keyframe_count = keyframes_ready;
+    
+    // Start playback as soon as the first two keyframes cover t=0
+    if (!stream_playback_started && keyframes_ready >= 2 && cmd->keyframes[0].timestamp_ms == 0) {
+        ESP_LOGI(TAG, "Starting streamed animation after %d/%d keyframes",
+                 keyframes_ready, cmd->keyframe_count);
+        stream_playback_started = true;
+        return start_timeline(timeline);
+    }
+    
+    return ESP_OK;
+}
+
+void led_stream_end(bool complete) {
+    custom_animation_timeline_t* timeline = stream_timeline;
+    if (!timeline) return;
+    stream_timeline = NULL;
+    
+    complete = complete && !timeline->stop_requested &&
+               timeline->keyframe_count == timeline->dynamic_cmd->keyframe_count;
+    
+    // Hand the command buffer over to the animation task if it is running
+    portENTER_CRITICAL(&timeline_lock);
+    timeline->streaming = false;
+    bool task_running = (timeline->task != NULL);
+    portEXIT_CRITICAL(&timeline_lock);
+    
+    if (complete) {
+        ESP_LOGI(TAG, "Animation upload complete (%d keyframes)", timeline->keyframe_count);
+        if (!stream_playback_started) {
+            // First keyframe not at t=0: play once everything is there
+            stream_playback_started = true;
+            start_timeline(timeline);
+        } else if (!task_running) {
+            release_timeline(timeline);
+        }
+        return;
+    }
+    
+    ESP_LOGW(TAG, "Animation upload aborted after %d/%d keyframes",
+             timeline->keyframe_count, timeline->dynamic_cmd->keyframe_count);
+    if (task_running) {
+        // The task releases the strips and frees the buffer when it exits
+        timeline->stop_requested = true;
+    } else {
+        release_timeline(timeline);
+    }
+}
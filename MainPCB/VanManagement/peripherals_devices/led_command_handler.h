@@ -3,6 +3,7 @@
 
 #include "esp_err.h"
 #include "../communications/protocol.h"
+#include "led_manager.h"
 
 /**
  * @brief Apply LED command received from BLE app
@@ -15,4 +16,66 @@
  */
 esp_err_t led_apply_command(const van_command_t* cmd);
 
+/**
+ * @brief Show static colors on several strips as one frame
+ * 
+ * Stops the animations of the given strips, switches them to LED_MODE_CUSTOM,
+ * fills all their pixel buffers, then refreshes them back to back. Exterior
+ * power is switched on if an exterior strip is part of the frame.
+ * 
+ * @param colors One color array per strip (led_manager_get_led_count() entries),
+ *               NULL to leave the strip untouched
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if no strip was given
+ */
+esp_err_t led_apply_static_frame(const led_data_t* const colors[LED_STRIP_COUNT]);
+
+/**
+ * @brief Get the static colors currently shown on a strip
+ * 
+ * @return Last colors applied by led_apply_static_frame(), NULL if an animation
+ *         has taken over the strip since
+ */
+const led_data_t* led_get_static_colors(led_strip_t strip);
+
+/**
+ * @brief Stop the built-in and custom animations running on a strip
+ */
+void led_stop_animations(led_strip_t strip);
+
+/**
+ * @brief Start a progressive upload of a dynamic LED command
+ * 
+ * Stops the animations on the target strips and allocates the animation
+ * timeline. The caller then writes keyframes in place into the returned
+ * command and publishes them with led_stream_commit(). Starting a new upload
+ * aborts the previous one.
+ * 
+ * @param header Command header (strip_target, loop_duration_ms, keyframe_count,
+ *               loop_behavior); its keyframes are ignored
+ * @return Command buffer with room for header->keyframe_count keyframes, NULL on error
+ */
+led_dynamic_command_t* led_stream_begin(const led_dynamic_command_t* header);
+
+/**
+ * @brief Publish keyframes written into the streamed command
+ * 
+ * Playback starts as soon as the first two keyframes are ready and the first
+ * one is at t=0. Until the upload ends, the animation holds on the last ready
+ * keyframe instead of running past it.
+ * 
+ * @param keyframes_ready Number of fully written keyframes (validated by the caller)
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no upload is running or it
+ *         was replaced by another LED command (the caller must then stop writing
+ *         and call led_stream_end(false))
+ */
+esp_err_t led_stream_commit(uint16_t keyframes_ready);
+
+/**
+ * @brief End the progressive upload
+ * 
+ * @param complete True if every keyframe was received, false to abort the
+ *                 upload and stop its animation
+ */
+void led_stream_end(bool complete);
+
 #endif // LED_COMMAND_HANDLER_H
@@ -1,5 +1,6 @@
 #include "../main/global_coordinator.h"
 #include "led_manager.h"
+#include "led_scenes.h"
 #include "esp_log.h"
 
 static const char *TAG = "LED_COORD";
@@ -16,6 +17,9 @@ static void update_strips_state(void)
 
 static bool exterior_lights_on = false;
 
+// Clicks 7 and more recall the scene presets (7 → slot 0, 8 → slot 1, ...)
+#define SCENE_FIRST_CLICK 7
+
 // Map click_count → led_mode_type_t
 static led_mode_type_t map_click_to_mode(int click_count)
 {
@@ -35,6 +39,17 @@ static led_mode_type_t map_click_to_mode(int click_count)
 static void led_short_click_cb(gc_event_t evt)
 {
     ESP_LOGI(TAG, "LED coordinator received short click: %d", evt.value);
+
+    if (evt.value >= SCENE_FIRST_CLICK) {
+        int slot = evt.value - SCENE_FIRST_CLICK;
+        if (slot < LED_SCENE_SLOT_COUNT && led_scene_recall(slot) == ESP_OK) {
+            exterior_lights_on = led_get_exterior_power();
+            update_strips_state();
+            led_set_door_animation_active(false);
+        }
+        return;
+    }
+
     led_mode_type_t mode = map_click_to_mode(evt.value);
     
     // Gestion spéciale du mode 4 (intérieur + extérieur)
@@ -1,5 +1,6 @@
 #include "led_dynamic_modes.h"
 #include "led_manager.h"
+#include "led_metrics.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -66,15 +67,23 @@ static void rainbow_animation_task(void *param)
 
     while (1)
     {
+        led_metrics_frame_start(rt->strip, 50);
+
+        // Color computation and pixel write are interleaved: timed as render
+        uint32_t stage_start = led_metrics_cycles();
         for (int i = 0; i < num_leds; i++)
         {
             uint8_t wheel_pos = (i * 256 / num_leds + rt->offset) & 0xFF;
             uint8_t r, g, b;
             color_wheel(wheel_pos, rt->brightness, &r, &g, &b);
-            led_strip_set_pixel_rgbw(handle, i, r, g, b, 0);
+            led_manager_set_pixel(rt->strip, i, r, g, b, 0);
         }
+        led_metrics_stage_done(rt->strip, LED_METRIC_RENDER, stage_start);
 
-        led_strip_refresh(handle);
+        stage_start = led_metrics_cycles();
+        led_manager_refresh(rt->strip);
+        led_metrics_stage_done(rt->strip, LED_METRIC_REFRESH, stage_start);
+        led_metrics_frame_end(rt->strip);
         rt->offset = (rt->offset + 1) % 256;
         vTaskDelay(pdMS_TO_TICKS(50));  // ~20 FPS
         if (rt->stop_requested) {
@@ -138,6 +147,8 @@ static void door_open_animation_task(void *param)
         // Intro: wake up wave simulating sunrise, gradient from sunrise to white over 20 LEDs with brightness variation
         for (int pos = num_leds - 1; pos >= 0; pos--)
         {
+            led_metrics_frame_start(dt->strip, delay_per_step);
+            uint32_t stage_start = led_metrics_cycles();
             for (int i = 0; i < num_leds; i++)
             {
                 if (i >= pos - 19 && i <= pos)
@@ -156,16 +167,20 @@ static void door_open_animation_task(void *param)
                     uint8_t g = (uint8_t)(g_base * local_bright / 255);
                     uint8_t b = (uint8_t)(b_base * local_bright / 255);
                     uint8_t w = (uint8_t)(w_base * local_bright / 255);
-                    led_strip_set_pixel_rgbw(handle, i, r, g, b, w);
+                    led_manager_set_pixel(dt->strip, i, r, g, b, w);
                 }
                 else if (i > pos)
                 {
                     // Ahead: set to white
-                    led_strip_set_pixel_rgbw(handle, i, white_r, white_g, white_b, (uint8_t)(white_w * dt->brightness / 255));
+                    led_manager_set_pixel(dt->strip, i, white_r, white_g, white_b, (uint8_t)(white_w * dt->brightness / 255));
                 }
                 // Behind: keep as is
             }
-            if (handle) led_strip_refresh(handle);
+            led_metrics_stage_done(dt->strip, LED_METRIC_RENDER, stage_start);
+            stage_start = led_metrics_cycles();
+            led_manager_refresh(dt->strip);
+            led_metrics_stage_done(dt->strip, LED_METRIC_REFRESH, stage_start);
+            led_metrics_frame_end(dt->strip);
             vTaskDelay(pdMS_TO_TICKS(delay_per_step));
             if (dt->stop_requested) {
                 animation_tasks[dt->strip] = NULL;
@@ -180,9 +195,9 @@ static void door_open_animation_task(void *param)
         // Ensure all LEDs are white before starting outro
         for (int i = 0; i < num_leds; i++)
         {
-            led_strip_set_pixel_rgbw(handle, i, white_r, white_g, white_b, white_w);
+            led_manager_set_pixel(dt->strip, i, white_r, white_g, white_b, white_w);
         }
-        if (handle) led_strip_refresh(handle);
+        led_manager_refresh(dt->strip);
 
         int total_time_ms = 60000; // Total time for outro is 1 min
         int delay_per_step = total_time_ms / num_leds;
@@ -191,6 +206,8 @@ static void door_open_animation_task(void *param)
         // Outro: wave from front (pos=0) to back (pos=19), turning off with white to sunset gradient
         for (int pos = 0; pos < num_leds; pos++)
         {
+            led_metrics_frame_start(dt->strip, delay_per_step);
+            uint32_t stage_start = led_metrics_cycles();
             for (int i = 0; i < num_leds; i++)
             {
                 if (i >= pos && i <= pos + 19)
@@ -209,16 +226,20 @@ static void door_open_animation_task(void *param)
                     uint8_t g = (uint8_t)(g_base * local_bright / 255);
                     uint8_t b = (uint8_t)(b_base * local_bright / 255);
                     uint8_t w = (uint8_t)(w_base * local_bright / 255);
-                    led_strip_set_pixel_rgbw(handle, i, r, g, b, w);
+                    led_manager_set_pixel(dt->strip, i, r, g, b, w);
                 }
                 else if (i < pos)
                 {
                     // Behind: off
-                    led_strip_set_pixel_rgbw(handle, i, 0, 0, 0, 0);
+                    led_manager_set_pixel(dt->strip, i, 0, 0, 0, 0);
                 }
                 // Ahead: keep white
             }
-            if (handle) led_strip_refresh(handle);
+            led_metrics_stage_done(dt->strip, LED_METRIC_RENDER, stage_start);
+            stage_start = led_metrics_cycles();
+            led_manager_refresh(dt->strip);
+            led_metrics_stage_done(dt->strip, LED_METRIC_REFRESH, stage_start);
+            led_metrics_frame_end(dt->strip);
             vTaskDelay(pdMS_TO_TICKS(delay_per_step));
             if (dt->stop_requested) {
                 animation_tasks[dt->strip] = NULL;
@@ -228,9 +249,9 @@ static void door_open_animation_task(void *param)
         // Ensure all LEDs are off at the end
         for (int i = 0; i < num_leds; i++)
         {
-            led_strip_set_pixel_rgbw(handle, i, 0, 0, 0, 0);
+            led_manager_set_pixel(dt->strip, i, 0, 0, 0, 0);
         }
-        if (handle) led_strip_refresh(handle);
+        led_manager_refresh(dt->strip);
         // Set mode to OFF after outro for clean state
         led_set_mode(dt->strip, LED_MODE_OFF);
     }    // Animation complete, task ends
@@ -257,11 +278,13 @@ esp_err_t led_dynamic_rainbow(led_strip_t strip, uint8_t brightness)
     rainbow_tasks[strip].stop_requested = false;
 
     // Create the animation task with larger stack
-    BaseType_t res = xTaskCreate(rainbow_animation_task, "led_rainbow",
+    // Pinned to CPU0 like the other LED tasks (BLE is on CPU1, stage timing uses the core cycle counter)
+    BaseType_t res = xTaskCreatePinnedToCore(rainbow_animation_task, "led_rainbow",
                                  4096,  // Increased stack size
                                  &rainbow_tasks[strip],
                                  5,
-                                 &animation_tasks[strip]);
+                                 &animation_tasks[strip],
+                                 0);
 
     if (res != pdPASS) {
         ESP_LOGE(TAG, "Failed to create rainbow animation task");
@@ -290,11 +313,12 @@ esp_err_t led_dynamic_door_open(led_strip_t strip, uint8_t brightness, bool dire
     door_open_tasks[strip].stop_requested = false;
 
     // Create the animation task
-    BaseType_t res = xTaskCreate(door_open_animation_task, "led_door_open",
+    BaseType_t res = xTaskCreatePinnedToCore(door_open_animation_task, "led_door_open",
                                  4096,  // Stack size
                                  &door_open_tasks[strip],
                                  5,
-                                 &animation_tasks[strip]);
+                                 &animation_tasks[strip],
+                                 0);    // CPU0 (see rainbow)
 
     if (res != pdPASS) {
         ESP_LOGE(TAG, "Failed to create door open animation task");
@@ -1,11 +1,14 @@
 #include "led_manager.h"
 #include "led_static_modes.h"
 #include "led_dynamic_modes.h"
+#include "led_metrics.h"
 #include "gpio_pinout.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
 #include <string.h>
 
 static const char *TAG = "LED_MGR";
@@ -24,6 +27,30 @@ typedef struct {
 static led_state_t roof_led_state;
 static led_state_t ext_led_state;
 
+// Exterior supply (EXT_LED MOSFET, shared by both exterior strips)
+#define EXT_RAIL_OFF_DELAY_MS 5000  // Black time before the supply is gated off
+#define EXT_RAIL_SETTLE_MS    10    // Power-up time of the LED drivers before the first frame
+
+static SemaphoreHandle_t ext_rail_mutex;
+static bool exterior_power_enabled = false;  // Requested by modes/commands
+static bool exterior_rail_on = false;        // Actual supply state
+static int64_t ext_rail_on_since_us = 0;
+static int64_t ext_black_since_us = 0;       // 0 while an exterior LED is lit
+
+// Lit LEDs of the exterior strips, one bit per LED. Only touched by the task
+// drawing the strip (like its pixel buffer), no lock per pixel
+#define EXT_LIT_WORDS (((LED_STRIP_EXT_FRONT_COUNT > LED_STRIP_EXT_BACK_COUNT ? \
+                         LED_STRIP_EXT_FRONT_COUNT : LED_STRIP_EXT_BACK_COUNT) + 31) / 32)
+static uint32_t ext_lit_bits[2][EXT_LIT_WORDS];
+static int ext_lit_count[2];
+static bool ext_frame_lit[2];                // Last frame sent had a lit LED (ext_rail_mutex)
+
+static inline bool is_exterior_strip(led_strip_t strip) {
+    return strip == LED_EXT_FRONT || strip == LED_EXT_BACK;
+}
+
+static void ext_rail_set(bool enabled);
+
 // Internal helper
 static led_state_t* get_led_state(led_strip_t strip) {
     return (strip <= LED_ROOF_STRIP_2) ? &roof_led_state : &ext_led_state;
@@ -36,6 +63,9 @@ esp_err_t led_manager_init(void)
 
     ESP_LOGI(TAG, "Initializing LED manager...");
 
+    ext_rail_mutex = xSemaphoreCreateMutex();
+    if (!ext_rail_mutex) return ESP_ERR_NO_MEM;
+
      // Configure exterior LED power pin
     gpio_config_t ext_cfg = {
         .pin_bit_mask = (1ULL << EXT_LED),
@@ -82,13 +112,22 @@ void led_manager_task(void *params)
 {
     ESP_LOGI(TAG, "LED manager task started");
     while (1) {
-        // Here we can process periodic tasks if needed
+        // Gate the exterior supply off once the exterior strips have been black long enough
+        xSemaphoreTake(ext_rail_mutex, portMAX_DELAY);
+        if (exterior_rail_on && ext_black_since_us != 0 &&
+            esp_timer_get_time() - ext_black_since_us >= EXT_RAIL_OFF_DELAY_MS * 1000LL) {
+            ESP_LOGI(TAG, "Exterior strips black for %d ms, gating their supply off", EXT_RAIL_OFF_DELAY_MS);
+            ext_rail_set(false);
+        }
+        xSemaphoreGive(ext_rail_mutex);
+
         vTaskDelay(pdMS_TO_TICKS(50));
     }
 }
 
 // ---------------- Mode Control ----------------
-esp_err_t led_set_mode(led_strip_t strip, led_mode_type_t mode)
+// Render the mode on the strip (LEDs only)
+static void render_mode(led_strip_t strip, led_mode_type_t mode)
 {
     led_state_t* state = get_led_state(strip);
     state->current_mode = mode;
@@ -96,12 +135,9 @@ esp_err_t led_set_mode(led_strip_t strip, led_mode_type_t mode)
     // Stop any dynamic animations
     led_dynamic_stop(strip);
 
-    ESP_LOGI(TAG, "Setting LED mode %d for strip %d", mode, strip);
     switch(mode) {
         case LED_MODE_OFF:
             led_static_off(strip, state->brightness);
-            heater_manager_set_air_heater(false, 0); // Provisoire: Stop air heater
-
             break;
         case LED_MODE_WHITE:
             led_static_white(strip, state->brightness);
@@ -109,7 +145,6 @@ esp_err_t led_set_mode(led_strip_t strip, led_mode_type_t mode)
         case LED_MODE_ORANGE:
             // led_static_orange(strip, state->brightness);
             // led_dynamic_door_open(strip, state->brightness, false); // Just for testing
-            heater_manager_set_air_heater(true, 100); // Provisoire: Start air heater at 100% fan speed
             break;
         case LED_MODE_FILM:
             led_static_film(strip, state->brightness);
@@ -125,11 +160,25 @@ esp_err_t led_set_mode(led_strip_t strip, led_mode_type_t mode)
             led_dynamic_door_open(strip, state->brightness, false);
             if (strip <= LED_ROOF_STRIP_2) state->door_animation_active = true;
             break;
+        case LED_MODE_CUSTOM:
+            // Colors are written by led_command_handler (app command or scene)
+            break;
         default:
             led_static_white(strip, state->brightness);
             break;
     }
+}
+
+esp_err_t led_set_mode(led_strip_t strip, led_mode_type_t mode)
+{
+    ESP_LOGI(TAG, "Setting LED mode %d for strip %d", mode, strip);
+    render_mode(strip, mode);
 
+    if (mode == LED_MODE_OFF) {
+        heater_manager_set_air_heater(false, 0); // Provisoire: Stop air heater
+    } else if (mode == LED_MODE_ORANGE) {
+        heater_manager_set_air_heater(true, 100); // Provisoire: Start air heater at 100% fan speed
+    }
     return ESP_OK;
 }
 
@@ -143,6 +192,20 @@ esp_err_t led_set_brightness(led_strip_t strip, uint8_t brightness)
     return ESP_OK;
 }
 
+esp_err_t led_restore_mode(led_strip_t strip, led_mode_type_t mode, uint8_t brightness)
+{
+    if (mode >= LED_MODE_COUNT) return ESP_ERR_INVALID_ARG;
+
+    get_led_state(strip)->brightness = brightness;
+    render_mode(strip, mode);
+    return ESP_OK;
+}
+
+led_mode_type_t led_get_mode(led_strip_t strip)
+{
+    return get_led_state(strip)->current_mode;
+}
+
 uint8_t led_get_brightness(led_strip_t strip)
 {
     return get_led_state(strip)->brightness;
@@ -177,9 +240,9 @@ esp_err_t led_trigger_error_mode(void)
     return ESP_OK;
 }
 
-esp_err_t led_set_exterior_power(bool enabled)
+// Drive the exterior supply MOSFET (ext_rail_mutex held)
+static void ext_rail_set(bool enabled)
 {
-    ESP_LOGI(TAG, "Setting exterior LED power to %d on GPIO %d", enabled, EXT_LED);
     gpio_reset_pin(EXT_LED);
     if(enabled){
         // The mosfet is pulled high by 5v power through a resistor so if the gpio is set to HIGH 3.3v 
@@ -190,9 +253,29 @@ esp_err_t led_set_exterior_power(bool enabled)
         gpio_set_direction(EXT_LED, GPIO_MODE_OUTPUT);
         gpio_set_level(EXT_LED, 0);
     }
+    exterior_rail_on = enabled;
+    if (enabled) ext_rail_on_since_us = esp_timer_get_time();
+}
+
+esp_err_t led_set_exterior_power(bool enabled)
+{
+    ESP_LOGI(TAG, "Setting exterior LED power to %d on GPIO %d", enabled, EXT_LED);
+    xSemaphoreTake(ext_rail_mutex, portMAX_DELAY);
+    exterior_power_enabled = enabled;
+    if (exterior_rail_on != enabled) {
+        ext_rail_set(enabled);
+    }
+    // Give the caller's next frame the full delay before gating again
+    if (ext_black_since_us != 0) ext_black_since_us = esp_timer_get_time();
+    xSemaphoreGive(ext_rail_mutex);
     return ESP_OK;
 }
 
+bool led_get_exterior_power(void)
+{
+    return exterior_power_enabled;
+}
+
 
 led_strip_handle_t led_manager_get_handle(led_strip_t strip)
 {
@@ -212,6 +295,70 @@ int led_manager_get_led_count(led_strip_t strip)
     }
 }
 
+esp_err_t led_manager_set_pixel(led_strip_t strip, int index, uint8_t r, uint8_t g, uint8_t b, uint8_t w)
+{
+    led_strip_handle_t handle = led_manager_get_handle(strip);
+    if (!handle) return ESP_ERR_INVALID_STATE;
+
+    if (is_exterior_strip(strip) && index >= 0 && index < led_manager_get_led_count(strip)) {
+        int e = strip - LED_EXT_FRONT;
+        uint32_t bit = 1UL << (index & 31);
+        uint32_t* word = &ext_lit_bits[e][index >> 5];
+        bool lit = (r | g | b | w) != 0;
+        if (lit && !(*word & bit)) {
+            *word |= bit;
+            ext_lit_count[e]++;
+        } else if (!lit && (*word & bit)) {
+            *word &= ~bit;
+            ext_lit_count[e]--;
+        }
+    }
+
+    return led_strip_set_pixel_rgbw(handle, index, r, g, b, w);
+}
+
+esp_err_t led_manager_refresh(led_strip_t strip)
+{
+    led_strip_handle_t handle = led_manager_get_handle(strip);
+    if (!handle) return ESP_ERR_INVALID_STATE;
+
+    if (!is_exterior_strip(strip)) {
+        return led_strip_refresh(handle);
+    }
+
+    // Mutex held until the frame is sent: the idle gating cannot cut the
+    // supply between the settle wait and the frame
+    int e = strip - LED_EXT_FRONT;
+    xSemaphoreTake(ext_rail_mutex, portMAX_DELAY);
+    ext_frame_lit[e] = ext_lit_count[e] > 0;
+    bool lit = ext_frame_lit[0] || ext_frame_lit[1];
+    if (lit) {
+        ext_black_since_us = 0;
+    } else if (ext_black_since_us == 0) {
+        ext_black_since_us = esp_timer_get_time();
+    }
+
+    if (!exterior_rail_on) {
+        // Unpowered strips: a black frame changes nothing, a lit one needs the supply back
+        if (!lit || !exterior_power_enabled) {
+            xSemaphoreGive(ext_rail_mutex);
+            return ESP_OK;
+        }
+        ESP_LOGI(TAG, "Exterior frame lit, switching supply back on");
+        ext_rail_set(true);
+    }
+
+    // Let the LED drivers power up before sending them data
+    int64_t powered_us = esp_timer_get_time() - ext_rail_on_since_us;
+    if (powered_us < EXT_RAIL_SETTLE_MS * 1000LL) {
+        vTaskDelay(pdMS_TO_TICKS(EXT_RAIL_SETTLE_MS - powered_us / 1000) + 1);
+    }
+
+    esp_err_t ret = led_strip_refresh(handle);
+    xSemaphoreGive(ext_rail_mutex);
+    return ret;
+}
+
 esp_err_t led_manager_update_van_state(van_state_t* van_state){
     if(!van_state) return ESP_ERR_INVALID_ARG;
 
@@ -232,6 +379,12 @@ esp_err_t led_manager_update_van_state(van_state_t* van_state){
     van_state->leds.leds_ar.current_mode = ext_led_state.current_mode;
     van_state->leds.leds_ar.brightness = ext_led_state.brightness;
 
+    // Rendering pipeline instrumentation
+    static led_metrics_reader_t metrics_reader;
+    for (int strip = 0; strip < LED_STRIP_COUNT; strip++) {
+        led_metrics_get((led_strip_t)strip, &metrics_reader, &van_state->leds.metrics[strip]);
+    }
+
     return ESP_OK;
     
 }
\ No newline at end of file
@@ -20,15 +20,11 @@ typedef enum {
     LED_MODE_RAINBOW,
     LED_MODE_DOOR_OPEN,
     LED_MODE_DOOR_TIMEOUT,
+    LED_MODE_CUSTOM,        // Static colors from the app or a scene (rendered by led_command_handler)
+    LED_MODE_COUNT
 } led_mode_type_t;
 
-typedef enum {
-    LED_ROOF_STRIP_1,
-    LED_ROOF_STRIP_2,
-    LED_EXT_FRONT,
-    LED_EXT_BACK,
-    LED_STRIP_COUNT
-} led_strip_t;
+// led_strip_t is in protocol.h (indexes the LED metrics of the van state)
 esp_err_t led_manager_init(void);
 
 // Set LED mode for a specific strip
@@ -37,12 +33,22 @@ esp_err_t led_set_mode(led_strip_t strip, led_mode_type_t mode);
 // Set LED brightness (0-255)
 esp_err_t led_set_brightness(led_strip_t strip, uint8_t brightness);
 
+// Restore a saved mode and brightness (scene recall): the strip is rendered once,
+// without the other effects of led_set_mode()
+esp_err_t led_restore_mode(led_strip_t strip, led_mode_type_t mode, uint8_t brightness);
+
+// Get current mode
+led_mode_type_t led_get_mode(led_strip_t strip);
+
 // Trigger pre-defined animations
 esp_err_t led_trigger_door_animation(void);
 esp_err_t led_trigger_error_mode(void);
 
 // Control exterior LED power
+// The supply is also gated off automatically while the exterior strips stay black,
+// and switched back on (with its settle time) before the next lit frame
 esp_err_t led_set_exterior_power(bool enabled);
+bool led_get_exterior_power(void);
 
 // Get current brightness (0-255)
 uint8_t led_get_brightness(led_strip_t strip);
@@ -61,6 +67,10 @@ void led_manager_task(void *params);
 led_strip_handle_t led_manager_get_handle(led_strip_t strip);
 int led_manager_get_led_count(led_strip_t strip);
 
+// Pixel write / frame commit used by every LED mode (tracks lit LEDs for the exterior supply gating)
+esp_err_t led_manager_set_pixel(led_strip_t strip, int index, uint8_t r, uint8_t g, uint8_t b, uint8_t w);
+esp_err_t led_manager_refresh(led_strip_t strip);
+
 esp_err_t led_manager_update_van_state(van_state_t* van_state);
 
 #endif // LED_MANAGER_H
\ No newline at end of file
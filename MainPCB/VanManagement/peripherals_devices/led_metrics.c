@@ -0,0 +1,159 @@
+#include "led_metrics.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "LED_METRICS";
+
+// Number of frames kept for the rolling statistics (~4s at 30 FPS)
+#define LED_METRICS_WINDOW 128
+
+// Series recorded for each strip: the pipeline stages + the start jitter
+#define LED_METRIC_JITTER  LED_METRIC_STAGE_COUNT
+#define LED_METRIC_SERIES  (LED_METRIC_STAGE_COUNT + 1)
+
+typedef struct {
+    uint16_t samples_us[LED_METRICS_WINDOW];
+    uint8_t head;
+    uint8_t count;
+} led_metric_series_t;
+
+typedef struct {
+    led_metric_series_t series[LED_METRIC_SERIES];
+    int64_t frame_start_us;
+    int64_t deadline_us;
+    uint32_t period_ms;
+    uint32_t frames;            // Frames since boot (readers keep their own deltas)
+    uint32_t missed_deadlines;
+} led_strip_metrics_ctx_t;
+
+static led_strip_metrics_ctx_t metrics_ctx[LED_STRIP_COUNT];
+
+// Store a sample (saturated to 16 bits) in a ring buffer
+static void push_sample(led_metric_series_t* series, uint32_t value_us)
+{
+    series->samples_us[series->head] = (value_us > UINT16_MAX) ? UINT16_MAX : (uint16_t)value_us;
+    series->head = (series->head + 1) % LED_METRICS_WINDOW;
+    if (series->count < LED_METRICS_WINDOW) series->count++;
+}
+
+static int compare_u16(const void* a, const void* b)
+{
+    return (int)*(const uint16_t*)a - (int)*(const uint16_t*)b;
+}
+
+// min/avg/max/p99 of a ring buffer (called at report time only)
+static void compute_stats(const led_metric_series_t* series, led_timing_stats_t* stats)
+{
+    memset(stats, 0, sizeof(led_timing_stats_t));
+    uint8_t count = series->count;
+    if (count == 0) return;
+
+    uint16_t sorted[LED_METRICS_WINDOW];
+    memcpy(sorted, series->samples_us, count * sizeof(uint16_t));
+    qsort(sorted, count, sizeof(uint16_t), compare_u16);
+
+    uint32_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += sorted[i];
+    }
+
+    stats->min_us = sorted[0];
+    stats->avg_us = (uint16_t)(sum / count);
+    stats->max_us = sorted[count - 1];
+    stats->p99_us = sorted[(count * 99 + 99) / 100 - 1];
+}
+
+void led_metrics_frame_start(led_strip_t strip, uint32_t period_ms)
+{
+    if (strip >= LED_STRIP_COUNT) return;
+    led_strip_metrics_ctx_t* ctx = &metrics_ctx[strip];
+    int64_t now_us = esp_timer_get_time();
+    int64_t period_us = (int64_t)period_ms * 1000;
+
+    // Unscheduled frame (static mode): counted, no jitter and no deadline
+    if (period_ms == 0) {
+        ctx->frame_start_us = 0;
+        ctx->deadline_us = INT64_MAX;
+        ctx->period_ms = 0;
+        return;
+    }
+
+    // Frame expected one period after the previous one; after a pause (new
+    // animation) the schedule restarts instead of reporting a huge jitter
+    int64_t expected_us = ctx->frame_start_us + (int64_t)ctx->period_ms * 1000;
+    if (ctx->frame_start_us != 0 && period_ms == ctx->period_ms &&
+        now_us - expected_us < 4 * period_us) {
+        push_sample(&ctx->series[LED_METRIC_JITTER],
+                    (now_us > expected_us) ? (uint32_t)(now_us - expected_us) : 0);
+    } else {
+        expected_us = now_us;
+    }
+
+    ctx->frame_start_us = now_us;
+    ctx->deadline_us = expected_us + period_us;
+    ctx->period_ms = period_ms;
+}
+
+void led_metrics_stage_done(led_strip_t strip, led_metric_stage_t stage, uint32_t start_cycles)
+{
+    if (strip >= LED_STRIP_COUNT || stage >= LED_METRIC_STAGE_COUNT) return;
+    uint32_t cycles = led_metrics_cycles() - start_cycles;
+    push_sample(&metrics_ctx[strip].series[stage], cycles / esp_rom_get_cpu_ticks_per_us());
+}
+
+void led_metrics_frame_end(led_strip_t strip)
+{
+    if (strip >= LED_STRIP_COUNT) return;
+    led_strip_metrics_ctx_t* ctx = &metrics_ctx[strip];
+    ctx->frames++;
+    if (esp_timer_get_time() > ctx->deadline_us) {
+        ctx->missed_deadlines++;
+    }
+}
+
+void led_metrics_get(led_strip_t strip, led_metrics_reader_t* reader, led_strip_metrics_t* metrics)
+{
+    if (strip >= LED_STRIP_COUNT || !reader || !metrics) return;
+    led_strip_metrics_ctx_t* ctx = &metrics_ctx[strip];
+
+    // FPS over the time elapsed since this reader's previous call
+    int64_t now_us = esp_timer_get_time();
+    uint32_t frames = ctx->frames;
+    int64_t elapsed_us = now_us - reader->last_us[strip];
+    uint32_t delta = frames - reader->last_frames[strip];
+    bool first = reader->last_us[strip] == 0;
+    reader->last_frames[strip] = frames;
+    reader->last_us[strip] = now_us;
+    metrics->fps = (!first && elapsed_us > 0) ? (uint8_t)((delta * 1000000ULL + elapsed_us / 2) / elapsed_us) : 0;
+
+    compute_stats(&ctx->series[LED_METRIC_RENDER], &metrics->render);
+    compute_stats(&ctx->series[LED_METRIC_CONVERT], &metrics->convert);
+    compute_stats(&ctx->series[LED_METRIC_REFRESH], &metrics->refresh);
+    compute_stats(&ctx->series[LED_METRIC_JITTER], &metrics->jitter);
+    metrics->missed_deadlines = ctx->missed_deadlines;
+}
+
+void led_metrics_print_summary(void)
+{
+    static const char* strip_names[LED_STRIP_COUNT] = {"Roof1", "Roof2", "Front", "Rear"};
+    // Last published state (the live one belongs to the update cycle)
+    static van_state_t snapshot;
+    if (protocol_get_van_state_snapshot(&snapshot) == 0) return;
+    const van_state_t* state = &snapshot;
+
+    ESP_LOGI(TAG, "=== LED PIPELINE (us: min/avg/max/p99) ===");
+    for (int s = 0; s < LED_STRIP_COUNT; s++) {
+        const led_strip_metrics_t* m = &state->leds.metrics[s];
+        if (m->fps == 0 && m->missed_deadlines == 0) continue;
+        ESP_LOGI(TAG, "%s: %d fps, missed deadlines: %lu", strip_names[s], m->fps, m->missed_deadlines);
+        ESP_LOGI(TAG, "  Render:  %u/%u/%u/%u", m->render.min_us, m->render.avg_us, m->render.max_us, m->render.p99_us);
+        ESP_LOGI(TAG, "  Convert: %u/%u/%u/%u", m->convert.min_us, m->convert.avg_us, m->convert.max_us, m->convert.p99_us);
+        ESP_LOGI(TAG, "  Refresh: %u/%u/%u/%u", m->refresh.min_us, m->refresh.avg_us, m->refresh.max_us, m->refresh.p99_us);
+        ESP_LOGI(TAG, "  Jitter:  %u/%u/%u/%u", m->jitter.min_us, m->jitter.avg_us, m->jitter.max_us, m->jitter.p99_us);
+    }
+    ESP_LOGI(TAG, "========================");
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "esp_err.h"
+#include "esp_cpu.h"
+#include "led_manager.h"
+#include "../communications/protocol.h"
+
+// Pipeline stages timed for each frame
+typedef enum {
+    LED_METRIC_RENDER,    // Compute the colors of the frame
+    LED_METRIC_CONVERT,   // Scale and write the colors into the strip pixel buffer
+    LED_METRIC_REFRESH,   // led_strip_refresh() (encoding + DMA transfer)
+    LED_METRIC_STAGE_COUNT
+} led_metric_stage_t;
+
+// Position of one reader in the frame counters (one per caller of led_metrics_get)
+typedef struct {
+    uint32_t last_frames[LED_STRIP_COUNT];
+    int64_t last_us[LED_STRIP_COUNT];
+} led_metrics_reader_t;
+
+// Cycle counter of the current core, to pass to led_metrics_stage_done()
+static inline uint32_t led_metrics_cycles(void)
+{
+    return (uint32_t)esp_cpu_get_cycle_count();
+}
+
+// Mark the start of a frame scheduled every period_ms (measures the jitter),
+// period_ms = 0 for an unscheduled frame (static mode)
+void led_metrics_frame_start(led_strip_t strip, uint32_t period_ms);
+
+// Record the duration of a stage started at start_cycles (led_metrics_cycles())
+void led_metrics_stage_done(led_strip_t strip, led_metric_stage_t stage, uint32_t start_cycles);
+
+// Mark the end of a frame (counts the frame and checks its deadline)
+void led_metrics_frame_end(led_strip_t strip);
+
+// Rolling statistics of a strip over the last frames, FPS since the reader's previous call
+void led_metrics_get(led_strip_t strip, led_metrics_reader_t* reader, led_strip_metrics_t* metrics);
+
+// Print the statistics of all strips (debug)
+void led_metrics_print_summary(void);
@@ -0,0 +1,281 @@
+#include "led_scenes.h"
+#include "led_manager.h"
+#include "led_command_handler.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "LED_SCENES";
+
+#define LED_SCENES_NVS_NAMESPACE "led_scenes"
+#define LED_SCENE_FORMAT_VERSION 1
+
+// Scene blob layout:
+//   led_scene_header_t
+//   for each strip in LED_MODE_CUSTOM: run count (uint16_t) + led_scene_run_t[run count]
+// Uniform or banded colors (the common case) fit in a few dozen bytes instead
+// of the ~1.2 KB of a static command.
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint8_t exterior_power;
+    uint8_t mode[LED_STRIP_COUNT];
+    uint8_t brightness[LED_STRIP_COUNT];
+} led_scene_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t length;         // Consecutive LEDs sharing the color
+    led_data_t color;
+} led_scene_run_t;
+
+#define LED_SCENE_TOTAL_LEDS \
+    (LED_STRIP_1_COUNT + LED_STRIP_2_COUNT + LED_STRIP_EXT_FRONT_COUNT + LED_STRIP_EXT_BACK_COUNT)
+
+// Worst case: every LED differs from its neighbour
+#define LED_SCENE_MAX_SIZE \
+    (sizeof(led_scene_header_t) + LED_STRIP_COUNT * sizeof(uint16_t) + LED_SCENE_TOTAL_LEDS * sizeof(led_scene_run_t))
+
+static nvs_handle_t scenes_nvs;
+static bool scenes_ready = false;
+
+// Encode/decode buffers (scene commands are serialized by the command mutex / coordinator)
+static uint8_t scene_blob[LED_SCENE_MAX_SIZE];
+static led_roof1_strip_colors_t scene_roof1_colors;
+static led_roof2_strip_colors_t scene_roof2_colors;
+static led_ext_av_strip_colors_t scene_ext_av_colors;
+static led_ext_ar_strip_colors_t scene_ext_ar_colors;
+static led_data_t* const scene_colors[LED_STRIP_COUNT] = {
+    scene_roof1_colors.color,
+    scene_roof2_colors.color,
+    scene_ext_av_colors.color,
+    scene_ext_ar_colors.color,
+};
+
+static void scene_key(uint8_t slot, char* key, size_t key_size)
+{
+    snprintf(key, key_size, "scene%u", slot);
+}
+
+// Door animations are transient: store the state they end in
+static led_mode_type_t scene_mode(led_mode_type_t mode)
+{
+    switch (mode) {
+        case LED_MODE_DOOR_OPEN:    return LED_MODE_WHITE;
+        case LED_MODE_DOOR_TIMEOUT: return LED_MODE_OFF;
+        default:                    return mode;
+    }
+}
+
+static bool same_color(const led_data_t* a, const led_data_t* b)
+{
+    return a->r == b->r && a->g == b->g && a->b == b->b &&
+           a->w == b->w && a->brightness == b->brightness;
+}
+
+// Run-length encode a strip, returns the number of bytes written
+static size_t encode_runs(const led_data_t* colors, int num_leds, uint8_t* out)
+{
+    uint16_t run_count = 0;
+    size_t offset = sizeof(uint16_t);
+
+    int i = 0;
+    while (i < num_leds) {
+        led_scene_run_t run = { .length = 1, .color = colors[i] };
+        while (i + run.length < num_leds && run.length < UINT8_MAX &&
+               same_color(&colors[i + run.length], &colors[i])) {
+            run.length++;
+        }
+        memcpy(&out[offset], &run, sizeof(run));
+        offset += sizeof(run);
+        run_count++;
+        i += run.length;
+    }
+
+    memcpy(out, &run_count, sizeof(run_count));
+    return offset;
+}
+
+// Expand the runs of a strip, returns the number of bytes read (0 if malformed)
+static size_t decode_runs(const uint8_t* in, size_t len, led_data_t* colors, int num_leds)
+{
+    uint16_t run_count;
+    if (len < sizeof(run_count)) return 0;
+    memcpy(&run_count, in, sizeof(run_count));
+
+    size_t offset = sizeof(run_count);
+    if (run_count == 0) return offset;
+    if (len < offset + run_count * sizeof(led_scene_run_t)) return 0;
+
+    int led = 0;
+    for (uint16_t r = 0; r < run_count; r++) {
+        led_scene_run_t run;
+        memcpy(&run, &in[offset], sizeof(run));
+        offset += sizeof(run);
+        if (led + run.length > num_leds) return 0;
+        for (int i = 0; i < run.length; i++) {
+            colors[led++] = run.color;
+        }
+    }
+    return (led == num_leds) ? offset : 0;
+}
+
+esp_err_t led_scenes_init(void)
+{
+    esp_err_t ret = nvs_open(LED_SCENES_NVS_NAMESPACE, NVS_READWRITE, &scenes_nvs);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open scene storage: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    scenes_ready = true;
+    ESP_LOGI(TAG, "LED scenes initialized (%d slots, max %d bytes each)",
+             LED_SCENE_SLOT_COUNT, (int)LED_SCENE_MAX_SIZE);
+    return ESP_OK;
+}
+
+esp_err_t led_scene_save(uint8_t slot)
+{
+    if (!scenes_ready) return ESP_ERR_INVALID_STATE;
+    if (slot >= LED_SCENE_SLOT_COUNT) return ESP_ERR_INVALID_ARG;
+
+    led_scene_header_t header = {
+        .version = LED_SCENE_FORMAT_VERSION,
+        .exterior_power = led_get_exterior_power(),
+    };
+    size_t len = sizeof(header);
+
+    for (int strip = 0; strip < LED_STRIP_COUNT; strip++) {
+        header.mode[strip] = scene_mode(led_get_mode(strip));
+        header.brightness[strip] = led_get_brightness(strip);
+
+        if (header.mode[strip] == LED_MODE_CUSTOM) {
+            // No colors recorded (animation took over): saved as "leave untouched"
+            const led_data_t* colors = led_get_static_colors(strip);
+            int num_leds = colors ? led_manager_get_led_count(strip) : 0;
+            len += encode_runs(colors, num_leds, &scene_blob[len]);
+        }
+    }
+    memcpy(scene_blob, &header, sizeof(header));
+
+    char key[16];
+    scene_key(slot, key, sizeof(key));
+    esp_err_t ret = nvs_set_blob(scenes_nvs, key, scene_blob, len);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(scenes_nvs);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save scene %d: %s", slot, esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Scene %d saved (%d bytes)", slot, (int)len);
+    return ESP_OK;
+}
+
+esp_err_t led_scene_recall(uint8_t slot)
+{
+    if (!scenes_ready) return ESP_ERR_INVALID_STATE;
+    if (slot >= LED_SCENE_SLOT_COUNT) return ESP_ERR_INVALID_ARG;
+
+    // Single flash read: the whole scene is one blob
+    char key[16];
+    scene_key(slot, key, sizeof(key));
+    size_t len = sizeof(scene_blob);
+    esp_err_t ret = nvs_get_blob(scenes_nvs, key, scene_blob, &len);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGW(TAG, "Scene %d is empty", slot);
+        return ret;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read scene %d: %s", slot, esp_err_to_name(ret));
+        return ret;
+    }
+
+    led_scene_header_t header;
+    if (len < sizeof(header)) return ESP_ERR_INVALID_SIZE;
+    memcpy(&header, scene_blob, sizeof(header));
+    if (header.version != LED_SCENE_FORMAT_VERSION) {
+        ESP_LOGE(TAG, "Scene %d has unsupported format %d", slot, header.version);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    // Decode everything before touching the strips
+    const led_data_t* colors[LED_STRIP_COUNT] = {NULL};
+    bool has_frame = false;
+    size_t offset = sizeof(header);
+    for (int strip = 0; strip < LED_STRIP_COUNT; strip++) {
+        if (header.mode[strip] >= LED_MODE_COUNT) {
+            ESP_LOGE(TAG, "Scene %d is corrupted (strip %d, mode %d)", slot, strip, header.mode[strip]);
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (header.mode[strip] != LED_MODE_CUSTOM) continue;
+
+        size_t used = decode_runs(&scene_blob[offset], len - offset,
+                                  scene_colors[strip], led_manager_get_led_count(strip));
+        if (used == 0) {
+            ESP_LOGE(TAG, "Scene %d is corrupted (strip %d)", slot, strip);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        if (used > sizeof(uint16_t)) {
+            colors[strip] = scene_colors[strip];
+            has_frame = true;
+        }
+        offset += used;
+    }
+
+    // Exterior strips need their supply before receiving data
+    if (header.exterior_power && !led_get_exterior_power()) {
+        led_set_exterior_power(true);
+    }
+
+    // Built-in modes render themselves, custom colors go out as a single frame
+    for (int strip = 0; strip < LED_STRIP_COUNT; strip++) {
+        if (header.mode[strip] == LED_MODE_CUSTOM && !colors[strip]) continue;
+        led_stop_animations(strip);
+        led_restore_mode(strip, header.mode[strip], header.brightness[strip]);
+    }
+    if (has_frame) {
+        ret = led_apply_static_frame(colors);
+        if (ret != ESP_OK) return ret;
+    }
+    if (!header.exterior_power && led_get_exterior_power()) {
+        led_set_exterior_power(false);
+    }
+
+    ESP_LOGI(TAG, "Scene %d recalled (%d bytes)", slot, (int)len);
+    return ESP_OK;
+}
+
+esp_err_t led_scene_delete(uint8_t slot)
+{
+    if (!scenes_ready) return ESP_ERR_INVALID_STATE;
+    if (slot >= LED_SCENE_SLOT_COUNT) return ESP_ERR_INVALID_ARG;
+
+    char key[16];
+    scene_key(slot, key, sizeof(key));
+    esp_err_t ret = nvs_erase_key(scenes_nvs, key);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) return ESP_OK;
+    if (ret == ESP_OK) {
+        ret = nvs_commit(scenes_nvs);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to delete scene %d: %s", slot, esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Scene %d deleted", slot);
+    return ESP_OK;
+}
+
+esp_err_t led_scene_apply_command(const led_scene_command_t* scene_cmd)
+{
+    if (!scene_cmd) return ESP_ERR_INVALID_ARG;
+
+    switch (scene_cmd->action) {
+        case LED_SCENE_RECALL: return led_scene_recall(scene_cmd->slot);
+        case LED_SCENE_SAVE:   return led_scene_save(scene_cmd->slot);
+        case LED_SCENE_DELETE: return led_scene_delete(scene_cmd->slot);
+        default:
+            ESP_LOGE(TAG, "Unknown scene action: %d", scene_cmd->action);
+            return ESP_ERR_INVALID_ARG;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef LED_SCENES_H
+#define LED_SCENES_H
+
+#include "esp_err.h"
+#include <stdint.h>
+#include "../communications/protocol.h"
+
+// Scene presets: snapshot of the 4 strips (mode, colors, brightness, exterior
+// power) stored as one compact NVS blob per slot (see LED_COMMAND_HANDLER.md)
+
+// Open the scene storage (NVS must be initialized)
+esp_err_t led_scenes_init(void);
+
+// Save the current state of the strips in a slot
+esp_err_t led_scene_save(uint8_t slot);
+
+// Re-apply a saved scene: one NVS read, static colors committed as one frame
+esp_err_t led_scene_recall(uint8_t slot);
+
+// Erase a slot
+esp_err_t led_scene_delete(uint8_t slot);
+
+// Execute a scene command received from the app
+esp_err_t led_scene_apply_command(const led_scene_command_t* scene_cmd);
+
+#endif // LED_SCENES_H
@@ -1,5 +1,6 @@
 #include "led_static_modes.h"
 #include "led_manager.h" 
+#include "led_metrics.h"
 #include "gpio_pinout.h"
 #include "esp_log.h"
 #include "led_strip.h"
@@ -121,52 +122,51 @@ esp_err_t led_static_init_strips(led_strip_handle_t strips[])
 }
 
 // Generic helper to fill a strip with color
-static void set_strip_color(led_strip_handle_t handle, int num_leds,
+static void set_strip_color(led_strip_t strip,
                             uint8_t r, uint8_t g, uint8_t b, uint8_t w, uint8_t brightness)
 {
-    if (!handle || num_leds <= 0) return;
+    int num_leds = led_manager_get_led_count(strip);
+    if (!led_manager_get_handle(strip) || num_leds <= 0) return;
 
     // Scale RGBW values by brightness (0–255)
     float scale = brightness / 255.0f;
 
+    led_metrics_frame_start(strip, 0);
+    uint32_t stage_start = led_metrics_cycles();
     for (int i = 0; i < num_leds; i++)
     {
-        led_strip_set_pixel_rgbw(handle,
-                                 i,
-                                 (uint8_t)(r * scale),
-                                 (uint8_t)(g * scale),
-                                 (uint8_t)(b * scale),
-                                 (uint8_t)(w * scale));
+        led_manager_set_pixel(strip,
+                              i,
+                              (uint8_t)(r * scale),
+                              (uint8_t)(g * scale),
+                              (uint8_t)(b * scale),
+                              (uint8_t)(w * scale));
     }
+    led_metrics_stage_done(strip, LED_METRIC_CONVERT, stage_start);
 
-    led_strip_refresh(handle);
+    stage_start = led_metrics_cycles();
+    led_manager_refresh(strip);
+    led_metrics_stage_done(strip, LED_METRIC_REFRESH, stage_start);
+    led_metrics_frame_end(strip);
 }
 
 // --- Public static modes ---
 void led_static_off(led_strip_t strip, uint8_t brightness)
 {
-    led_strip_handle_t handle = led_manager_get_handle(strip);
-    int num_leds = led_manager_get_led_count(strip);
-    set_strip_color(handle, num_leds, 0, 0, 0, 0, brightness);
+    set_strip_color(strip, 0, 0, 0, 0, brightness);
 }
 
 void led_static_white(led_strip_t strip, uint8_t brightness)
 {
-    led_strip_handle_t handle = led_manager_get_handle(strip);
-    int num_leds = led_manager_get_led_count(strip);
-    set_strip_color(handle, num_leds, 0, 0, 0, 255, brightness);
+    set_strip_color(strip, 0, 0, 0, 255, brightness);
 }
 
 void led_static_orange(led_strip_t strip, uint8_t brightness)
 {
-    led_strip_handle_t handle = led_manager_get_handle(strip);
-    int num_leds = led_manager_get_led_count(strip);
-    set_strip_color(handle, num_leds, 220, 120, 0, 0, brightness);
+    set_strip_color(strip, 220, 120, 0, 0, brightness);
 }
 
 void led_static_film(led_strip_t strip, uint8_t brightness)
 {
-    led_strip_handle_t handle = led_manager_get_handle(strip);
-    int num_leds = led_manager_get_led_count(strip);
-    set_strip_color(handle, num_leds, 30, 10, 0, 0, brightness);
+    set_strip_color(strip, 30, 10, 0, 0, brightness);
 }
@@ -6,12 +6,15 @@
 #ifdef ENABLE_ENERGY_SIMULATION
 #include "energy_simulation.h"
 #endif
+#include "ve_direct.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include <inttypes.h>
 
 #if defined(ENABLE_ENERGY_SIMULATION) && ENABLE_ENERGY_SIMULATION
 #define SIMULATE_MPPT_DATA 1  // Set to 1 to simulate MPPT data for testing
@@ -23,21 +26,237 @@ static const char *TAG = "MPPT_MGR";
 static TaskHandle_t mppt_task_handle;
 
 typedef struct {
-    float solar_power;
-    float battery_voltage;
-    float battery_current;
-    int8_t temperature;
-    uint8_t state;
-    bool data_valid;
+    ve_direct_parser_t parser;      // Stream context of this charger only
+    ve_direct_block_t block;        // Latest value of each field (text blocks and HEX registers)
+    bool data_valid;                // A block has been received since the last check
+
+    // HEX transaction in progress (filled by the frame handler)
+    bool hex_waiting;
+    uint8_t hex_wait_rsp;
+    uint16_t hex_wait_reg;
+    ve_direct_hex_frame_t hex_response;
 } mppt_data_t;
 
 static mppt_data_t mppt_100_50_data;
 static mppt_data_t mppt_70_15_data;
 
+// Serializes the parser accesses of the task and of the HEX API callers
+static SemaphoreHandle_t mppt_uart_mutex;
+
+// Registers polled each cycle when the charger can be addressed
+static const uint16_t hex_poll_registers[] = {
+    VE_REG_PANEL_POWER,
+    VE_REG_PANEL_VOLTAGE,
+    VE_REG_CHARGER_VOLTAGE,
+    VE_REG_CHARGER_CURRENT,
+    VE_REG_DEVICE_STATE,
+    VE_REG_CHARGER_ERROR,
+};
+
+// History registers, polled every MPPT_HEX_HISTORY_CYCLES cycles
+static const uint16_t hex_history_registers[] = {
+    VE_REG_YIELD_TODAY,
+    VE_REG_MAX_POWER_TODAY,
+    VE_REG_YIELD_YESTERDAY,
+    VE_REG_MAX_POWER_YESTERDAY,
+};
+
+static mppt_data_t* get_mppt_data(mppt_id_t id) {
+    return (id == MPPT_100_50) ? &mppt_100_50_data : &mppt_70_15_data;
+}
+
+static void set_field(ve_direct_block_t* block, ve_direct_field_t field, int32_t value) {
+    block->values[field] = value;
+    block->field_mask |= 1UL << field;
+}
+
+// Keep the fields missing from a text block (registers read over HEX, optional labels)
+static void merge_block(ve_direct_block_t* dst, const ve_direct_block_t* src) {
+    for (int f = 0; f < VE_FIELD_COUNT; f++) {
+        if (ve_direct_has(src, f)) {
+            set_field(dst, f, src->values[f]);
+        }
+    }
+}
+
+// Convert a register value to the units of the text protocol
+static void apply_register(ve_direct_block_t* block, uint16_t reg, uint32_t value) {
+    switch (reg) {
+        case VE_REG_PANEL_POWER:         set_field(block, VE_FIELD_PPV, (int32_t)(value / 100)); break;
+        case VE_REG_PANEL_VOLTAGE:       set_field(block, VE_FIELD_VPV, (int32_t)value * 10); break;
+        case VE_REG_CHARGER_VOLTAGE:     set_field(block, VE_FIELD_V, (int32_t)value * 10); break;
+        case VE_REG_CHARGER_CURRENT:     set_field(block, VE_FIELD_I, (int32_t)value * 100); break;
+        case VE_REG_DEVICE_STATE:        set_field(block, VE_FIELD_CS, (int32_t)value); break;
+        case VE_REG_CHARGER_ERROR:       set_field(block, VE_FIELD_ERR, (int32_t)value); break;
+        case VE_REG_YIELD_TODAY:         set_field(block, VE_FIELD_H20, (int32_t)value); break;
+        case VE_REG_MAX_POWER_TODAY:     set_field(block, VE_FIELD_H21, (int32_t)value); break;
+        case VE_REG_YIELD_YESTERDAY:     set_field(block, VE_FIELD_H22, (int32_t)value); break;
+        case VE_REG_MAX_POWER_YESTERDAY: set_field(block, VE_FIELD_H23, (int32_t)value); break;
+        default: break;
+    }
+}
+
+// Called by the parser for each valid HEX frame of this charger
+static void mppt_hex_frame_handler(const ve_direct_hex_frame_t* frame, void* ctx) {
+    mppt_data_t* data = (mppt_data_t*)ctx;
+    bool has_register = (frame->rsp == VE_HEX_RSP_GET || frame->rsp == VE_HEX_RSP_SET ||
+                         frame->rsp == VE_HEX_RSP_ASYNC);
+
+    // Async frames and answers to our Get both refresh the data
+    if ((frame->rsp == VE_HEX_RSP_GET || frame->rsp == VE_HEX_RSP_ASYNC) &&
+        frame->len > 3 && ve_direct_hex_flags(frame) == 0) {
+        apply_register(&data->block, ve_direct_hex_register(frame), ve_direct_hex_value(frame));
+    }
+
+    if (!data->hex_waiting) return;
+    bool matches = (frame->rsp == data->hex_wait_rsp) &&
+                   (!has_register || ve_direct_hex_register(frame) == data->hex_wait_reg);
+    if (matches || frame->rsp == VE_HEX_RSP_UNKNOWN || frame->rsp == VE_HEX_RSP_ERROR) {
+        data->hex_response = *frame;
+        data->hex_waiting = false;
+    }
+}
+
+// Feed received bytes, text blocks are merged into the charger data
+static void feed_parser(mppt_data_t* data, const uint8_t* bytes, int len) {
+    ve_direct_block_t block;
+    if (ve_direct_parser_feed(&data->parser, bytes, len, &block)) {
+        merge_block(&data->block, &block);
+        data->data_valid = true;
+    }
+}
+
+// Send a HEX command and wait for its response
+// (caller holds mppt_uart_mutex and the line, see uart_mux_acquire)
+static esp_err_t hex_transaction(mppt_id_t id, uint8_t cmd, const uint8_t* payload, size_t len,
+                                 uint8_t expected_rsp, uint16_t reg, ve_direct_hex_frame_t* response) {
+    mppt_data_t* data = get_mppt_data(id);
+    char command[1 + 1 + 2 * (VE_DIRECT_HEX_MAX_DATA + 1) + 1];
+    size_t command_len = ve_direct_hex_encode(cmd, payload, len, command, sizeof(command));
+    if (command_len == 0) return ESP_ERR_INVALID_SIZE;
+
+    data->hex_wait_rsp = expected_rsp;
+    data->hex_wait_reg = reg;
+    data->hex_waiting = true;
+    if (uart_mux_write(UART_MUX_MPPT(id), (const uint8_t*)command, command_len) != (int)command_len) {
+        data->hex_waiting = false;
+        return ESP_FAIL;
+    }
+
+    static uint8_t uart_data[UART_MUX_FRAME_MAX];
+    TickType_t start = xTaskGetTickCount();
+    while (data->hex_waiting && xTaskGetTickCount() - start < pdMS_TO_TICKS(MPPT_HEX_TIMEOUT_MS)) {
+        int rx_len = uart_mux_receive(UART_MUX_MPPT(id), uart_data, sizeof(uart_data), 20);
+        if (rx_len > 0) {
+            feed_parser(data, uart_data, rx_len);
+        }
+    }
+    if (data->hex_waiting) {
+        data->hex_waiting = false;
+        return ESP_ERR_TIMEOUT;
+    }
+
+    if (data->hex_response.rsp == VE_HEX_RSP_UNKNOWN || data->hex_response.rsp == VE_HEX_RSP_ERROR) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (expected_rsp == VE_HEX_RSP_GET || expected_rsp == VE_HEX_RSP_SET) {
+        uint8_t flags = ve_direct_hex_flags(&data->hex_response);
+        if (flags & (VE_HEX_FLAG_UNKNOWN_ID | VE_HEX_FLAG_NOT_SUPPORTED)) return ESP_ERR_NOT_SUPPORTED;
+        if (flags & VE_HEX_FLAG_PARAM_ERROR) return ESP_ERR_INVALID_ARG;
+    }
+    if (response) *response = data->hex_response;
+    return ESP_OK;
+}
+
+static esp_err_t hex_get_register_locked(mppt_id_t id, uint16_t reg, uint32_t* value) {
+    uint8_t payload[3] = { reg & 0xFF, reg >> 8, 0 };
+    ve_direct_hex_frame_t response;
+    esp_err_t ret = hex_transaction(id, VE_HEX_CMD_GET, payload, sizeof(payload),
+                                    VE_HEX_RSP_GET, reg, &response);
+    if (ret == ESP_OK && value) {
+        *value = ve_direct_hex_value(&response);
+    }
+    return ret;
+}
+
+// Take the parser and the line for a HEX exchange, within timeout_ms in total
+static esp_err_t hex_begin_timeout(mppt_id_t id, uint32_t timeout_ms) {
+    if (!uart_mux_has_tx(UART_MUX_MPPT(id))) return ESP_ERR_NOT_SUPPORTED;
+    TickType_t start = xTaskGetTickCount();
+    if (xSemaphoreTake(mppt_uart_mutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    uint32_t spent_ms = pdTICKS_TO_MS(xTaskGetTickCount() - start);
+    if (spent_ms >= timeout_ms) {
+        xSemaphoreGive(mppt_uart_mutex);
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t ret = uart_mux_acquire(UART_MUX_MPPT(id), timeout_ms - spent_ms);
+    if (ret != ESP_OK) {
+        xSemaphoreGive(mppt_uart_mutex);
+    }
+    return ret;
+}
+
+static esp_err_t hex_begin(mppt_id_t id) {
+    return hex_begin_timeout(id, MPPT_BLOCK_TIMEOUT_MS);
+}
+
+static void hex_end(mppt_id_t id) {
+    uart_mux_release(UART_MUX_MPPT(id));
+    xSemaphoreGive(mppt_uart_mutex);
+}
+
+esp_err_t mppt_hex_ping(mppt_id_t id, uint16_t* version) {
+    esp_err_t ret = hex_begin(id);
+    if (ret != ESP_OK) return ret;
+    ve_direct_hex_frame_t response;
+    ret = hex_transaction(id, VE_HEX_CMD_PING, NULL, 0, VE_HEX_RSP_PING, 0, &response);
+    hex_end(id);
+
+    if (ret == ESP_OK && version) {
+        *version = (response.len >= 2) ? (uint16_t)(response.data[0] | (response.data[1] << 8)) : 0;
+    }
+    return ret;
+}
+
+esp_err_t mppt_hex_get_register(mppt_id_t id, uint16_t reg, uint32_t* value) {
+    esp_err_t ret = hex_begin(id);
+    if (ret != ESP_OK) return ret;
+    ret = hex_get_register_locked(id, reg, value);
+    hex_end(id);
+    return ret;
+}
+
+esp_err_t mppt_hex_set_register(mppt_id_t id, uint16_t reg, uint32_t value, uint8_t size) {
+    if (size == 0 || size > 4) return ESP_ERR_INVALID_ARG;
+
+    uint8_t payload[3 + 4] = { reg & 0xFF, reg >> 8, 0 };
+    for (int i = 0; i < size; i++) {
+        payload[3 + i] = (value >> (8 * i)) & 0xFF;
+    }
+
+    esp_err_t ret = hex_begin(id);
+    if (ret != ESP_OK) return ret;
+    ret = hex_transaction(id, VE_HEX_CMD_SET, payload, 3 + size, VE_HEX_RSP_SET, reg, NULL);
+    hex_end(id);
+    return ret;
+}
+
 esp_err_t mppt_manager_init(void) {
     // Initialize MPPT data structures
     memset(&mppt_100_50_data, 0, sizeof(mppt_data_t));
     memset(&mppt_70_15_data, 0, sizeof(mppt_data_t));
+    ve_direct_parser_reset(&mppt_100_50_data.parser);
+    ve_direct_parser_reset(&mppt_70_15_data.parser);
+    ve_direct_parser_set_hex_handler(&mppt_100_50_data.parser, mppt_hex_frame_handler, &mppt_100_50_data);
+    ve_direct_parser_set_hex_handler(&mppt_70_15_data.parser, mppt_hex_frame_handler, &mppt_70_15_data);
+    
+    mppt_uart_mutex = xSemaphoreCreateMutex();
+    if (mppt_uart_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create MPPT UART mutex");
+        return ESP_FAIL;
+    }
     
     // Create MPPT task on CPU1 for better load balancing
     BaseType_t result = xTaskCreatePinnedToCore(
@@ -59,95 +278,80 @@ esp_err_t mppt_manager_init(void) {
     return ESP_OK;
 }
 
-static void parse_ve_direct_frame(const char *frame, mppt_data_t *data) {
-    char *line = strtok((char*)frame, "\n\r");
+// Text protocol: wait for the next block sent by the charger
+// (frames arrive whole, the multiplexer never switches in the middle of a block)
+static void read_mppt_text(mppt_id_t device, mppt_data_t *data, TickType_t deadline) {
+    static uint8_t uart_data[UART_MUX_FRAME_MAX];
+    while ((int32_t)(deadline - xTaskGetTickCount()) > 0) {
+        int len = uart_mux_receive(UART_MUX_MPPT(device), uart_data, sizeof(uart_data), 100);
+        if (len <= 0) continue;
+        
+        ESP_LOG_BUFFER_HEXDUMP(TAG, uart_data, len, ESP_LOG_DEBUG);
+        
+        feed_parser(data, uart_data, len);
+        if (data->data_valid) {
+            ESP_LOGD(TAG, "MPPT %d data: Power=%ldW, Voltage=%ldmV, Current=%ldmA, State=%ld", 
+                     device, data->block.values[VE_FIELD_PPV], data->block.values[VE_FIELD_V],
+                     data->block.values[VE_FIELD_I], data->block.values[VE_FIELD_CS]);
+            return;
+        }
+    }
     
-    while (line != NULL) {
-        if (strncmp(line, "V\t", 2) == 0) {
-            // Battery voltage in mV
-            data->battery_voltage = atof(line + 2) / 1000.0f;
-        } else if (strncmp(line, "I\t", 2) == 0) {
-            // Battery current in mA
-            data->battery_current = atof(line + 2) / 1000.0f;
-        } else if (strncmp(line, "PPV\t", 4) == 0) {
-            // Panel power in W
-            data->solar_power = atof(line + 4);
-        } else if (strncmp(line, "CS\t", 3) == 0) {
-            // Charger state
-            data->state = (uint8_t)atoi(line + 3);
-        } else if (strncmp(line, "T\t", 2) == 0) {
-            // Temperature in Celsius
-            data->temperature = (int8_t)atoi(line + 2);
-        } else if (strncmp(line, "Checksum\t", 9) == 0) {
-            // End of frame
-            data->data_valid = true;
-            break;
+    ESP_LOGW(TAG, "No valid VE.Direct block from MPPT %d (checksum errors: %" PRIu32 ")",
+             device, data->parser.checksum_errors);
+}
+
+// HEX protocol: read the registers directly instead of waiting for a block
+static bool read_mppt_hex(mppt_id_t device, mppt_data_t *data, bool with_history) {
+    for (size_t i = 0; i < sizeof(hex_poll_registers) / sizeof(hex_poll_registers[0]); i++) {
+        esp_err_t ret = hex_get_register_locked(device, hex_poll_registers[i], NULL);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "MPPT %d: Get 0x%04X failed (%s)", device, hex_poll_registers[i], esp_err_to_name(ret));
+            return false;
+        }
+    }
+    if (with_history) {
+        for (size_t i = 0; i < sizeof(hex_history_registers) / sizeof(hex_history_registers[0]); i++) {
+            hex_get_register_locked(device, hex_history_registers[i], NULL);
         }
-        
-        line = strtok(NULL, "\n\r");
     }
+    data->data_valid = true;
+    return true;
 }
 
-static void read_mppt_data(mppt_device_t device, mppt_data_t *data) {
-    static char buffer[VE_DIRECT_FRAME_SIZE];
-    static int buffer_pos = 0;
-    
-    // Switch to the desired MPPT device
-    ESP_LOGD(TAG, "Switching to MPPT device %d", device);
-    if (uart_mux_switch_mppt(device) != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to switch to MPPT device %d", device);
-        return;
+// Read one charger within MPPT_READ_BUDGET_MS (HEX and text fallback together)
+static void read_mppt_data(mppt_id_t device, mppt_data_t *data, bool with_history) {
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(MPPT_READ_BUDGET_MS);
+
+    // HEX: all the registers in one hold of the line
+    if (hex_begin_timeout(device, MPPT_READ_BUDGET_MS) == ESP_OK) {
+        bool ok = read_mppt_hex(device, data, with_history);
+        hex_end(device);
+        if (ok) return;
     }
     
-    uint8_t uart_data[64];
-    int len = uart_mux_read_mppt(uart_data, sizeof(uart_data), 1000);
-    
-    ESP_LOGD(TAG, "MPPT %d: Read %d bytes from UART", device, len);
-    
-    if (len > 0) {
-        // Log raw data for debugging
-        ESP_LOG_BUFFER_HEXDUMP(TAG, uart_data, len, ESP_LOG_DEBUG);
-        
-        for (int i = 0; i < len; i++) {
-            char c = uart_data[i];
-            
-            if (buffer_pos < VE_DIRECT_FRAME_SIZE - 1) {
-                buffer[buffer_pos++] = c;
-            }
-            
-            // Check for frame start
-            if (c == ':' && buffer_pos > 1) {
-                // Found start of new frame, reset buffer
-                buffer[0] = ':';
-                buffer_pos = 1;
-            }
-            
-            // Check for checksum line (end of frame)
-            if (strstr(buffer, "Checksum") != NULL) {
-                buffer[buffer_pos] = '\0';
-                parse_ve_direct_frame(buffer, data);
-                buffer_pos = 0;
-                ESP_LOGD(TAG, "MPPT %d data: Power=%.1fW, Voltage=%.2fV, Current=%.2fA, Temp=%d°C", 
-                         device, data->solar_power, data->battery_voltage, data->battery_current, data->temperature);
-                break;
-            }
-        }
-    } else {
-        ESP_LOGW(TAG, "No data received from MPPT %d", device);
-        data->data_valid = false;
+    // Fall back to the text protocol (no TX line, or the charger does not answer)
+    int32_t remaining = (int32_t)(deadline - xTaskGetTickCount());
+    if (remaining <= 0 || xSemaphoreTake(mppt_uart_mutex, (TickType_t)remaining) != pdTRUE) {
+        ESP_LOGW(TAG, "MPPT parser busy, skipping MPPT %d", device);
+        return;
     }
+    read_mppt_text(device, data, deadline);
+    xSemaphoreGive(mppt_uart_mutex);
 }
 
 void mppt_manager_task(void *parameters) {
     ESP_LOGI(TAG, "MPPT manager task started");
     
     TickType_t last_wake_time = xTaskGetTickCount();
+    uint32_t cycle = 0;
     
     while (1) {
         // Read data from both MPPTs using multiplexer
-        read_mppt_data(MPPT_100_50, &mppt_100_50_data);
-        vTaskDelay(pdMS_TO_TICKS(100)); // Small delay between reads
-        read_mppt_data(MPPT_70_15, &mppt_70_15_data);
+        bool with_history = (cycle++ % MPPT_HEX_HISTORY_CYCLES) == 0;
+        read_mppt_data(MPPT_100_50, &mppt_100_50_data, with_history);
+        vTaskDelay(pdMS_TO_TICKS(MPPT_READ_GAP_MS)); // Small delay between reads
+        read_mppt_data(MPPT_70_15, &mppt_70_15_data, with_history);
         
         // Check for communication errors
         static uint32_t last_100_50_update = 0;
@@ -166,67 +370,53 @@ void mppt_manager_task(void *parameters) {
         
         // Check for communication timeout (30 seconds)
         if (current_time - last_100_50_update > 30000) {
-            // uint32_t error = ERROR_MPPT_COMM;
-            uint32_t error = 0;
-
+            ESP_LOGW(TAG, "MPPT 100|50: no valid block for 30s");
             // comm_send_message(COMM_MSG_ERROR, &error, sizeof(uint32_t));
         }
         
         if (current_time - last_70_15_update > 30000) {
-            // uint32_t error = ERROR_MPPT_COMM;
-            uint32_t error = 0;
-
+            ESP_LOGW(TAG, "MPPT 70|15: no valid block for 30s");
             // comm_send_message(COMM_MSG_ERROR, &error, sizeof(uint32_t));
         }
         
-        // Prepare MPPT data for communication manager
-        struct {
-            float solar_power_100_50;
-            float battery_voltage_100_50;
-            float battery_current_100_50;
-            int8_t temperature_100_50;
-            uint8_t state_100_50;
-            
-            float solar_power_70_15;
-            float battery_voltage_70_15;
-            float battery_current_70_15;
-            int8_t temperature_70_15;
-            uint8_t state_70_15;
-        } mppt_data = {
-            .solar_power_100_50 = mppt_100_50_data.solar_power,
-            .battery_voltage_100_50 = mppt_100_50_data.battery_voltage,
-            .battery_current_100_50 = mppt_100_50_data.battery_current,
-            .temperature_100_50 = mppt_100_50_data.temperature,
-            .state_100_50 = mppt_100_50_data.state,
-            
-            .solar_power_70_15 = mppt_70_15_data.solar_power,
-            .battery_voltage_70_15 = mppt_70_15_data.battery_voltage,
-            .battery_current_70_15 = mppt_70_15_data.battery_current,
-            .temperature_70_15 = mppt_70_15_data.temperature,
-            .state_70_15 = mppt_70_15_data.state
-        };
-        
-        // Send MPPT data to communication manager
-        // comm_send_message(COMM_MSG_MPPT_UPDATE, &mppt_data, sizeof(mppt_data));
+        ESP_LOGD(TAG, "MPPT 100|50: %ldW, %ldmV, %ldmA, State:%ld (blocks ok:%lu, bad:%lu)", 
+                mppt_100_50_data.block.values[VE_FIELD_PPV], mppt_100_50_data.block.values[VE_FIELD_V], 
+                mppt_100_50_data.block.values[VE_FIELD_I], mppt_100_50_data.block.values[VE_FIELD_CS],
+                mppt_100_50_data.parser.blocks_ok, mppt_100_50_data.parser.checksum_errors);
         
-        ESP_LOGD(TAG, "MPPT 100|50: %.1fW, %.2fV, %.2fA, %d°C, State:%d", 
-                mppt_100_50_data.solar_power, mppt_100_50_data.battery_voltage, 
-                mppt_100_50_data.battery_current, mppt_100_50_data.temperature, mppt_100_50_data.state);
-        
-        ESP_LOGD(TAG, "MPPT 70|15: %.1fW, %.2fV, %.2fA, %d°C, State:%d", 
-                mppt_70_15_data.solar_power, mppt_70_15_data.battery_voltage, 
-                mppt_70_15_data.battery_current, mppt_70_15_data.temperature, mppt_70_15_data.state);
+        ESP_LOGD(TAG, "MPPT 70|15: %ldW, %ldmV, %ldmA, State:%ld (blocks ok:%lu, bad:%lu)", 
+                mppt_70_15_data.block.values[VE_FIELD_PPV], mppt_70_15_data.block.values[VE_FIELD_V], 
+                mppt_70_15_data.block.values[VE_FIELD_I], mppt_70_15_data.block.values[VE_FIELD_CS],
+                mppt_70_15_data.parser.blocks_ok, mppt_70_15_data.parser.checksum_errors);
         
         vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(MPPT_UPDATE_INTERVAL_MS));
     }
 }
 
+#if !SIMULATE_MPPT_DATA
+// Copy a VE.Direct block (fixed point) into the van_state units
+static void fill_mppt_state(const ve_direct_block_t* block, float* solar_power, float* panel_voltage,
+                            float* panel_current, float* battery_voltage, float* battery_current,
+                            int8_t* temperature, charge_state_t* state, uint16_t* error_flags) {
+    *solar_power = (float)block->values[VE_FIELD_PPV];
+    *panel_voltage = block->values[VE_FIELD_VPV] / 1000.0f;
+    // Panel current is not sent, derive it from PPV and VPV
+    *panel_current = (block->values[VE_FIELD_VPV] > 0) ?
+                     (float)block->values[VE_FIELD_PPV] * 1000.0f / block->values[VE_FIELD_VPV] : 0.0f;
+    *battery_voltage = block->values[VE_FIELD_V] / 1000.0f;
+    *battery_current = block->values[VE_FIELD_I] / 1000.0f;
+    *temperature = (int8_t)block->values[VE_FIELD_T];
+    *state = (charge_state_t)block->values[VE_FIELD_CS];
+    *error_flags = (uint16_t)block->values[VE_FIELD_ERR];
+}
+#endif
+
 esp_err_t mppt_manager_update_van_state(van_state_t* van_state) {
     if (!van_state) {
         return ESP_ERR_INVALID_ARG;
     }
     
-#ifdef SIMULATE_MPPT_DATA
+#if SIMULATE_MPPT_DATA
     // ========== SIMULATION DES DONNÉES MPPT ==========
     // Use shared simulation context for coherent time and day cycle
     energy_simulation_context_t* sim_ctx = energy_simulation_get_context();
@@ -337,24 +527,18 @@ esp_err_t mppt_manager_update_van_state(van_state_t* van_state) {
     
 #else
     // ========== DONNÉES RÉELLES DES MPPT ==========
-    // Utiliser les données lues par mppt_manager_task
-    van_state->mppt.solar_power_100_50 = mppt_100_50_data.solar_power;
-    van_state->mppt.panel_voltage_100_50 = 0.0f;  // TODO: extraire du VE.Direct
-    van_state->mppt.panel_current_100_50 = 0.0f;  // TODO: extraire du VE.Direct
-    van_state->mppt.battery_voltage_100_50 = mppt_100_50_data.battery_voltage;
-    van_state->mppt.battery_current_100_50 = mppt_100_50_data.battery_current;
-    van_state->mppt.temperature_100_50 = mppt_100_50_data.temperature;
-    van_state->mppt.state_100_50 = mppt_100_50_data.state;
-    van_state->mppt.error_flags_100_50 = 0;  // TODO: gérer les erreurs
-    
-    van_state->mppt.solar_power_70_15 = mppt_70_15_data.solar_power;
-    van_state->mppt.panel_voltage_70_15 = 0.0f;  // TODO: extraire du VE.Direct
-    van_state->mppt.panel_current_70_15 = 0.0f;  // TODO: extraire du VE.Direct
-    van_state->mppt.battery_voltage_70_15 = mppt_70_15_data.battery_voltage;
-    van_state->mppt.battery_current_70_15 = mppt_70_15_data.battery_current;
-    van_state->mppt.temperature_70_15 = mppt_70_15_data.temperature;
-    van_state->mppt.state_70_15 = mppt_70_15_data.state;
-    van_state->mppt.error_flags_70_15 = 0;  // TODO: gérer les erreurs
+    // Utiliser les derniers blocs VE.Direct valides lus par mppt_manager_task
+    fill_mppt_state(&mppt_100_50_data.block,
+                    &van_state->mppt.solar_power_100_50, &van_state->mppt.panel_voltage_100_50,
+                    &van_state->mppt.panel_current_100_50, &van_state->mppt.battery_voltage_100_50,
+                    &van_state->mppt.battery_current_100_50, &van_state->mppt.temperature_100_50,
+                    &van_state->mppt.state_100_50, &van_state->mppt.error_flags_100_50);
+    
+    fill_mppt_state(&mppt_70_15_data.block,
+                    &van_state->mppt.solar_power_70_15, &van_state->mppt.panel_voltage_70_15,
+                    &van_state->mppt.panel_current_70_15, &van_state->mppt.battery_voltage_70_15,
+                    &van_state->mppt.battery_current_70_15, &van_state->mppt.temperature_70_15,
+                    &van_state->mppt.state_70_15, &van_state->mppt.error_flags_70_15);
 #endif
     
     return ESP_OK;
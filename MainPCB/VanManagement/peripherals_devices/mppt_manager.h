@@ -6,7 +6,13 @@
 
 #define MPPT_UPDATE_INTERVAL_MS 2000
 #define MPPT_UART_BUFFER_SIZE 512
-#define VE_DIRECT_FRAME_SIZE 256
+#define MPPT_BLOCK_TIMEOUT_MS 3000  // HEX commands of the API: one round of the UART1 time slices (+ time to receive a block)
+#define MPPT_READ_GAP_MS 100        // Pause between the two chargers of a cycle
+// Wait per charger in the periodic task: both chargers fit in one period.
+// A block missed in this cycle stays in the multiplexer buffer for the next one.
+#define MPPT_READ_BUDGET_MS ((MPPT_UPDATE_INTERVAL_MS - MPPT_READ_GAP_MS) / 2)
+#define MPPT_HEX_TIMEOUT_MS 100     // Response time of a HEX command
+#define MPPT_HEX_HISTORY_CYCLES 30  // Yield/max power registers are read once per minute
 
 typedef enum {
     MPPT_100_50 = 0,
@@ -23,4 +29,27 @@ void mppt_manager_task(void *parameters);
  */
 esp_err_t mppt_manager_update_van_state(van_state_t* van_state);
 
+// VE.Direct HEX access. Needs a TX line to the charger (VE_DIRECT_TXx),
+// otherwise return ESP_ERR_NOT_SUPPORTED.
+
+/**
+ * @brief Ping a charger
+ * @param version Receives the firmware version (may be NULL)
+ * @return ESP_OK, ESP_ERR_TIMEOUT if no answer, ESP_ERR_NOT_SUPPORTED without TX
+ */
+esp_err_t mppt_hex_ping(mppt_id_t id, uint16_t* version);
+
+/**
+ * @brief Read a register (VE_REG_*), raw value in the register unit
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if unknown register or no TX, ESP_ERR_TIMEOUT
+ */
+esp_err_t mppt_hex_get_register(mppt_id_t id, uint16_t reg, uint32_t* value);
+
+/**
+ * @brief Write a register
+ * @param size Size of the register value in bytes (1 to 4)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if the value is rejected, ESP_ERR_NOT_SUPPORTED, ESP_ERR_TIMEOUT
+ */
+esp_err_t mppt_hex_set_register(mppt_id_t id, uint16_t reg, uint32_t value, uint8_t size);
+
 #endif // MPPT_MANAGER_H
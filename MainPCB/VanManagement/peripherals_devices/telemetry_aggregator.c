@@ -0,0 +1,280 @@
+#include "telemetry_aggregator.h"
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "TELEMETRY";
+
+static const char *metric_names[TELEMETRY_METRIC_COUNT] = {
+    "Solar W", "Battery A", "Discharge A", "Battery V",
+    "Tank A L", "Tank B L", "Tank C L", "Tank D L", "Tank E L",
+};
+
+#define MINUTE_US   (60LL * 1000000LL)
+
+// Bucket being filled (sum instead of mean)
+typedef struct {
+    float min, max, sum, integral, first, last;
+    uint16_t samples;
+} telemetry_acc_t;
+
+typedef struct {
+    telemetry_acc_t current;
+    telemetry_window_t minutes[TELEMETRY_1M_HISTORY];       // Ring, newest at minute_head
+    telemetry_window_t quarters[TELEMETRY_15M_HISTORY];     // Ring, newest at quarter_head
+    telemetry_window_t window_15m;                          // Sliding, updated each minute
+} telemetry_series_t;
+
+static telemetry_series_t series[TELEMETRY_METRIC_COUNT];
+static portMUX_TYPE telemetry_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int64_t minute_start_us;
+static int64_t last_sample_us;
+static uint16_t minute_head;
+static uint16_t minutes_filled;         // Closed minutes, up to TELEMETRY_1M_HISTORY
+static uint16_t quarter_head;
+static uint16_t quarters_filled;
+static uint8_t minutes_in_quarter;
+static uint32_t minute_count;          // Minutes closed since boot
+
+// Merge scratch of the update task (only writer of the rings)
+static telemetry_window_t minutes_copy[TELEMETRY_METRIC_COUNT][TELEMETRY_1M_HISTORY];
+static telemetry_window_t merged_15m[TELEMETRY_METRIC_COUNT];
+
+static void acc_reset(telemetry_acc_t *acc) {
+    memset(acc, 0, sizeof(*acc));
+}
+
+static inline void acc_add(telemetry_acc_t *acc, float value, float dt_h) {
+    if (acc->samples == 0) {
+        acc->min = value;
+        acc->max = value;
+        acc->first = value;
+    } else {
+        if (value < acc->min) acc->min = value;
+        if (value > acc->max) acc->max = value;
+    }
+    acc->sum += value;
+    acc->integral += value * dt_h;
+    acc->last = value;
+    acc->samples++;
+}
+
+// Merge count buckets of a ring, oldest first (newest at head)
+static void merge_ring(const telemetry_window_t *ring, uint16_t size, uint16_t head, uint16_t count,
+                       telemetry_window_t *out) {
+    memset(out, 0, sizeof(*out));
+    float weighted = 0;
+    bool any = false;
+
+    for (uint16_t i = count; i-- > 0; ) {
+        const telemetry_window_t *w = &ring[(head + size - i) % size];
+        if (w->samples == 0) continue;
+        if (!any) {
+            out->min = w->min;
+            out->max = w->max;
+            out->first = w->first;
+            any = true;
+        } else {
+            if (w->min < out->min) out->min = w->min;
+            if (w->max > out->max) out->max = w->max;
+        }
+        weighted += w->mean * w->samples;
+        out->integral += w->integral;
+        out->last = w->last;
+        out->samples += w->samples;
+    }
+    if (out->samples > 0) {
+        out->mean = weighted / out->samples;
+    }
+}
+
+// Close the current minute of every metric (telemetry_lock held, bounded copies)
+// and copy the minute rings out for the merge done after the lock is released
+static bool close_minute(void) {
+    minute_count++;
+    minute_head = (minute_head + 1) % TELEMETRY_1M_HISTORY;
+    if (minutes_filled < TELEMETRY_1M_HISTORY) minutes_filled++;
+    minutes_in_quarter++;
+    bool quarter_done = minutes_in_quarter >= TELEMETRY_1M_HISTORY;
+    if (quarter_done) {
+        minutes_in_quarter = 0;
+    }
+
+    for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++) {
+        telemetry_series_t *s = &series[m];
+        const telemetry_acc_t *acc = &s->current;
+        telemetry_window_t *w = &s->minutes[minute_head];
+
+        w->min = acc->min;
+        w->max = acc->max;
+        w->mean = (acc->samples > 0) ? acc->sum / acc->samples : 0;
+        w->integral = acc->integral;
+        w->first = acc->first;
+        w->last = acc->last;
+        w->samples = acc->samples;
+        acc_reset(&s->current);
+
+        memcpy(minutes_copy[m], s->minutes, sizeof(s->minutes));
+    }
+    return quarter_done;
+}
+
+// Sliding 15 min windows from the copied rings (no lock: interrupts stay enabled)
+static void merge_minutes(uint16_t head, uint16_t filled) {
+    for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++) {
+        merge_ring(minutes_copy[m], TELEMETRY_1M_HISTORY, head, filled, &merged_15m[m]);
+    }
+}
+
+// Publish the merged windows (telemetry_lock held). A closed quarter is
+// written and its ring slot advanced together, so readers never see the new
+// head before its bucket
+static void publish_15m(bool quarter_done) {
+    uint16_t head = quarter_head;
+    if (quarter_done) {
+        head = (quarter_head + 1) % TELEMETRY_15M_HISTORY;
+    }
+    for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++) {
+        series[m].window_15m = merged_15m[m];
+        if (quarter_done) {
+            series[m].quarters[head] = merged_15m[m];
+        }
+    }
+    if (quarter_done) {
+        quarter_head = head;
+        if (quarters_filled < TELEMETRY_15M_HISTORY) quarters_filled++;
+    }
+}
+
+static void add_sample(telemetry_metric_t metric, float value, float dt_h) {
+    acc_add(&series[metric].current, value, dt_h);
+}
+
+esp_err_t telemetry_aggregator_init(void) {
+    portENTER_CRITICAL(&telemetry_lock);
+    memset(series, 0, sizeof(series));
+    minute_start_us = esp_timer_get_time();
+    last_sample_us = minute_start_us;
+    minute_head = 0;
+    minutes_filled = 0;
+    quarter_head = 0;
+    quarters_filled = 0;
+    minutes_in_quarter = 0;
+    portEXIT_CRITICAL(&telemetry_lock);
+    ESP_LOGI(TAG, "Telemetry aggregator initialized (%d metrics)", TELEMETRY_METRIC_COUNT);
+    return ESP_OK;
+}
+
+esp_err_t telemetry_aggregator_update_van_state(van_state_t* van_state) {
+    if (!van_state) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+    float dt_s = (now - last_sample_us) / 1e6f;
+    if (dt_s > TELEMETRY_MAX_DT_S) dt_s = TELEMETRY_MAX_DT_S;
+    float dt_h = dt_s / 3600.0f;
+    last_sample_us = now;
+
+    float battery_a = van_state->battery.current_ma / 1000.0f;
+    const water_tanks_levels_t *tanks = &van_state->slave_pcb.tanks_levels;
+
+    if (now - minute_start_us >= MINUTE_US) {
+        portENTER_CRITICAL(&telemetry_lock);
+        bool quarter_done = close_minute();
+        uint16_t head = minute_head;
+        uint16_t filled = minutes_filled;
+        portEXIT_CRITICAL(&telemetry_lock);
+
+        merge_minutes(head, filled);
+
+        portENTER_CRITICAL(&telemetry_lock);
+        publish_15m(quarter_done);
+        portEXIT_CRITICAL(&telemetry_lock);
+        minute_start_us = now;
+    }
+
+    portENTER_CRITICAL(&telemetry_lock);
+    add_sample(TELEMETRY_SOLAR_POWER, van_state->mppt.solar_power_100_50 + van_state->mppt.solar_power_70_15, dt_h);
+    add_sample(TELEMETRY_BATTERY_CURRENT, battery_a, dt_h);
+    add_sample(TELEMETRY_BATTERY_DISCHARGE, (battery_a < 0) ? -battery_a : 0, dt_h);
+    add_sample(TELEMETRY_BATTERY_VOLTAGE, van_state->battery.voltage_mv / 1000.0f, dt_h);
+    add_sample(TELEMETRY_TANK_A, tanks->tank_a.volume_liters, dt_h);
+    add_sample(TELEMETRY_TANK_B, tanks->tank_b.volume_liters, dt_h);
+    add_sample(TELEMETRY_TANK_C, tanks->tank_c.volume_liters, dt_h);
+    add_sample(TELEMETRY_TANK_D, tanks->tank_d.volume_liters, dt_h);
+    add_sample(TELEMETRY_TANK_E, tanks->tank_e.volume_liters, dt_h);
+
+    // Trends reported to the app (last closed minute, last 15 closed minutes)
+    if (minutes_filled > 0) {
+        const telemetry_window_t *solar_1m = &series[TELEMETRY_SOLAR_POWER].minutes[minute_head];
+        van_state->trends.solar_wh_1m = solar_1m->integral;
+        van_state->trends.solar_wh_15m = series[TELEMETRY_SOLAR_POWER].window_15m.integral;
+        van_state->trends.battery_ah_15m = series[TELEMETRY_BATTERY_CURRENT].window_15m.integral;
+        van_state->trends.consumption_ah_15m = series[TELEMETRY_BATTERY_DISCHARGE].window_15m.integral;
+        van_state->trends.battery_voltage_min_15m = series[TELEMETRY_BATTERY_VOLTAGE].window_15m.min;
+
+        float hours = minutes_filled / 60.0f;
+        for (int t = 0; t < 5; t++) {
+            const telemetry_window_t *w = &series[TELEMETRY_TANK_A + t].window_15m;
+            van_state->trends.tank_rate_lph[t] = (w->samples > 0) ? (w->last - w->first) / hours : 0;
+        }
+    }
+    portEXIT_CRITICAL(&telemetry_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t telemetry_get_bucket(telemetry_metric_t metric, telemetry_resolution_t resolution,
+                               uint16_t age, telemetry_window_t* window) {
+    if (metric >= TELEMETRY_METRIC_COUNT || !window) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&telemetry_lock);
+    if (resolution == TELEMETRY_RES_1M && age < minutes_filled) {
+        *window = series[metric].minutes[(minute_head + TELEMETRY_1M_HISTORY - age) % TELEMETRY_1M_HISTORY];
+    } else if (resolution == TELEMETRY_RES_15M && age < quarters_filled) {
+        *window = series[metric].quarters[(quarter_head + TELEMETRY_15M_HISTORY - age) % TELEMETRY_15M_HISTORY];
+    } else {
+        ret = ESP_ERR_NOT_FOUND;
+    }
+    portEXIT_CRITICAL(&telemetry_lock);
+    return ret;
+}
+
+uint32_t telemetry_aggregator_minute_count(void) {
+    portENTER_CRITICAL(&telemetry_lock);
+    uint32_t count = minute_count;
+    portEXIT_CRITICAL(&telemetry_lock);
+    return count;
+}
+
+esp_err_t telemetry_get_15m_window(telemetry_metric_t metric, telemetry_window_t* window) {
+    if (metric >= TELEMETRY_METRIC_COUNT || !window) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&telemetry_lock);
+    bool ready = minutes_filled > 0;
+    *window = series[metric].window_15m;
+    portEXIT_CRITICAL(&telemetry_lock);
+    return ready ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void telemetry_aggregator_print_summary(void) {
+    ESP_LOGI(TAG, "Metric        | 1 min: min / mean / max / integral | 15 min: min / mean / max / integral");
+    for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++) {
+        telemetry_window_t w1, w15;
+        if (telemetry_get_bucket(m, TELEMETRY_RES_1M, 0, &w1) != ESP_OK ||
+            telemetry_get_15m_window(m, &w15) != ESP_OK) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%-13s | %.2f / %.2f / %.2f / %.3f | %.2f / %.2f / %.2f / %.3f", metric_names[m],
+                 w1.min, w1.mean, w1.max, w1.integral, w15.min, w15.mean, w15.max, w15.integral);
+    }
+}
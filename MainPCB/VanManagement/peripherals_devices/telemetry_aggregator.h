@@ -0,0 +1,77 @@
+#ifndef TELEMETRY_AGGREGATOR_H
+#define TELEMETRY_AGGREGATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "../communications/protocol.h"
+
+// Rolling aggregates of the van state, fixed memory.
+// Each update adds one sample to the current 1-minute bucket of every metric
+// (constant time). Closed minutes go to a ring of the last 15, which gives
+// the sliding 15-minute window. Every 15 minutes they are merged into a
+// 15-minute bucket, kept for TELEMETRY_15M_HISTORY periods.
+
+#define TELEMETRY_1M_HISTORY    15      // 1-minute buckets (one 15-minute window)
+#define TELEMETRY_15M_HISTORY   16      // 15-minute buckets (4 h)
+#define TELEMETRY_MAX_DT_S      5       // Longer gaps between updates count as this
+
+typedef enum {
+    TELEMETRY_SOLAR_POWER = 0,          // W, both MPPTs
+    TELEMETRY_BATTERY_CURRENT,          // A, <0 = discharge
+    TELEMETRY_BATTERY_DISCHARGE,        // A, discharge only (consumption)
+    TELEMETRY_BATTERY_VOLTAGE,          // V
+    TELEMETRY_TANK_A,                   // L, tanks A to E
+    TELEMETRY_TANK_B,
+    TELEMETRY_TANK_C,
+    TELEMETRY_TANK_D,
+    TELEMETRY_TANK_E,
+    TELEMETRY_METRIC_COUNT
+} telemetry_metric_t;
+
+typedef enum {
+    TELEMETRY_RES_1M,
+    TELEMETRY_RES_15M,
+} telemetry_resolution_t;
+
+// Aggregate of a metric over a period
+typedef struct {
+    float min;
+    float max;
+    float mean;
+    float integral;                     // Unit x hours (W -> Wh, A -> Ah)
+    float first;                        // First and last samples
+    float last;
+    uint16_t samples;
+} telemetry_window_t;
+
+esp_err_t telemetry_aggregator_init(void);
+
+/**
+ * @brief Sample van_state and fill van_state->trends
+ *
+ * Call last in the update cycle, once the managers have updated van_state.
+ */
+esp_err_t telemetry_aggregator_update_van_state(van_state_t* van_state);
+
+/**
+ * @brief Get a closed bucket
+ * @param age 0 = most recent (up to TELEMETRY_1M_HISTORY or TELEMETRY_15M_HISTORY - 1)
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if that bucket is not complete yet
+ */
+esp_err_t telemetry_get_bucket(telemetry_metric_t metric, telemetry_resolution_t resolution,
+                               uint16_t age, telemetry_window_t* window);
+
+/**
+ * @brief Get the sliding window of the last 15 closed minutes
+ * @return ESP_OK, ESP_ERR_NOT_FOUND before the first minute
+ */
+esp_err_t telemetry_get_15m_window(telemetry_metric_t metric, telemetry_window_t* window);
+
+// Number of minutes closed since boot (changes when a new 1-minute bucket is ready)
+uint32_t telemetry_aggregator_minute_count(void);
+
+// Print the 1-minute and 15-minute windows of every metric (debug)
+void telemetry_aggregator_print_summary(void);
+
+#endif // TELEMETRY_AGGREGATOR_H
@@ -0,0 +1,561 @@
+#include "telemetry_log.h"
+#include "telemetry_aggregator.h"
+#include "van_clock.h"
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "TELEMETRY_LOG";
+
+#define HEADER_SIZE         sizeof(telemetry_log_sector_header_t)
+#define ERASED_TIME         0xFFFFFFFFUL
+#define MINUTE_STAGE        16      // Rollups staged between two writes
+#define HOUR_STAGE          4
+
+typedef struct {
+    const char *name;
+    uint16_t first_sector;          // In the partition
+    uint16_t sector_count;
+    uint8_t record_size;
+    uint16_t per_sector;
+
+    // Write position (write_mutex)
+    uint16_t sector;
+    uint16_t used;                  // Records in the current sector
+    uint32_t sector_seq;
+    bool open;                      // Current sector erased with its header
+
+    // Staging (stage_lock)
+    uint8_t *stage;
+    uint16_t stage_len;
+    uint16_t stage_cap;
+    uint32_t dropped;
+} log_tier_t;
+
+static uint8_t raw_stage[(TELEMETRY_LOG_SECTOR_SIZE - HEADER_SIZE) / sizeof(telemetry_log_raw_t) * sizeof(telemetry_log_raw_t)];
+static uint8_t minute_stage[MINUTE_STAGE * sizeof(telemetry_log_rollup_t)];
+static uint8_t hour_stage[HOUR_STAGE * sizeof(telemetry_log_rollup_t)];
+static uint8_t write_buf[TELEMETRY_LOG_SECTOR_SIZE];
+
+// Latest record time of each sector of the partition (write_mutex), 0 if it
+// holds no record. Seek picks its sector here instead of reading the flash.
+#define PARTITION_SECTORS   (TELEMETRY_LOG_RAW_SECTORS + TELEMETRY_LOG_MINUTE_SECTORS + TELEMETRY_LOG_HOUR_SECTORS)
+static uint32_t sector_max_time[PARTITION_SECTORS];
+
+static log_tier_t tiers[TELEMETRY_LOG_TIER_COUNT] = {
+    [TELEMETRY_LOG_RAW] = {
+        .name = "raw", .first_sector = 0, .sector_count = TELEMETRY_LOG_RAW_SECTORS,
+        .record_size = sizeof(telemetry_log_raw_t), .stage = raw_stage, .stage_cap = sizeof(raw_stage),
+    },
+    [TELEMETRY_LOG_MINUTE] = {
+        .name = "minute", .first_sector = TELEMETRY_LOG_RAW_SECTORS, .sector_count = TELEMETRY_LOG_MINUTE_SECTORS,
+        .record_size = sizeof(telemetry_log_rollup_t), .stage = minute_stage, .stage_cap = sizeof(minute_stage),
+    },
+    [TELEMETRY_LOG_HOUR] = {
+        .name = "hour", .first_sector = TELEMETRY_LOG_RAW_SECTORS + TELEMETRY_LOG_MINUTE_SECTORS,
+        .sector_count = TELEMETRY_LOG_HOUR_SECTORS,
+        .record_size = sizeof(telemetry_log_rollup_t), .stage = hour_stage, .stage_cap = sizeof(hour_stage),
+    },
+};
+
+static const esp_partition_t *partition = NULL;
+static SemaphoreHandle_t write_mutex = NULL;
+static portMUX_TYPE stage_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t writer_task_handle = NULL;
+static uint32_t next_seq = 1;
+
+// Rollup state (update path only)
+static uint32_t last_minute_count = 0;
+static uint32_t minute_start_time = 0;
+static telemetry_log_rollup_t hour_acc;
+static int64_t hour_current_sum = 0;    // Sample-weighted sums for the hour means
+static int64_t hour_solar_sum = 0;
+static uint8_t hour_minutes = 0;
+
+static inline uint32_t sector_addr(const log_tier_t *t, uint16_t sector) {
+    return (uint32_t)(t->first_sector + sector) * TELEMETRY_LOG_SECTOR_SIZE;
+}
+
+static inline uint32_t record_addr(const log_tier_t *t, uint16_t sector, uint16_t index) {
+    return sector_addr(t, sector) + HEADER_SIZE + (uint32_t)index * t->record_size;
+}
+
+// Sequence of a valid sector of the tier, 0 if erased or foreign
+static uint32_t read_sector_seq(telemetry_log_tier_t tier, uint16_t sector) {
+    const log_tier_t *t = &tiers[tier];
+    telemetry_log_sector_header_t header;
+    if (esp_partition_read(partition, sector_addr(t, sector), &header, sizeof(header)) != ESP_OK) {
+        return 0;
+    }
+    if (header.magic != TELEMETRY_LOG_MAGIC || header.tier != tier || header.record_size != t->record_size ||
+        header.seq == ERASED_TIME) {
+        return 0;
+    }
+    return header.seq;
+}
+
+static uint32_t read_record_time(const log_tier_t *t, uint16_t sector, uint16_t index) {
+    uint32_t time = ERASED_TIME;
+    esp_partition_read(partition, record_addr(t, sector, index), &time, sizeof(time));
+    return time;
+}
+
+// Find the newest sector of a tier and the number of records it holds
+static void recover_tier(telemetry_log_tier_t tier) {
+    log_tier_t *t = &tiers[tier];
+    t->per_sector = (TELEMETRY_LOG_SECTOR_SIZE - HEADER_SIZE) / t->record_size;
+    t->sector = 0;
+    t->used = 0;
+    t->open = false;
+    t->sector_seq = 0;
+
+    for (uint16_t s = 0; s < t->sector_count; s++) {
+        uint32_t seq = read_sector_seq(tier, s);
+        sector_max_time[t->first_sector + s] = 0;
+        if (seq == 0) {
+            continue;
+        }
+        if (seq > t->sector_seq) {
+            t->sector_seq = seq;
+            t->sector = s;
+        }
+        // Last record of a full sector: the latest time unless the clock was
+        // set back while the sector was written
+        uint32_t time = read_record_time(t, s, t->per_sector - 1);
+        sector_max_time[t->first_sector + s] = (time != ERASED_TIME) ? time : 0;
+    }
+    if (t->sector_seq == 0) {
+        return;                     // Empty tier
+    }
+
+    t->open = true;
+    if (t->sector_seq >= next_seq) next_seq = t->sector_seq + 1;
+    // Records up to the first erased one (binary search: appends are contiguous)
+    uint16_t low = 0, high = t->per_sector;
+    while (low < high) {
+        uint16_t mid = (low + high) / 2;
+        if (read_record_time(t, t->sector, mid) == ERASED_TIME) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    t->used = low;
+    uint32_t time = (low > 0) ? read_record_time(t, t->sector, low - 1) : ERASED_TIME;
+    sector_max_time[t->first_sector + t->sector] = (time != ERASED_TIME) ? time : 0;
+}
+
+// Erase the next sector of the ring and write its header (write_mutex held)
+static esp_err_t open_next_sector(telemetry_log_tier_t tier) {
+    log_tier_t *t = &tiers[tier];
+    if (t->open) {
+        t->sector = (t->sector + 1) % t->sector_count;
+    }
+
+    esp_err_t ret = esp_partition_erase_range(partition, sector_addr(t, t->sector), TELEMETRY_LOG_SECTOR_SIZE);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    telemetry_log_sector_header_t header = {
+        .magic = TELEMETRY_LOG_MAGIC,
+        .seq = next_seq++,
+        .tier = tier,
+        .record_size = t->record_size,
+    };
+    ret = esp_partition_write(partition, sector_addr(t, t->sector), &header, sizeof(header));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    t->sector_seq = header.seq;
+    t->used = 0;
+    t->open = true;
+    sector_max_time[t->first_sector + t->sector] = 0;
+    return ESP_OK;
+}
+
+// Append records to the ring, one write per sector touched (write_mutex held)
+static esp_err_t append_records(telemetry_log_tier_t tier, const uint8_t *data, size_t count) {
+    log_tier_t *t = &tiers[tier];
+    while (count > 0) {
+        if (!t->open || t->used >= t->per_sector) {
+            esp_err_t ret = open_next_sector(tier);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+        }
+        size_t room = t->per_sector - t->used;
+        size_t n = (count < room) ? count : room;
+        esp_err_t ret = esp_partition_write(partition, record_addr(t, t->sector, t->used), data, n * t->record_size);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        uint32_t *max_time = &sector_max_time[t->first_sector + t->sector];
+        for (size_t i = 0; i < n; i++) {
+            uint32_t time;
+            memcpy(&time, &data[i * t->record_size], sizeof(time));
+            if (time != ERASED_TIME && time > *max_time) *max_time = time;
+        }
+        t->used += n;
+        data += n * t->record_size;
+        count -= n;
+    }
+    return ESP_OK;
+}
+
+static void stage_record(telemetry_log_tier_t tier, const void *record) {
+    log_tier_t *t = &tiers[tier];
+    bool full;
+
+    portENTER_CRITICAL(&stage_lock);
+    if (t->stage_len + t->record_size <= t->stage_cap) {
+        memcpy(&t->stage[t->stage_len], record, t->record_size);
+        t->stage_len += t->record_size;
+    } else {
+        t->dropped++;               // Writer late (flash error?)
+    }
+    full = t->stage_len + t->record_size > t->stage_cap;
+    portEXIT_CRITICAL(&stage_lock);
+
+    if (full && writer_task_handle) {
+        xTaskNotifyGive(writer_task_handle);
+    }
+}
+
+esp_err_t telemetry_log_flush(void) {
+    if (!partition) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t result = ESP_OK;
+    xSemaphoreTake(write_mutex, portMAX_DELAY);
+    for (int tier = 0; tier < TELEMETRY_LOG_TIER_COUNT; tier++) {
+        log_tier_t *t = &tiers[tier];
+
+        portENTER_CRITICAL(&stage_lock);
+        uint16_t len = t->stage_len;
+        memcpy(write_buf, t->stage, len);
+        t->stage_len = 0;
+        portEXIT_CRITICAL(&stage_lock);
+
+        if (len == 0) continue;
+        esp_err_t ret = append_records(tier, write_buf, len / t->record_size);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to write %s records: %s", t->name, esp_err_to_name(ret));
+            result = ret;
+        }
+    }
+    xSemaphoreGive(write_mutex);
+    return result;
+}
+
+static void telemetry_log_writer_task(void *pv) {
+    (void) pv;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        telemetry_log_flush();
+    }
+}
+
+// ============================================================================
+// RECORDS
+// ============================================================================
+
+static int16_t to_i16(float value) {
+    if (value > INT16_MAX) return INT16_MAX;
+    if (value < INT16_MIN) return INT16_MIN;
+    return (int16_t)lroundf(value);
+}
+
+static uint16_t to_u16(float value) {
+    if (value > UINT16_MAX) return UINT16_MAX;
+    if (value < 0) return 0;
+    return (uint16_t)lroundf(value);
+}
+
+static void tank_levels(const van_state_t *van_state, uint8_t *out) {
+    const water_tanks_levels_t *tanks = &van_state->slave_pcb.tanks_levels;
+    const water_tank_data_t *list[5] = { &tanks->tank_a, &tanks->tank_b, &tanks->tank_c, &tanks->tank_d, &tanks->tank_e };
+    for (int i = 0; i < 5; i++) {
+        float level = list[i]->level_percentage;
+        out[i] = (level <= 0) ? 0 : (level >= 100) ? 100 : (uint8_t)lroundf(level);
+    }
+}
+
+// Minute rollup from the bucket the aggregator just closed
+static void stage_minute(const van_state_t *van_state) {
+    telemetry_window_t current, discharge, voltage, solar;
+    if (telemetry_get_bucket(TELEMETRY_BATTERY_CURRENT, TELEMETRY_RES_1M, 0, &current) != ESP_OK ||
+        telemetry_get_bucket(TELEMETRY_BATTERY_DISCHARGE, TELEMETRY_RES_1M, 0, &discharge) != ESP_OK ||
+        telemetry_get_bucket(TELEMETRY_BATTERY_VOLTAGE, TELEMETRY_RES_1M, 0, &voltage) != ESP_OK ||
+        telemetry_get_bucket(TELEMETRY_SOLAR_POWER, TELEMETRY_RES_1M, 0, &solar) != ESP_OK ||
+        current.samples == 0) {
+        return;
+    }
+
+    telemetry_log_rollup_t r = {
+        .time = minute_start_time,
+        .samples = current.samples,
+        .battery_current_mean_ca = to_i16(current.mean * 100),
+        .battery_current_min_ca = to_i16(current.min * 100),
+        .battery_current_max_ca = to_i16(current.max * 100),
+        .battery_voltage_min_mv = to_u16(voltage.min * 1000),
+        .battery_voltage_max_mv = to_u16(voltage.max * 1000),
+        .solar_power_mean_w = to_u16(solar.mean),
+        .solar_power_max_w = to_u16(solar.max),
+        .solar_energy_dwh = to_u16(solar.integral * 10),
+        .battery_charge_mah = (int32_t)lroundf(current.integral * 1000),
+        .discharge_mah = (uint32_t)lroundf(discharge.integral * 1000),
+        .soc_percent = van_state->battery.soc_percent,
+    };
+    tank_levels(van_state, r.tank_percent);
+    stage_record(TELEMETRY_LOG_MINUTE, &r);
+
+    // Hour rollup from its 60 minutes
+    if (hour_minutes == 0) {
+        hour_acc = r;
+        hour_current_sum = (int64_t)r.battery_current_mean_ca * r.samples;
+        hour_solar_sum = (int64_t)r.solar_power_mean_w * r.samples;
+    } else {
+        if (r.battery_current_min_ca < hour_acc.battery_current_min_ca) hour_acc.battery_current_min_ca = r.battery_current_min_ca;
+        if (r.battery_current_max_ca > hour_acc.battery_current_max_ca) hour_acc.battery_current_max_ca = r.battery_current_max_ca;
+        if (r.battery_voltage_min_mv < hour_acc.battery_voltage_min_mv) hour_acc.battery_voltage_min_mv = r.battery_voltage_min_mv;
+        if (r.battery_voltage_max_mv > hour_acc.battery_voltage_max_mv) hour_acc.battery_voltage_max_mv = r.battery_voltage_max_mv;
+        if (r.solar_power_max_w > hour_acc.solar_power_max_w) hour_acc.solar_power_max_w = r.solar_power_max_w;
+        hour_acc.samples += r.samples;
+        hour_current_sum += (int64_t)r.battery_current_mean_ca * r.samples;
+        hour_solar_sum += (int64_t)r.solar_power_mean_w * r.samples;
+        hour_acc.solar_energy_dwh = to_u16((float)hour_acc.solar_energy_dwh + r.solar_energy_dwh);
+        hour_acc.battery_charge_mah += r.battery_charge_mah;
+        hour_acc.discharge_mah += r.discharge_mah;
+        hour_acc.soc_percent = r.soc_percent;
+        memcpy(hour_acc.tank_percent, r.tank_percent, sizeof(r.tank_percent));
+    }
+    if (++hour_minutes >= 60) {
+        hour_acc.battery_current_mean_ca = (int16_t)(hour_current_sum / hour_acc.samples);
+        hour_acc.solar_power_mean_w = (uint16_t)(hour_solar_sum / hour_acc.samples);
+        stage_record(TELEMETRY_LOG_HOUR, &hour_acc);
+        hour_minutes = 0;
+    }
+}
+
+esp_err_t telemetry_log_update_van_state(const van_state_t* van_state) {
+    if (!van_state) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!partition) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t minutes = telemetry_aggregator_minute_count();
+    uint32_t now;
+    if (!van_clock_now(&now)) {
+        // Time unknown: nothing can be stamped, start the rollups once it is set
+        last_minute_count = minutes;
+        minute_start_time = 0;
+        return ESP_OK;
+    }
+    if (minute_start_time == 0) {
+        minute_start_time = now;
+    }
+
+    telemetry_log_raw_t raw = {
+        .time = now,
+        .battery_current_ca = to_i16(van_state->battery.current_ma / 10.0f),
+        .battery_voltage_mv = van_state->battery.voltage_mv,
+        .solar_power_w = to_u16(van_state->mppt.solar_power_100_50 + van_state->mppt.solar_power_70_15),
+        .soc_percent = van_state->battery.soc_percent,
+    };
+    tank_levels(van_state, raw.tank_percent);
+    stage_record(TELEMETRY_LOG_RAW, &raw);
+
+    if (minutes != last_minute_count) {
+        last_minute_count = minutes;
+        stage_minute(van_state);
+        minute_start_time = now;
+    }
+    return ESP_OK;
+}
+
+// ============================================================================
+// READING
+// ============================================================================
+
+size_t telemetry_log_record_size(telemetry_log_tier_t tier) {
+    return (tier < TELEMETRY_LOG_TIER_COUNT) ? tiers[tier].record_size : 0;
+}
+
+// Oldest sector still holding records (write_mutex held)
+static uint16_t oldest_sector(telemetry_log_tier_t tier, uint32_t *seq) {
+    const log_tier_t *t = &tiers[tier];
+    // The sector after the current one, unless the ring has not wrapped yet
+    uint16_t s = (t->sector + 1) % t->sector_count;
+    uint32_t s_seq = read_sector_seq(tier, s);
+    if (s_seq == 0 || s_seq > t->sector_seq) {
+        s = 0;
+        s_seq = read_sector_seq(tier, 0);
+    }
+    *seq = s_seq;
+    return s;
+}
+
+// Records in a sector (write_mutex held)
+static uint16_t sector_records(const log_tier_t *t, uint16_t sector) {
+    return (sector == t->sector) ? t->used : t->per_sector;
+}
+
+esp_err_t telemetry_log_seek(telemetry_log_tier_t tier, uint32_t from_time, telemetry_log_cursor_t* cursor) {
+    if (tier >= TELEMETRY_LOG_TIER_COUNT || !cursor) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!partition) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const log_tier_t *t = &tiers[tier];
+    uint16_t s = 0;
+    uint16_t count = 0;
+    uint32_t seq = 0;
+
+    // First sector, in write order (seq), holding a record at or after
+    // from_time: times are not sorted, the clock steps back when the app sets
+    // it to an earlier time
+    xSemaphoreTake(write_mutex, portMAX_DELAY);
+    if (t->open) {
+        s = oldest_sector(tier, &seq);
+        while (seq != 0) {
+            uint32_t max_time = sector_max_time[t->first_sector + s];
+            if (max_time != 0 && max_time >= from_time) {
+                seq = read_sector_seq(tier, s);
+                count = sector_records(t, s);
+                break;
+            }
+            if (s == t->sector) {
+                seq = 0;
+                break;
+            }
+            s = (s + 1) % t->sector_count;
+        }
+    }
+    xSemaphoreGive(write_mutex);
+    if (seq == 0 || count == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Record in that sector, read without the mutex: if the sector is
+    // overwritten meanwhile, telemetry_log_read() sees the seq change
+    uint8_t buf[256];
+    uint16_t per_read = sizeof(buf) / t->record_size;
+    for (uint16_t first = 0; first < count; first += per_read) {
+        uint16_t n = (count - first < per_read) ? count - first : per_read;
+        if (esp_partition_read(partition, record_addr(t, s, first), buf, n * t->record_size) != ESP_OK) {
+            break;
+        }
+        for (uint16_t i = 0; i < n; i++) {
+            uint32_t time;
+            memcpy(&time, &buf[i * t->record_size], sizeof(time));
+            if (time != ERASED_TIME && time >= from_time) {
+                *cursor = (telemetry_log_cursor_t){
+                    .tier = tier, .sector = s, .index = first + i, .seq = seq, .end = false,
+                };
+                return ESP_OK;
+            }
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+size_t telemetry_log_read(telemetry_log_cursor_t* cursor, void* records, size_t max_records) {
+    if (!cursor || !records || cursor->tier >= TELEMETRY_LOG_TIER_COUNT || !partition) {
+        return 0;
+    }
+
+    const log_tier_t *t = &tiers[cursor->tier];
+    uint8_t *out = (uint8_t *)records;
+    size_t copied = 0;
+    cursor->end = false;
+
+    xSemaphoreTake(write_mutex, portMAX_DELAY);
+    while (copied < max_records) {
+        if (read_sector_seq(cursor->tier, cursor->sector) != cursor->seq) {
+            // Overwritten since the seek: continue with the oldest data left
+            cursor->sector = oldest_sector(cursor->tier, &cursor->seq);
+            cursor->index = 0;
+            if (cursor->seq == 0) {
+                cursor->end = true;
+                break;
+            }
+        }
+
+        uint16_t count = sector_records(t, cursor->sector);
+        if (cursor->index >= count) {
+            if (cursor->sector == t->sector) {
+                cursor->end = true;         // Caught up (staged records not written yet)
+                break;
+            }
+            uint16_t next = (cursor->sector + 1) % t->sector_count;
+            uint32_t seq = read_sector_seq(cursor->tier, next);
+            if (seq <= cursor->seq) {
+                cursor->end = true;
+                break;
+            }
+            cursor->sector = next;
+            cursor->seq = seq;
+            cursor->index = 0;
+            continue;
+        }
+
+        size_t n = count - cursor->index;
+        if (n > max_records - copied) n = max_records - copied;
+        if (esp_partition_read(partition, record_addr(t, cursor->sector, cursor->index), out, n * t->record_size) != ESP_OK) {
+            break;
+        }
+        cursor->index += n;
+        copied += n;
+        out += n * t->record_size;
+    }
+    xSemaphoreGive(write_mutex);
+    return copied;
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+esp_err_t telemetry_log_init(void) {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, TELEMETRY_LOG_SUBTYPE, TELEMETRY_LOG_PARTITION);
+    if (!partition) {
+        ESP_LOGE(TAG, "No \"%s\" partition, telemetry is not logged", TELEMETRY_LOG_PARTITION);
+        return ESP_ERR_NOT_FOUND;
+    }
+    uint32_t needed = PARTITION_SECTORS * TELEMETRY_LOG_SECTOR_SIZE;
+    if (partition->size < needed) {
+        ESP_LOGE(TAG, "Partition too small (%" PRIu32 " < %" PRIu32 " bytes)", partition->size, needed);
+        partition = NULL;
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    write_mutex = xSemaphoreCreateMutex();
+    if (!write_mutex) {
+        partition = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int tier = 0; tier < TELEMETRY_LOG_TIER_COUNT; tier++) {
+        recover_tier(tier);
+        ESP_LOGI(TAG, "Tier %s: sector %u/%u, %u records (seq %" PRIu32 ")", tiers[tier].name,
+                 tiers[tier].sector, tiers[tier].sector_count, tiers[tier].used, tiers[tier].sector_seq);
+    }
+
+    BaseType_t r = xTaskCreate(telemetry_log_writer_task, "telemetry_log", 3072, NULL, tskIDLE_PRIORITY + 1, &writer_task_handle);
+    if (r != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create telemetry log task");
+        partition = NULL;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
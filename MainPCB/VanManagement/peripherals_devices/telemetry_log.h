@@ -0,0 +1,120 @@
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "../communications/protocol.h"
+
+// Telemetry history in the "telemetry" flash partition (partitions.csv).
+// Three tiers, each an append-only ring of 4 KB sectors used in turn (even
+// wear): raw samples (1 per update, 24 h), 1-minute and 1-hour rollups (weeks).
+// Records are staged in RAM and written by a background task when the raw
+// staging buffer holds a sector (about every 4 minutes), the rollups being
+// appended in the same pass. A reboot loses at most the staged records.
+// Sector: telemetry_log_sector_header_t, then records up to the first erased
+// one (time = 0xFFFFFFFF). Times are van_clock.h seconds; nothing is logged
+// until the clock is known. Records are in write order (sector seq), and their
+// times only step back when the app sets the clock to an earlier time.
+
+#define TELEMETRY_LOG_PARTITION         "telemetry"
+#define TELEMETRY_LOG_SUBTYPE           0x40
+#define TELEMETRY_LOG_SECTOR_SIZE       4096
+#define TELEMETRY_LOG_MAGIC             0x474C5456      // "VTLG"
+
+// Sectors of each tier (the partition holds 768)
+#define TELEMETRY_LOG_RAW_SECTORS       360             // 255 records each: 25 h at 1 Hz
+#define TELEMETRY_LOG_MINUTE_SECTORS    384             // 113 records each: 30 days
+#define TELEMETRY_LOG_HOUR_SECTORS      24              // 113 records each: 16 weeks
+
+typedef enum {
+    TELEMETRY_LOG_RAW = 0,
+    TELEMETRY_LOG_MINUTE,
+    TELEMETRY_LOG_HOUR,
+    TELEMETRY_LOG_TIER_COUNT
+} telemetry_log_tier_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;                   // Increases with every sector written (all tiers)
+    uint8_t tier;
+    uint8_t record_size;
+    uint16_t reserved;
+    uint32_t reserved2;
+} telemetry_log_sector_header_t;
+
+// Raw sample (16 bytes)
+typedef struct __attribute__((packed)) {
+    uint32_t time;
+    int16_t battery_current_ca;     // A x100, <0 = discharge
+    uint16_t battery_voltage_mv;
+    uint16_t solar_power_w;         // Both MPPTs
+    uint8_t soc_percent;
+    uint8_t tank_percent[5];        // Tanks A-E
+} telemetry_log_raw_t;
+
+// 1-minute or 1-hour rollup (36 bytes), time = start of the period
+typedef struct __attribute__((packed)) {
+    uint32_t time;
+    uint16_t samples;
+    int16_t battery_current_mean_ca;
+    int16_t battery_current_min_ca;
+    int16_t battery_current_max_ca;
+    uint16_t battery_voltage_min_mv;
+    uint16_t battery_voltage_max_mv;
+    uint16_t solar_power_mean_w;
+    uint16_t solar_power_max_w;
+    uint16_t solar_energy_dwh;      // Wh x10
+    int32_t battery_charge_mah;     // Net, <0 = discharged
+    uint32_t discharge_mah;         // Consumption
+    uint8_t soc_percent;            // At the end of the period
+    uint8_t tank_percent[5];
+} telemetry_log_rollup_t;
+
+// Read position in a tier
+typedef struct {
+    telemetry_log_tier_t tier;
+    uint16_t sector;                // Sector index in the tier
+    uint16_t index;                 // Next record in the sector
+    uint32_t seq;                   // Sequence of that sector (detects overwrite)
+    bool end;
+} telemetry_log_cursor_t;
+
+/**
+ * @brief Find the partition, recover the write positions and start the writer task
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if the partition is missing
+ */
+esp_err_t telemetry_log_init(void);
+
+/**
+ * @brief Stage a raw sample and the rollups of closed periods
+ *
+ * Call after telemetry_aggregator_update_van_state(). Never touches the flash.
+ */
+esp_err_t telemetry_log_update_van_state(const van_state_t* van_state);
+
+/**
+ * @brief Write the staged records now (before a download or a reboot)
+ */
+esp_err_t telemetry_log_flush(void);
+
+/**
+ * @brief Position a cursor on the first record, in write order, at or after from_time
+ *
+ * Later records are not guaranteed to be at or after from_time (clock set
+ * back): readers filter the times.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if the tier has no such record
+ */
+esp_err_t telemetry_log_seek(telemetry_log_tier_t tier, uint32_t from_time, telemetry_log_cursor_t* cursor);
+
+/**
+ * @brief Read the next records (telemetry_log_raw_t or telemetry_log_rollup_t)
+ * @return Number of records copied, 0 at the end of the log
+ */
+size_t telemetry_log_read(telemetry_log_cursor_t* cursor, void* records, size_t max_records);
+
+// Size of one record of a tier
+size_t telemetry_log_record_size(telemetry_log_tier_t tier);
+
+#endif // TELEMETRY_LOG_H
@@ -0,0 +1,120 @@
+#include "van_clock.h"
+#include <time.h>
+#include <sys/time.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "VAN_CLOCK";
+
+#define VAN_CLOCK_NVS_KEY   "epoch"
+
+static nvs_handle_t clock_nvs;
+static bool clock_nvs_ready = false;
+static portMUX_TYPE clock_lock = portMUX_INITIALIZER_UNLOCKED;
+static van_clock_source_t source = VAN_CLOCK_UNSET;
+static uint32_t saved_epoch = 0;   // Last time written to NVS
+
+static esp_err_t save_epoch(uint32_t epoch) {
+    if (!clock_nvs_ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = nvs_set_u32(clock_nvs, VAN_CLOCK_NVS_KEY, epoch);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(clock_nvs);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save the time: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+static void set_system_time(uint32_t epoch) {
+    struct timeval tv = { .tv_sec = epoch, .tv_usec = 0 };
+    settimeofday(&tv, NULL);
+}
+
+esp_err_t van_clock_init(void) {
+    esp_err_t ret = nvs_open(VAN_CLOCK_NVS_NAMESPACE, NVS_READWRITE, &clock_nvs);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open clock storage: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    clock_nvs_ready = true;
+
+    uint32_t epoch = 0;
+    ret = nvs_get_u32(clock_nvs, VAN_CLOCK_NVS_KEY, &epoch);
+    if (ret == ESP_ERR_NVS_NOT_FOUND || (ret == ESP_OK && epoch < VAN_CLOCK_MIN_EPOCH)) {
+        ESP_LOGW(TAG, "Time unknown until set by the app");
+        return ESP_OK;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read the saved time: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // Records may have been stamped up to one save period after the last save
+    epoch += VAN_CLOCK_SAVE_PERIOD_S;
+    set_system_time(epoch);
+    portENTER_CRITICAL(&clock_lock);
+    source = VAN_CLOCK_RESTORED;
+    saved_epoch = epoch;
+    portEXIT_CRITICAL(&clock_lock);
+    save_epoch(epoch);
+    ESP_LOGI(TAG, "Time restored at %" PRIu32 " (behind by the power-off duration)", epoch);
+    return ESP_OK;
+}
+
+esp_err_t van_clock_set(uint32_t epoch) {
+    if (epoch < VAN_CLOCK_MIN_EPOCH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    set_system_time(epoch);
+    portENTER_CRITICAL(&clock_lock);
+    van_clock_source_t previous = source;
+    source = VAN_CLOCK_SYNCED;
+    saved_epoch = epoch;
+    portEXIT_CRITICAL(&clock_lock);
+
+    if (previous != VAN_CLOCK_SYNCED) {
+        ESP_LOGI(TAG, "Time set by the app: %" PRIu32, epoch);
+    }
+    return save_epoch(epoch);
+}
+
+bool van_clock_now(uint32_t *now) {
+    portENTER_CRITICAL(&clock_lock);
+    bool valid = (source != VAN_CLOCK_UNSET);
+    portEXIT_CRITICAL(&clock_lock);
+
+    if (valid && now) {
+        *now = (uint32_t)time(NULL);
+    }
+    return valid;
+}
+
+van_clock_source_t van_clock_source(void) {
+    portENTER_CRITICAL(&clock_lock);
+    van_clock_source_t s = source;
+    portEXIT_CRITICAL(&clock_lock);
+    return s;
+}
+
+esp_err_t van_clock_update_van_state(van_state_t* van_state) {
+    (void) van_state;
+    uint32_t now;
+    if (!van_clock_now(&now)) {
+        return ESP_OK;
+    }
+
+    portENTER_CRITICAL(&clock_lock);
+    bool due = (now - saved_epoch) >= VAN_CLOCK_SAVE_PERIOD_S;
+    if (due) {
+        saved_epoch = now;
+    }
+    portEXIT_CRITICAL(&clock_lock);
+
+    return due ? save_epoch(now) : ESP_OK;
+}
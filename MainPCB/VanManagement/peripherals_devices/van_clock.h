@@ -0,0 +1,50 @@
+#ifndef VAN_CLOCK_H
+#define VAN_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "../communications/protocol.h"
+
+// Wall clock of the van (Unix seconds). There is no RTC nor network: the app
+// sets the time over BLE, and the clock is saved in NVS every few minutes so
+// that a reboot resumes from the last saved time. A restored clock runs behind
+// by the power-off duration until the app sets it again, but never goes
+// backwards: the telemetry log stays in order. Until the first setting the
+// time is unknown and nothing is time-stamped.
+
+#define VAN_CLOCK_NVS_NAMESPACE     "van_clock"
+#define VAN_CLOCK_SAVE_PERIOD_S     600         // Saved time may lag by up to this
+#define VAN_CLOCK_MIN_EPOCH         1704067200  // 2024-01-01, anything earlier is refused
+
+typedef enum {
+    VAN_CLOCK_UNSET = 0,            // Never set: time unknown
+    VAN_CLOCK_RESTORED,             // Resumed from NVS after a reboot
+    VAN_CLOCK_SYNCED,               // Set by the app since the boot
+} van_clock_source_t;
+
+/**
+ * @brief Restore the saved time (NVS must be initialized)
+ */
+esp_err_t van_clock_init(void);
+
+/**
+ * @brief Set the time from the app and save it
+ * @return ESP_ERR_INVALID_ARG if the time is before VAN_CLOCK_MIN_EPOCH
+ */
+esp_err_t van_clock_set(uint32_t epoch);
+
+/**
+ * @brief Current time in seconds
+ * @return false if the time is unknown (*now untouched)
+ */
+bool van_clock_now(uint32_t *now);
+
+van_clock_source_t van_clock_source(void);
+
+/**
+ * @brief Save the time in NVS every VAN_CLOCK_SAVE_PERIOD_S (update loop)
+ */
+esp_err_t van_clock_update_van_state(van_state_t* van_state);
+
+#endif // VAN_CLOCK_H
@@ -0,0 +1,350 @@
+#include "ve_direct.h"
+#include <string.h>
+
+// Special labels (negative so they never collide with a ve_direct_field_t)
+#define VE_LABEL_UNKNOWN   (-1)
+#define VE_LABEL_CHECKSUM  (-2)
+#define VE_LABEL_PID       (-3)     // First field of a block
+
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME        16777619UL
+
+typedef struct {
+    const char* label;
+    int id;
+} ve_label_def_t;
+
+static const ve_label_def_t label_defs[] = {
+    {"V",        VE_FIELD_V},
+    {"I",        VE_FIELD_I},
+    {"VPV",      VE_FIELD_VPV},
+    {"PPV",      VE_FIELD_PPV},
+    {"CS",       VE_FIELD_CS},
+    {"ERR",      VE_FIELD_ERR},
+    {"T",        VE_FIELD_T},
+    {"H20",      VE_FIELD_H20},
+    {"H21",      VE_FIELD_H21},
+    {"H22",      VE_FIELD_H22},
+    {"H23",      VE_FIELD_H23},
+    {"Checksum", VE_LABEL_CHECKSUM},
+    {"PID",      VE_LABEL_PID},
+};
+
+#define LABEL_DEF_COUNT   (sizeof(label_defs) / sizeof(label_defs[0]))
+#define LABEL_TABLE_SIZE  32        // Power of 2, > 2x the number of labels
+
+// Open-addressed hash table of label_defs (slot = hash & (size-1), linear probing)
+typedef struct {
+    uint32_t hash;
+    int8_t def;                     // Index in label_defs, -1 if empty
+} ve_label_slot_t;
+
+static ve_label_slot_t label_table[LABEL_TABLE_SIZE];
+static bool label_table_ready = false;
+
+static inline uint32_t fnv1a_step(uint32_t hash, uint8_t c)
+{
+    return (hash ^ c) * FNV_PRIME;
+}
+
+static uint32_t fnv1a(const char* s)
+{
+    uint32_t hash = FNV_OFFSET_BASIS;
+    while (*s) hash = fnv1a_step(hash, (uint8_t)*s++);
+    return hash;
+}
+
+static void build_label_table(void)
+{
+    for (int i = 0; i < LABEL_TABLE_SIZE; i++) {
+        label_table[i].def = -1;
+    }
+    for (int d = 0; d < (int)LABEL_DEF_COUNT; d++) {
+        uint32_t hash = fnv1a(label_defs[d].label);
+        uint32_t slot = hash & (LABEL_TABLE_SIZE - 1);
+        while (label_table[slot].def >= 0) {
+            slot = (slot + 1) & (LABEL_TABLE_SIZE - 1);
+        }
+        label_table[slot].hash = hash;
+        label_table[slot].def = d;
+    }
+    label_table_ready = true;
+}
+
+// Label id of the label just received (hash computed while receiving it)
+static int lookup_label(const ve_direct_parser_t* parser)
+{
+    if (parser->label_len > VE_DIRECT_LABEL_MAX) return VE_LABEL_UNKNOWN;
+
+    uint32_t slot = parser->label_hash & (LABEL_TABLE_SIZE - 1);
+    while (label_table[slot].def >= 0) {
+        const ve_label_def_t* def = &label_defs[label_table[slot].def];
+        if (label_table[slot].hash == parser->label_hash &&
+            strncmp(def->label, parser->label, parser->label_len) == 0 &&
+            def->label[parser->label_len] == '\0') {
+            return def->id;
+        }
+        slot = (slot + 1) & (LABEL_TABLE_SIZE - 1);
+    }
+    return VE_LABEL_UNKNOWN;
+}
+
+void ve_direct_parser_reset(ve_direct_parser_t* parser)
+{
+    if (!parser) return;
+    uint32_t blocks_ok = parser->blocks_ok;
+    uint32_t checksum_errors = parser->checksum_errors;
+    uint32_t hex_errors = parser->hex_errors;
+    ve_direct_hex_handler_t hex_handler = parser->hex_handler;
+    void* hex_ctx = parser->hex_ctx;
+
+    memset(parser, 0, sizeof(ve_direct_parser_t));
+    parser->state = VE_PARSER_WAIT_LABEL;
+    parser->field = VE_LABEL_UNKNOWN;
+
+    parser->blocks_ok = blocks_ok;
+    parser->checksum_errors = checksum_errors;
+    parser->hex_errors = hex_errors;
+    parser->hex_handler = hex_handler;
+    parser->hex_ctx = hex_ctx;
+}
+
+void ve_direct_parser_set_hex_handler(ve_direct_parser_t* parser, ve_direct_hex_handler_t handler, void* ctx)
+{
+    if (!parser) return;
+    parser->hex_handler = handler;
+    parser->hex_ctx = ctx;
+}
+
+// ============================================================================
+// HEX PROTOCOL
+// ============================================================================
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+size_t ve_direct_hex_encode(uint8_t cmd, const uint8_t* data, size_t len, char* out, size_t out_size)
+{
+    // ':' + cmd + 2 chars per byte + checksum + '\n'
+    size_t total = 1 + 1 + 2 * len + 2 + 1;
+    if (!out || out_size < total || (len > 0 && !data)) return 0;
+
+    uint8_t checksum = 0x55 - (cmd & 0x0F);
+    size_t pos = 0;
+    out[pos++] = ':';
+    out[pos++] = hex_digits[cmd & 0x0F];
+    for (size_t i = 0; i < len; i++) {
+        out[pos++] = hex_digits[data[i] >> 4];
+        out[pos++] = hex_digits[data[i] & 0x0F];
+        checksum -= data[i];
+    }
+    out[pos++] = hex_digits[checksum >> 4];
+    out[pos++] = hex_digits[checksum & 0x0F];
+    out[pos++] = '\n';
+    return pos;
+}
+
+uint32_t ve_direct_hex_value(const ve_direct_hex_frame_t* frame)
+{
+    // Register (2 bytes) + flags, then up to 4 value bytes
+    int end = (frame->len < 7) ? frame->len : 7;
+    uint32_t value = 0;
+    for (int i = end - 1; i >= 3; i--) {
+        value = (value << 8) | frame->data[i];
+    }
+    return value;
+}
+
+// Decode the HEX frame accumulated since ':' and hand it to the handler
+static void end_hex_frame(ve_direct_parser_t* parser)
+{
+    // Command nibble + at least the checksum byte, whole bytes only
+    if (parser->hex_len < 3 || parser->hex_len > sizeof(parser->hex) || (parser->hex_len % 2) == 0) {
+        parser->hex_errors++;
+        return;
+    }
+
+    int cmd = hex_nibble(parser->hex[0]);
+    if (cmd < 0) {
+        parser->hex_errors++;
+        return;
+    }
+
+    ve_direct_hex_frame_t frame = { .rsp = (uint8_t)cmd };
+    uint8_t sum = (uint8_t)cmd;
+    int byte_count = (parser->hex_len - 1) / 2;
+    for (int b = 0; b < byte_count; b++) {
+        int hi = hex_nibble(parser->hex[1 + 2 * b]);
+        int lo = hex_nibble(parser->hex[2 + 2 * b]);
+        if (hi < 0 || lo < 0) {
+            parser->hex_errors++;
+            return;
+        }
+        uint8_t byte = (uint8_t)((hi << 4) | lo);
+        sum += byte;
+        if (b < byte_count - 1) frame.data[frame.len++] = byte;     // Last byte is the checksum
+    }
+
+    if (sum != 0x55) {
+        parser->hex_errors++;
+        return;
+    }
+    if (parser->hex_handler) {
+        parser->hex_handler(&frame, parser->hex_ctx);
+    }
+}
+
+static void start_label(ve_direct_parser_t* parser)
+{
+    parser->state = VE_PARSER_LABEL;
+    parser->label_len = 0;
+    parser->label_hash = FNV_OFFSET_BASIS;
+}
+
+static void end_label(ve_direct_parser_t* parser)
+{
+    int id = lookup_label(parser);
+
+    if (id == VE_LABEL_CHECKSUM) {
+        parser->state = VE_PARSER_CHECKSUM;
+        return;
+    }
+    if (id == VE_LABEL_PID && !parser->synced) {
+        // Block start found: the checksum was restarted on the preceding "\r"
+        parser->synced = true;
+        parser->pending.field_mask = 0;
+    }
+
+    parser->field = (id >= 0) ? id : VE_LABEL_UNKNOWN;
+    parser->value = 0;
+    parser->value_negative = false;
+    parser->value_numeric = false;
+    parser->state = VE_PARSER_VALUE;
+}
+
+static void end_value(ve_direct_parser_t* parser)
+{
+    if (parser->field >= 0 && parser->value_numeric) {
+        parser->pending.values[parser->field] = parser->value_negative ? -parser->value : parser->value;
+        parser->pending.field_mask |= 1UL << parser->field;
+    }
+    parser->state = VE_PARSER_WAIT_LABEL;
+}
+
+static void value_char(ve_direct_parser_t* parser, char c)
+{
+    if (c >= '0' && c <= '9') {
+        if (parser->value > (INT32_MAX - 9) / 10) {
+            parser->field = VE_LABEL_UNKNOWN;      // Out of range: drop the field
+            return;
+        }
+        parser->value = parser->value * 10 + (c - '0');
+        parser->value_numeric = true;
+    } else if (c == '-' && !parser->value_numeric && !parser->value_negative) {
+        parser->value_negative = true;
+    } else {
+        parser->field = VE_LABEL_UNKNOWN;          // Not a number (PID, SER#, FW...)
+    }
+}
+
+bool ve_direct_parser_feed(ve_direct_parser_t* parser, const uint8_t* data, size_t len,
+                           ve_direct_block_t* block)
+{
+    if (!parser || !data) return false;
+    if (!label_table_ready) build_label_table();
+
+    bool completed = false;
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = data[i];
+
+        // Interleaved HEX frames are skipped and not part of the checksum
+        if (parser->state == VE_PARSER_HEX) {
+            if (c == '\n') {
+                end_hex_frame(parser);
+                parser->state = parser->state_before_hex;
+            } else if (c != '\r') {
+                if (parser->hex_len < sizeof(parser->hex)) {
+                    parser->hex[parser->hex_len++] = (char)c;
+                } else {
+                    parser->hex_len = 0xFF;     // Too long, rejected at the end
+                }
+            }
+            continue;
+        }
+        if (c == ':' && parser->state != VE_PARSER_CHECKSUM) {
+            parser->state_before_hex = parser->state;
+            parser->state = VE_PARSER_HEX;
+            parser->hex_len = 0;
+            continue;
+        }
+
+        // Until synced, every line may be the start of a block
+        if (!parser->synced && parser->state == VE_PARSER_WAIT_LABEL && c == '\r') {
+            parser->checksum = 0;
+        }
+        parser->checksum += c;
+
+        switch (parser->state) {
+            case VE_PARSER_WAIT_LABEL:
+                if (c == '\n') start_label(parser);
+                break;
+
+            case VE_PARSER_LABEL:
+                if (c == '\t') {
+                    end_label(parser);
+                } else if (c == '\r' || c == '\n') {
+                    // Field without value: ignore it
+                    parser->state = VE_PARSER_WAIT_LABEL;
+                    if (c == '\n') start_label(parser);
+                } else {
+                    if (parser->label_len < VE_DIRECT_LABEL_MAX) {
+                        parser->label[parser->label_len] = (char)c;
+                    }
+                    if (parser->label_len <= VE_DIRECT_LABEL_MAX) parser->label_len++;
+                    parser->label_hash = fnv1a_step(parser->label_hash, c);
+                }
+                break;
+
+            case VE_PARSER_VALUE:
+                if (c == '\r' || c == '\n') {
+                    end_value(parser);
+                    if (c == '\n') start_label(parser);
+                } else {
+                    value_char(parser, (char)c);
+                }
+                break;
+
+            case VE_PARSER_CHECKSUM:
+                // The checksum byte itself completes the block
+                if (parser->synced) {
+                    if (parser->checksum == 0) {
+                        if (block) *block = parser->pending;
+                        parser->blocks_ok++;
+                        completed = true;
+                    } else {
+                        parser->checksum_errors++;
+                    }
+                }
+                // The next block starts right after this byte
+                parser->synced = true;
+                parser->checksum = 0;
+                parser->pending.field_mask = 0;
+                parser->state = VE_PARSER_WAIT_LABEL;
+                break;
+
+            default:
+                parser->state = VE_PARSER_WAIT_LABEL;
+                break;
+        }
+    }
+
+    return completed;
+}
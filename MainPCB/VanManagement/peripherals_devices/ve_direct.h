@@ -0,0 +1,157 @@
+#ifndef VE_DIRECT_H
+#define VE_DIRECT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// VE.Direct text protocol (Victron MPPT), parsed byte by byte.
+// A block is a sequence of "\r\n<label>\t<value>" fields ending with
+// "\r\nChecksum\t<byte>"; the sum of all its bytes is 0 modulo 256.
+// HEX frames (":...\n") may be interleaved and are excluded from the checksum.
+
+#define VE_DIRECT_LABEL_MAX 9       // Longest label kept ("Checksum" is 8)
+#define VE_DIRECT_HEX_MAX_DATA 32   // Bytes of a HEX frame after the command nibble
+
+// HEX protocol: ":<cmd nibble><bytes as hex><checksum>\n", cmd + bytes + checksum = 0x55
+typedef enum {
+    VE_HEX_CMD_PING = 0x1,
+    VE_HEX_CMD_APP_VERSION = 0x3,
+    VE_HEX_CMD_PRODUCT_ID = 0x4,
+    VE_HEX_CMD_GET = 0x7,
+    VE_HEX_CMD_SET = 0x8,
+} ve_direct_hex_cmd_t;
+
+typedef enum {
+    VE_HEX_RSP_DONE = 0x1,
+    VE_HEX_RSP_UNKNOWN = 0x3,
+    VE_HEX_RSP_ERROR = 0x4,
+    VE_HEX_RSP_PING = 0x5,
+    VE_HEX_RSP_GET = 0x7,
+    VE_HEX_RSP_SET = 0x8,
+    VE_HEX_RSP_ASYNC = 0xA,
+} ve_direct_hex_rsp_t;
+
+// Flags of Get/Set/Async responses
+#define VE_HEX_FLAG_UNKNOWN_ID     0x01
+#define VE_HEX_FLAG_NOT_SUPPORTED  0x02
+#define VE_HEX_FLAG_PARAM_ERROR    0x04
+
+// Registers of the MPPT chargers (little endian values)
+#define VE_REG_PANEL_POWER         0xEDBC  // un32, 0.01 W
+#define VE_REG_PANEL_VOLTAGE       0xEDBB  // un16, 0.01 V
+#define VE_REG_CHARGER_VOLTAGE     0xEDD5  // un16, 0.01 V
+#define VE_REG_CHARGER_CURRENT     0xEDD7  // un16, 0.1 A
+#define VE_REG_DEVICE_STATE        0x0201  // un8, same values as CS
+#define VE_REG_CHARGER_ERROR       0xEDDA  // un8, same values as ERR
+#define VE_REG_YIELD_TODAY         0xEDD3  // un16, 0.01 kWh
+#define VE_REG_MAX_POWER_TODAY     0xEDD2  // un16, W
+#define VE_REG_YIELD_YESTERDAY     0xEDD1  // un16, 0.01 kWh
+#define VE_REG_MAX_POWER_YESTERDAY 0xEDD0  // un16, W
+
+typedef struct {
+    uint8_t rsp;                            // ve_direct_hex_rsp_t
+    uint8_t data[VE_DIRECT_HEX_MAX_DATA];   // Checksum excluded
+    uint8_t len;
+} ve_direct_hex_frame_t;
+
+typedef void (*ve_direct_hex_handler_t)(const ve_direct_hex_frame_t* frame, void* ctx);
+
+// Fields decoded from a block (fixed point, as sent by the charger)
+typedef enum {
+    VE_FIELD_V = 0,     // Battery voltage (mV)
+    VE_FIELD_I,         // Battery current (mA)
+    VE_FIELD_VPV,       // Panel voltage (mV)
+    VE_FIELD_PPV,       // Panel power (W)
+    VE_FIELD_CS,        // Charger state
+    VE_FIELD_ERR,       // Error code
+    VE_FIELD_T,         // Temperature (°C, not sent by every model)
+    VE_FIELD_H20,       // Yield today (0.01 kWh)
+    VE_FIELD_H21,       // Maximum power today (W)
+    VE_FIELD_H22,       // Yield yesterday (0.01 kWh)
+    VE_FIELD_H23,       // Maximum power yesterday (W)
+    VE_FIELD_COUNT,
+} ve_direct_field_t;
+
+typedef struct {
+    int32_t values[VE_FIELD_COUNT];
+    uint32_t field_mask;            // Bit n set if values[n] was received
+} ve_direct_block_t;
+
+typedef enum {
+    VE_PARSER_WAIT_LABEL,           // Waiting for the "\n" that starts a field
+    VE_PARSER_LABEL,
+    VE_PARSER_VALUE,
+    VE_PARSER_CHECKSUM,             // Next byte is the checksum byte
+    VE_PARSER_HEX,                  // Inside an interleaved HEX frame
+} ve_direct_parser_state_t;
+
+// One context per device: a block never mixes bytes of two chargers
+typedef struct {
+    ve_direct_parser_state_t state;
+    ve_direct_parser_state_t state_before_hex;
+    bool synced;                    // A block start has been seen since the last reset
+    uint8_t checksum;
+
+    char label[VE_DIRECT_LABEL_MAX + 1];
+    uint8_t label_len;
+    uint32_t label_hash;
+    int field;                      // Field of the current value, -1 if ignored
+
+    int32_t value;
+    bool value_negative;
+    bool value_numeric;
+
+    ve_direct_block_t pending;      // Fields of the block being received
+
+    char hex[1 + 2 * (VE_DIRECT_HEX_MAX_DATA + 1)];
+    uint8_t hex_len;
+    ve_direct_hex_handler_t hex_handler;
+    void* hex_ctx;
+
+    // Statistics
+    uint32_t blocks_ok;
+    uint32_t checksum_errors;
+    uint32_t hex_errors;
+} ve_direct_parser_t;
+
+// Reset the context (call when the line is switched to another device)
+void ve_direct_parser_reset(ve_direct_parser_t* parser);
+
+/**
+ * @brief Feed received bytes to the parser
+ *
+ * @param block Receives the last block whose checksum was valid
+ * @return true if at least one valid block was completed during this call
+ */
+bool ve_direct_parser_feed(ve_direct_parser_t* parser, const uint8_t* data, size_t len,
+                           ve_direct_block_t* block);
+
+// Receive the valid HEX frames found in the stream (kept across resets)
+void ve_direct_parser_set_hex_handler(ve_direct_parser_t* parser, ve_direct_hex_handler_t handler, void* ctx);
+
+/**
+ * @brief Encode a HEX command
+ *
+ * @param data Bytes after the command nibble (register, flags, value), may be NULL
+ * @return Length written to out (terminated by '\n', not NUL), 0 if out is too small
+ */
+size_t ve_direct_hex_encode(uint8_t cmd, const uint8_t* data, size_t len, char* out, size_t out_size);
+
+// Get/Set/Async response fields
+static inline uint16_t ve_direct_hex_register(const ve_direct_hex_frame_t* frame) {
+    return (frame->len >= 2) ? (uint16_t)(frame->data[0] | (frame->data[1] << 8)) : 0;
+}
+static inline uint8_t ve_direct_hex_flags(const ve_direct_hex_frame_t* frame) {
+    return (frame->len >= 3) ? frame->data[2] : 0;
+}
+
+// Little endian unsigned value of a Get/Set/Async response
+uint32_t ve_direct_hex_value(const ve_direct_hex_frame_t* frame);
+
+// True if the field was present in the block
+static inline bool ve_direct_has(const ve_direct_block_t* block, ve_direct_field_t field) {
+    return (block->field_mask & (1UL << field)) != 0;
+}
+
+#endif // VE_DIRECT_H
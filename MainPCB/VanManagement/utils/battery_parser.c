@@ -45,7 +45,7 @@ static inline int16_t read_i16_be(const uint8_t* data) {
 
 bool battery_parse_data(const uint8_t* raw_data, size_t length, battery_data_t* out_battery) {
     if (!raw_data || !out_battery || length < 23) {  // Minimum: header(4) + data(15) + checksum(2) + end(1) + padding = 23
-        ESP_LOGE(TAG, "Invalid parameters or data too short (need >= 23 bytes, got %u)", length);
+        ESP_LOGE(TAG, "Invalid parameters or data too short (need >= 23 bytes, got %zu)", length);
         return false;
     }
     
@@ -173,7 +173,7 @@ bool battery_parse_cell_voltages(const uint8_t* raw_data, size_t length, battery
     
     uint8_t data_len = raw_data[3];  // Number of data bytes
     if (length < (size_t)(4 + data_len + 3)) {  // Header(4) + data + checksum(2) + end(1)
-        ESP_LOGE(TAG, "Cell voltage response too short: got %u, expected %u", 
+        ESP_LOGE(TAG, "Cell voltage response too short: got %zu, expected %d", 
                  length, 4 + data_len + 3);
         return false;
     }
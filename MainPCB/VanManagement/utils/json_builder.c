@@ -144,6 +144,22 @@ int json_build_van_state(const van_state_t* state, char* buffer, size_t buffer_s
     cJSON_AddBoolToObject(heater, "pump_active", state->heater.pump_active);
     cJSON_AddNumberToObject(heater, "radiator_fan_speed", state->heater.radiator_fan_speed);
     cJSON_AddItemToObject(root, "heater", heater);
+
+    // ═══════════════════════════════════════════════════════════
+    // TRENDS - Rolling aggregates
+    // ═══════════════════════════════════════════════════════════
+    cJSON *trends = cJSON_CreateObject();
+    cJSON_AddNumberToObject(trends, "solar_wh_1m", state->trends.solar_wh_1m);
+    cJSON_AddNumberToObject(trends, "solar_wh_15m", state->trends.solar_wh_15m);
+    cJSON_AddNumberToObject(trends, "battery_ah_15m", state->trends.battery_ah_15m);
+    cJSON_AddNumberToObject(trends, "consumption_ah_15m", state->trends.consumption_ah_15m);
+    cJSON_AddNumberToObject(trends, "battery_voltage_min_15m", state->trends.battery_voltage_min_15m);
+    cJSON *tank_rates = cJSON_CreateArray();
+    for (int i = 0; i < 5; i++) {
+        cJSON_AddItemToArray(tank_rates, cJSON_CreateNumber(state->trends.tank_rate_lph[i]));
+    }
+    cJSON_AddItemToObject(trends, "tank_rate_lph", tank_rates);
+    cJSON_AddItemToObject(root, "trends", trends);
     
     // ═══════════════════════════════════════════════════════════
     // LEDS
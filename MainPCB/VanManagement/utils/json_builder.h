@@ -28,6 +28,7 @@ extern "C" {
  * - Battery (voltage, current, SOC, temperature, charging state)
  * - Sensors (cabin/exterior temp, humidity, CO2, door)
  * - Heater (state, temps, fuel level, pump, fan)
+ * - Trends (solar yield, battery Ah and tank rates over 1/15 min)
  * - LEDs (roof, avant, arrière - each with enabled/mode/brightness)
  * - System info (uptime, errors)
  * - Slave PCB state:
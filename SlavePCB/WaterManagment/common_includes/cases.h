@@ -18,4 +18,13 @@ typedef enum {
     CASE_MAX
 } system_case_t;
 
+// System states
+typedef enum {
+    STATE_CE = (1 << 0),  // Clean Water Empty
+    STATE_DF = (1 << 1),  // Dirt Water Full
+    STATE_DE = (1 << 2),  // Dirt Water Empty
+    STATE_RF = (1 << 3),  // Recycled Water Full
+    STATE_RE = (1 << 4)   // Recycled Water Empty
+} system_states_t;
+
 #endif // CASES_H
\ No newline at end of file
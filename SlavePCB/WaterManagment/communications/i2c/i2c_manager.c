@@ -8,6 +8,10 @@ static const char *TAG = "I2C_MGR";
 #define I2C_MASTER_NUM       I2C_NUM_0
 #define I2C_MASTER_FREQ_HZ   100000
 #define I2C_MULTIPLEXER_ADDR 0x70
+#define I2C_MUX_NO_CHANNEL   0xFF
+
+// Canal sélectionné sur le multiplexeur (évite de le réécrire à chaque lecture)
+static uint8_t selected_channel = I2C_MUX_NO_CHANNEL;
 
 slave_pcb_err_t i2c_manager_init(void) {
     ESP_LOGI(TAG, "Initializing I2C on SDA=%d, SCL=%d", I2C_MASTER_SDA_IO, I2C_MASTER_SCL_IO);
@@ -44,18 +48,24 @@ slave_pcb_err_t i2c_set_multiplexer_channel(uint8_t channel) {
         return SLAVE_PCB_ERR_INVALID_ARG;
     }
 
+    if (channel == selected_channel) {
+        return SLAVE_PCB_OK;
+    }
+
     // Try I2C-based multiplexer control first
     uint8_t channel_byte = 1 << channel;
     esp_err_t i2c_ret = i2c_master_write_to_device(I2C_MASTER_NUM, I2C_MULTIPLEXER_ADDR, 
                                                    &channel_byte, 1, pdMS_TO_TICKS(100));
     
     if (i2c_ret == ESP_OK) {
+        // The TCA9548A switches on the STOP condition: no settling delay
         ESP_LOGD(TAG, "I2C multiplexer channel %d selected", channel);
-        vTaskDelay(pdMS_TO_TICKS(5));
+        selected_channel = channel;
         return SLAVE_PCB_OK;
     }
     
     // GPIO fallback
+    selected_channel = I2C_MUX_NO_CHANNEL;
     ESP_LOGW(TAG, "I2C multiplexer control failed, using GPIO fallback");
     REPORT_ERROR(SLAVE_PCB_ERR_I2C_FAIL, TAG, "I2C multiplexer control failed", 0);
     gpio_set_level(I2C_MUX_A0, (channel & 0x01) ? 1 : 0);
@@ -73,6 +83,7 @@ slave_pcb_err_t i2c_write_register(uint8_t device_addr, uint8_t reg, uint16_t va
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "I2C write register 0x%02X failed: %s", reg, esp_err_to_name(ret));
         REPORT_ERROR(SLAVE_PCB_ERR_I2C_FAIL, TAG, "I2C write register failed", ret);
+        selected_channel = I2C_MUX_NO_CHANNEL;  // Bus en erreur: resélectionner le canal
         return SLAVE_PCB_ERR_I2C_FAIL;
     }
     
@@ -87,6 +98,7 @@ slave_pcb_err_t i2c_read_register(uint8_t device_addr, uint8_t reg, uint16_t *va
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "I2C write register address failed: %s", esp_err_to_name(ret));
         REPORT_ERROR(SLAVE_PCB_ERR_I2C_FAIL, TAG, "I2C write register address failed", ret);
+        selected_channel = I2C_MUX_NO_CHANNEL;  // Bus en erreur: resélectionner le canal
         return SLAVE_PCB_ERR_I2C_FAIL;
     }
     
@@ -96,6 +108,7 @@ slave_pcb_err_t i2c_read_register(uint8_t device_addr, uint8_t reg, uint16_t *va
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "I2C read register data failed: %s", esp_err_to_name(ret));
         REPORT_ERROR(SLAVE_PCB_ERR_I2C_FAIL, TAG, "I2C read register data failed", ret);
+        selected_channel = I2C_MUX_NO_CHANNEL;  // Bus en erreur: resélectionner le canal
         return SLAVE_PCB_ERR_I2C_FAIL;
     }
     
@@ -68,33 +68,73 @@ static uart_button_cmd_t parse_uart_command(const char* data) {
     return UART_CMD_UNKNOWN;
 }
 
-static void uart_reader_task(void *pvParameters) {
+// Vérifier les timeouts
+static void check_button_timeout(void) {
+    TickType_t current_time = xTaskGetTickCount();
+    if (current_time - last_cmd_time > pdMS_TO_TICKS(BUTTON_TIMEOUT_MS)) {
+        if (button_states != 0) {
+            ESP_LOGD(TAG, "UART button timeout, clearing all states");
+            button_states = 0;
+        }
+    }
+}
+
+// Une ligne complète est dans le buffer du driver (pattern '\n' détecté)
+static void read_line(void) {
     uint8_t data[128];
-    
+
+    int pos = uart_pattern_pop_pos(UART_NUM);
+    if (pos < 0 || pos >= (int)sizeof(data) - 1) {
+        // File des positions pleine ou ligne trop longue : on repart de zéro
+        ESP_LOGW(TAG, "UART line lost (pattern pos %d)", pos);
+        uart_flush_input(UART_NUM);
+        uart_pattern_queue_reset(UART_NUM, UART_PATTERN_QUEUE_SIZE);
+        return;
+    }
+
+    int len = uart_read_bytes(UART_NUM, data, pos + 1, 0);
+    if (len <= 0) {
+        return;
+    }
+    data[len] = '\0';
+    ESP_LOGD(TAG, "UART received: '%s'", (char*)data);
+
+    // Parser la commande
+    uart_button_cmd_t button_cmd = parse_uart_command((char*)data);
+    if (button_cmd != UART_CMD_UNKNOWN) {
+        // Mettre à jour l'état du bouton
+        button_states |= (1 << button_cmd);
+        last_cmd_time = xTaskGetTickCount();
+        ESP_LOGD(TAG, "Button %d activated via UART", button_cmd);
+    }
+}
+
+// Réveillée par le driver uniquement quand une ligne est complète
+// (ou au plus tard à l'expiration du timeout des boutons)
+static void uart_reader_task(void *pvParameters) {
+    uart_event_t event;
+
     while (1) {
-        int len = uart_read_bytes(UART_NUM, data, sizeof(data) - 1, pdMS_TO_TICKS(50));
-        if (len > 0) {
-            data[len] = '\0';
-            ESP_LOGD(TAG, "UART received: '%s'", (char*)data);
-            
-            // Parser la commande
-            uart_button_cmd_t button_cmd = parse_uart_command((char*)data);
-            if (button_cmd != UART_CMD_UNKNOWN) {
-                // Mettre à jour l'état du bouton
-                button_states |= (1 << button_cmd);
-                last_cmd_time = xTaskGetTickCount();
-                ESP_LOGD(TAG, "Button %d activated via UART", button_cmd);
-            }
-        }
-        
-        // Vérifier les timeouts
-        TickType_t current_time = xTaskGetTickCount();
-        if (current_time - last_cmd_time > pdMS_TO_TICKS(BUTTON_TIMEOUT_MS)) {
-            if (button_states != 0) {
-                ESP_LOGD(TAG, "UART button timeout, clearing all states");
-                button_states = 0;
+        TickType_t wait = (button_states != 0) ? pdMS_TO_TICKS(BUTTON_TIMEOUT_MS) : portMAX_DELAY;
+        if (xQueueReceive(uart_queue, &event, wait) == pdTRUE) {
+            switch (event.type) {
+                case UART_PATTERN_DET:
+                    read_line();
+                    break;
+                case UART_FIFO_OVF:
+                case UART_BUFFER_FULL:
+                    ESP_LOGW(TAG, "UART overflow, flushing input");
+                    uart_flush_input(UART_NUM);
+                    uart_pattern_queue_reset(UART_NUM, UART_PATTERN_QUEUE_SIZE);
+                    xQueueReset(uart_queue);
+                    break;
+                default:
+                    // UART_DATA : les octets restent dans le buffer jusqu'au '\n'
+                    break;
             }
         }
+
+        check_button_timeout();
     }
 }
 
@@ -109,11 +149,15 @@ slave_pcb_err_t uart_manager_init(void) {
         .source_clk = UART_SCLK_DEFAULT,
     };
     
-    ESP_ERROR_CHECK(uart_driver_install(UART_NUM, UART_RX_BUFFER_SIZE, 0, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_driver_install(UART_NUM, UART_RX_BUFFER_SIZE, 0, UART_QUEUE_SIZE, &uart_queue, 0));
     ESP_ERROR_CHECK(uart_param_config(UART_NUM, &uart_config));
     ESP_ERROR_CHECK(uart_set_pin(UART_NUM, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, 
                                 UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
     
+    // Événement UART_PATTERN_DET à chaque fin de ligne (timings en cycles baud)
+    ESP_ERROR_CHECK(uart_enable_pattern_det_baud_intr(UART_NUM, '\n', 1, 9, 0, 0));
+    ESP_ERROR_CHECK(uart_pattern_queue_reset(UART_NUM, UART_PATTERN_QUEUE_SIZE));
+    
     // Initialiser les états
     button_states = 0;
     last_cmd_time = xTaskGetTickCount();
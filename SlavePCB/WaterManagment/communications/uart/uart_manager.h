@@ -18,6 +18,7 @@
 #define UART_BAUD_RATE 115200
 #define UART_RX_BUFFER_SIZE 1024
 #define UART_QUEUE_SIZE 20
+#define UART_PATTERN_QUEUE_SIZE 16   // Positions de '\n' mémorisées par le driver
 
 typedef enum {
     UART_CMD_BUTTON_E1 = 0,
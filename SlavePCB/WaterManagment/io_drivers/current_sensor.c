@@ -6,15 +6,41 @@ static const char *TAG = "CURRENT_SENSOR";
 // INA219 configuration constants
 #define INA219_CONFIG_RESET     0x8000
 #define INA219_CONFIG_BVOLTAGERANGE_32V 0x2000
+#define INA219_CONFIG_BADC_12BIT        0x0180  // 532 us
+#define INA219_CONFIG_SADC_12BIT        0x0018  // 532 us
 #define INA219_CONFIG_MODE_SANDBVOLT_CONTINUOUS 0x0007
 
+#define CURRENT_SENSOR_TASK_STACK   3072
+#define CURRENT_SENSOR_TASK_PRIO    4
+
+typedef struct {
+    bool present;                       // Shunt on this channel
+    bool calibrated;
+    uint16_t cal;                       // Value written in INA219_REG_CALIBRATION
+    float current_lsb_a;
+    uint32_t retry_at_ms;               // Channel in error: skipped until then
+    current_sample_t history[CURRENT_SENSOR_HISTORY_SIZE];
+    uint8_t head;                       // Next slot written
+    uint8_t count;
+    current_sensor_stats_t stats;
+} current_channel_t;
+
+static current_channel_t channels[CURRENT_SENSOR_CHANNELS];
+static portMUX_TYPE channels_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t scan_task_handle = NULL;
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
 static float round_up_lsb(float lsb, float step) {
     if (lsb <= 0.0f) return step;
     int n = (int)ceilf(lsb / step);
     return n * step;
 }
 
-static slave_pcb_err_t ina219_calibrate(uint8_t channel, float shunt_resistor_ohms, float max_expected_current_a) {
+static slave_pcb_err_t ina219_calibrate(float shunt_resistor_ohms, float max_expected_current_a,
+                                        uint16_t *cal_out, float *current_lsb_out) {
     if (shunt_resistor_ohms <= 0.0f || max_expected_current_a <= 0.0f) {
         return SLAVE_PCB_ERR_INVALID_ARG;
     }
@@ -24,9 +50,11 @@ static slave_pcb_err_t ina219_calibrate(uint8_t channel, float shunt_resistor_oh
     if (ret != SLAVE_PCB_OK) return ret;
     vTaskDelay(pdMS_TO_TICKS(10));
 
-    // Config: 32V bus range + PGA = ±80mV (0x0800) + continuous
+    // Config: 32V bus range + PGA = ±80mV (0x0800) + 12 bits + continuous
     uint16_t config = INA219_CONFIG_BVOLTAGERANGE_32V |
                       0x0800 |  // PGA = ±80 mV
+                      INA219_CONFIG_BADC_12BIT |
+                      INA219_CONFIG_SADC_12BIT |
                       INA219_CONFIG_MODE_SANDBVOLT_CONTINUOUS;
     ret = i2c_write_register(CURRENT_SENSOR_ADDR, INA219_REG_CONFIG, config);
     if (ret != SLAVE_PCB_OK) return ret;
@@ -41,16 +69,18 @@ static slave_pcb_err_t ina219_calibrate(uint8_t channel, float shunt_resistor_oh
     // CAL
     float cal_f = 0.04096f / (current_lsb * shunt_resistor_ohms);
     uint32_t cal_u32 = (uint32_t)floorf(cal_f);
-    if (cal_u32 < 1) cal_u32 = 1;
+    if (cal_u32 < 2) cal_u32 = 2;
     if (cal_u32 > 0xFFFE) cal_u32 = 0xFFFE;
-    uint16_t cal = (uint16_t)cal_u32;
+    // Bit 0 of CAL is void (reads back 0): write it cleared and take the LSB
+    // of the value actually used, or the verification would always fail
+    uint16_t cal = (uint16_t)(cal_u32 & 0xFFFE);
+    current_lsb = 0.04096f / (cal * shunt_resistor_ohms);
 
     ret = i2c_write_register(CURRENT_SENSOR_ADDR, INA219_REG_CALIBRATION, cal);
-    return ret;
-}
+    if (ret != SLAVE_PCB_OK) return ret;
 
-slave_pcb_err_t current_sensor_init(void) {
-    ESP_LOGI(TAG, "Current sensor manager initialized");
+    *cal_out = cal;
+    *current_lsb_out = current_lsb;
     return SLAVE_PCB_OK;
 }
 
@@ -76,44 +106,201 @@ float get_max_current_for_channel(uint8_t channel) {
     }
 }
 
-slave_pcb_err_t current_sensor_read_channel(uint8_t channel, float *current_ma) {
+// ============================================================================
+// SCAN TASK
+// ============================================================================
+
+// I2C error: the channel is calibrated again at the next attempt (INA219 may
+// have been power-cycled and lost its calibration)
+static void channel_failed(uint8_t channel, current_channel_t *ch) {
+    ch->calibrated = false;
+    ch->retry_at_ms = now_ms() + CURRENT_SENSOR_RETRY_MS;
+    portENTER_CRITICAL(&channels_lock);
+    ch->stats.errors++;
+    portEXIT_CRITICAL(&channels_lock);
+    ESP_LOGD(TAG, "Channel %d: I2C error, retry in %d ms", channel, CURRENT_SENSOR_RETRY_MS);
+}
+
+static void scan_channel(uint8_t channel, bool verify) {
+    current_channel_t *ch = &channels[channel];
+    if (!ch->present || (int32_t)(now_ms() - ch->retry_at_ms) < 0) {
+        return;
+    }
+
+    if (i2c_set_multiplexer_channel(channel) != SLAVE_PCB_OK) {
+        channel_failed(channel, ch);
+        return;
+    }
+
+    if (ch->calibrated && verify) {
+        // Calibration register back to 0 after a power-on reset of the INA219
+        uint16_t cal;
+        if (i2c_read_register(CURRENT_SENSOR_ADDR, INA219_REG_CALIBRATION, &cal) != SLAVE_PCB_OK) {
+            channel_failed(channel, ch);
+            return;
+        }
+        if (cal != ch->cal) {
+            ESP_LOGW(TAG, "Channel %d: calibration lost (0x%04X), reprogramming", channel, cal);
+            ch->calibrated = false;
+        }
+    }
+
+    if (!ch->calibrated) {
+        uint16_t cal;
+        float current_lsb;
+        if (ina219_calibrate(get_shunt_resistor_for_channel(channel), get_max_current_for_channel(channel),
+                             &cal, &current_lsb) != SLAVE_PCB_OK) {
+            channel_failed(channel, ch);
+            return;
+        }
+        ch->cal = cal;
+        ch->current_lsb_a = current_lsb;
+        ch->calibrated = true;
+        portENTER_CRITICAL(&channels_lock);
+        ch->stats.calibrations++;
+        portEXIT_CRITICAL(&channels_lock);
+        ESP_LOGI(TAG, "Channel %d calibrated (CAL 0x%04X, LSB %.0f uA)", channel, cal, current_lsb * 1e6f);
+        return;     // First conversion not finished yet
+    }
+
+    // Nouvelle conversion ?
+    uint16_t bus;
+    if (i2c_read_register(CURRENT_SENSOR_ADDR, INA219_REG_BUSVOLTAGE, &bus) != SLAVE_PCB_OK) {
+        channel_failed(channel, ch);
+        return;
+    }
+    if (!(bus & INA219_BUS_CNVR)) {
+        portENTER_CRITICAL(&channels_lock);
+        ch->stats.not_ready++;
+        portEXIT_CRITICAL(&channels_lock);
+        return;
+    }
+
+    uint16_t raw_current, power;
+    if (i2c_read_register(CURRENT_SENSOR_ADDR, INA219_REG_CURRENT, &raw_current) != SLAVE_PCB_OK ||
+        i2c_read_register(CURRENT_SENSOR_ADDR, INA219_REG_POWER, &power) != SLAVE_PCB_OK) {  // POWER clears CNVR
+        channel_failed(channel, ch);
+        return;
+    }
+
+    if (bus & INA219_BUS_OVF) {
+        portENTER_CRITICAL(&channels_lock);
+        ch->stats.overflows++;
+        portEXIT_CRITICAL(&channels_lock);
+        return;
+    }
+
+    current_sample_t sample = {
+        .current_ma = (float)(int16_t)raw_current * ch->current_lsb_a * 1000.0f,
+        .timestamp_ms = now_ms(),
+    };
+
+    portENTER_CRITICAL(&channels_lock);
+    ch->history[ch->head] = sample;
+    ch->head = (ch->head + 1) % CURRENT_SENSOR_HISTORY_SIZE;
+    if (ch->count < CURRENT_SENSOR_HISTORY_SIZE) ch->count++;
+    ch->stats.samples++;
+    portEXIT_CRITICAL(&channels_lock);
+
+    ESP_LOGV(TAG, "Channel %d: %.1f mA", channel, sample.current_ma);
+}
+
+static void current_sensor_scan_task(void *arg) {
+    uint32_t scans = 0;
+
+    while (1) {
+        bool verify = (scans % CURRENT_SENSOR_VERIFY_SCANS) == CURRENT_SENSOR_VERIFY_SCANS - 1;
+        for (uint8_t channel = 0; channel < CURRENT_SENSOR_CHANNELS; channel++) {
+            scan_channel(channel, verify);
+        }
+        scans++;
+        vTaskDelay(pdMS_TO_TICKS(CURRENT_SENSOR_SCAN_PERIOD_MS));
+    }
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+slave_pcb_err_t current_sensor_init(void) {
+    if (scan_task_handle) {
+        return SLAVE_PCB_OK;
+    }
+
+    memset(channels, 0, sizeof(channels));
+    int present = 0;
+    for (uint8_t channel = 0; channel < CURRENT_SENSOR_CHANNELS; channel++) {
+        channels[channel].present = get_shunt_resistor_for_channel(channel) > 0.0f;
+        if (channels[channel].present) present++;
+    }
+
+    if (xTaskCreate(current_sensor_scan_task, "current_scan", CURRENT_SENSOR_TASK_STACK, NULL,
+                    CURRENT_SENSOR_TASK_PRIO, &scan_task_handle) != pdPASS) {
+        REPORT_ERROR(SLAVE_PCB_ERR_MEMORY, TAG, "Failed to create current scan task", 0);
+        return SLAVE_PCB_ERR_MEMORY;
+    }
+
+    ESP_LOGI(TAG, "Current sensor manager initialized (%d channels scanned every %d ms)",
+             present, CURRENT_SENSOR_SCAN_PERIOD_MS);
+    return SLAVE_PCB_OK;
+}
+
+slave_pcb_err_t current_sensor_get_latest(uint8_t channel, float *current_ma, uint32_t *timestamp_ms) {
     if (!current_ma) {
         REPORT_ERROR(SLAVE_PCB_ERR_INVALID_ARG, TAG, "Null pointer for current reading", channel);
         return SLAVE_PCB_ERR_INVALID_ARG;
     }
-
-    float shunt_resistor = get_shunt_resistor_for_channel(channel);
-    if (shunt_resistor <= 0.0f) {
+    if (channel >= CURRENT_SENSOR_CHANNELS || !channels[channel].present) {
         *current_ma = 0.0f;
+        if (timestamp_ms) *timestamp_ms = now_ms();
         return SLAVE_PCB_OK;
     }
 
-    // Set multiplexer channel
-    slave_pcb_err_t ret = i2c_set_multiplexer_channel(channel);
-    if (ret != SLAVE_PCB_OK) return ret;
+    current_channel_t *ch = &channels[channel];
+    current_sample_t last = {0};
+    bool has_sample;
 
-    // Calibrate sensor
-    ret = ina219_calibrate(channel, shunt_resistor,get_max_current_for_channel(channel));
-    if (ret != SLAVE_PCB_OK) {
-        *current_ma = 0.0f;
-        return ret;
+    portENTER_CRITICAL(&channels_lock);
+    has_sample = ch->count > 0;
+    if (has_sample) {
+        last = ch->history[(ch->head + CURRENT_SENSOR_HISTORY_SIZE - 1) % CURRENT_SENSOR_HISTORY_SIZE];
     }
+    portEXIT_CRITICAL(&channels_lock);
 
-    // Read current
-    uint16_t raw_current;
-    ret = i2c_read_register(CURRENT_SENSOR_ADDR, INA219_REG_CURRENT, &raw_current);
-    if (ret != SLAVE_PCB_OK) {
-        *current_ma = 0.0f;
-        return ret;
+    *current_ma = last.current_ma;
+    if (timestamp_ms) *timestamp_ms = last.timestamp_ms;
+
+    if (!has_sample || now_ms() - last.timestamp_ms > CURRENT_SENSOR_STALE_MS) {
+        return SLAVE_PCB_ERR_TIMEOUT;
     }
+    return SLAVE_PCB_OK;
+}
 
-    // Convert to mA
-    int16_t signed_current = (int16_t)raw_current;
-    float max_current_a = get_max_current_for_channel(channel);
-    float current_lsb = max_current_a / 32768.0f;
-    *current_ma = (float)signed_current * current_lsb * 1000.0f;
+int current_sensor_get_history(uint8_t channel, current_sample_t *samples, int max_samples) {
+    if (!samples || max_samples <= 0 || channel >= CURRENT_SENSOR_CHANNELS) {
+        return 0;
+    }
 
-    ESP_LOGD(TAG, "Channel %d: %.1f mA", channel, *current_ma);
-    return SLAVE_PCB_OK;
+    current_channel_t *ch = &channels[channel];
+    portENTER_CRITICAL(&channels_lock);
+    int n = ch->count < max_samples ? ch->count : max_samples;
+    int first = (ch->head + CURRENT_SENSOR_HISTORY_SIZE - n) % CURRENT_SENSOR_HISTORY_SIZE;
+    for (int i = 0; i < n; i++) {
+        samples[i] = ch->history[(first + i) % CURRENT_SENSOR_HISTORY_SIZE];
+    }
+    portEXIT_CRITICAL(&channels_lock);
+    return n;
 }
 
+void current_sensor_get_stats(uint8_t channel, current_sensor_stats_t *stats) {
+    if (!stats) {
+        return;
+    }
+    if (channel >= CURRENT_SENSOR_CHANNELS) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    portENTER_CRITICAL(&channels_lock);
+    *stats = channels[channel].stats;
+    portEXIT_CRITICAL(&channels_lock);
+}
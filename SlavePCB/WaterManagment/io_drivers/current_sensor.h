@@ -2,22 +2,32 @@
 #define CURRENT_SENSOR_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
 #include <math.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "../communications/i2c/i2c_manager.h"
 #include "../common_includes/error_manager.h"
 
 #define CURRENT_SENSOR_ADDR  0x40
 
-
-
-
-
+// Background scan of the INA219 behind the I2C multiplexer
+// Each channel is calibrated once, then a task reads the channels round-robin
+// when the conversion-ready bit is set and keeps the recent samples per channel.
+// Readers only look up the last samples and never touch the I2C bus.
+#define CURRENT_SENSOR_CHANNELS         8       // Multiplexer channels 0..7
+#define CURRENT_SENSOR_HISTORY_SIZE     16      // Samples kept per channel
+#define CURRENT_SENSOR_SCAN_PERIOD_MS   20      // Pause between two scans of all the channels
+#define CURRENT_SENSOR_RETRY_MS         1000    // Channel in error: next attempt
+#define CURRENT_SENSOR_VERIFY_SCANS     250     // Calibration register checked every N scans (~5 s)
+#define CURRENT_SENSOR_STALE_MS         500     // Older last sample: channel not scanned anymore
+#define CURRENT_SENSOR_CONVERSION_MS    2       // Shunt + bus conversion at 12 bits (2 x 532 us), rounded up
 // INA219 registers
 #define INA219_REG_CONFIG       0x00
 #define INA219_REG_SHUNTVOLTAGE 0x01
@@ -26,6 +36,10 @@
 #define INA219_REG_CURRENT      0x04
 #define INA219_REG_CALIBRATION  0x05
 
+// INA219 bus voltage register flags
+#define INA219_BUS_CNVR         0x0002  // Conversion ready, cleared by reading POWER
+#define INA219_BUS_OVF          0x0001  // Math overflow
+
 // Shunt resistor values
 #define SHUNT_RESISTOR_ELECTROVALVE 0.1f
 #define SHUNT_RESISTOR_PUMP_PE_PV 0.08f
@@ -41,8 +55,40 @@
 #define CURRENT_THRESHOLD_PUMP_PV_EMPTY_MA 100
 #define CURRENT_THRESHOLD_PUMP_PV_WATER_MA 500
 
+typedef struct {
+    float current_ma;
+    uint32_t timestamp_ms;
+} current_sample_t;
+
+typedef struct {
+    uint32_t samples;                   // Conversions read
+    uint32_t not_ready;                 // Polls without a new conversion
+    uint32_t overflows;                 // Conversions dropped (OVF set)
+    uint32_t errors;                    // I2C errors
+    uint32_t calibrations;              // Calibrations written (1 + reprogrammed after errors)
+} current_sensor_stats_t;
+
+/**
+ * @brief Start the scan task (the channels are calibrated by the task)
+ * @return SLAVE_PCB_OK, SLAVE_PCB_ERR_MEMORY
+ */
 slave_pcb_err_t current_sensor_init(void);
-slave_pcb_err_t current_sensor_read_channel(uint8_t channel, float *current_ma);
+
+/**
+ * @brief Last current measured on a channel, without I2C access
+ * @param timestamp_ms Time of the sample (esp_timer ms), may be NULL
+ * @return SLAVE_PCB_OK, SLAVE_PCB_ERR_INVALID_ARG, SLAVE_PCB_ERR_TIMEOUT (no sample
+ *         for CURRENT_SENSOR_STALE_MS, *current_ma is then the last value or 0)
+ */
+slave_pcb_err_t current_sensor_get_latest(uint8_t channel, float *current_ma, uint32_t *timestamp_ms);
+
+/**
+ * @brief Copy the recent samples of a channel, oldest first
+ * @return Number of samples copied
+ */
+int current_sensor_get_history(uint8_t channel, current_sample_t *samples, int max_samples);
+
+void current_sensor_get_stats(uint8_t channel, current_sensor_stats_t *stats);
 float get_shunt_resistor_for_channel(uint8_t channel);
 
 #endif
\ No newline at end of file
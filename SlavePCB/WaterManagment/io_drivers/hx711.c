@@ -0,0 +1,319 @@
+#include "hx711.h"
+#include <string.h>
+#include "esp_timer.h"
+#include "soc/gpio_reg.h"   // GPIO_IN_REG, GPIO_IN1_REG
+#include "soc/soc.h"        // REG_READ
+
+static const char *TAG = "HX711";
+
+// All DT lines are GPIO32-48: one read of GPIO_IN1_REG samples the five HX711
+#define HX711_DT_BIT(pin)       (1UL << ((pin) - 32))
+#define HX711_ALL_CHANNELS      ((1UL << HX711_CHANNELS) - 1)
+#define HX711_BITS              24
+#define HX711_PULSES            25      // 24 data bits + 1 = gain 128, channel A
+_Static_assert(HX_711_DT_A >= 32 && HX_711_DT_B >= 32 && HX_711_DT_C >= 32 &&
+               HX_711_DT_D >= 32 && HX_711_DT_E >= 32 && HX_711_SCK < 32,
+               "HX711 capture needs DT pins on GPIO32+ and SCK below GPIO32");
+
+#define HX711_CAPTURE_WAIT_TICKS 2    // Last edge interrupt after the RMT done event
+
+static const int dt_pins[HX711_CHANNELS] = {
+    HX_711_DT_A, HX_711_DT_B, HX_711_DT_C, HX_711_DT_D, HX_711_DT_E
+};
+
+static rmt_channel_handle_t sck_channel = NULL;
+static rmt_encoder_handle_t copy_encoder = NULL;
+static QueueHandle_t sample_queue = NULL;
+static TaskHandle_t acquisition_task_handle = NULL;
+
+static rmt_symbol_word_t read_pulses[HX711_PULSES];
+static const rmt_symbol_word_t reset_pulse = {
+    .level0 = 1, .duration0 = HX711_RESET_HIGH_US, .level1 = 0, .duration1 = 1,
+};
+
+// Shared with the ISRs
+static volatile bool capturing = false;
+static volatile bool reset_requested = false;
+static volatile uint32_t ready_mask = 0;
+static volatile uint32_t edge_count = 0;
+static volatile bool edge_late = false;
+static uint32_t edge_bits[HX711_BITS];
+
+static hx711_stats_t stats = {0};
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief DRDY: falling edge of a DT line (ignored while its data bits are clocked out)
+ */
+static void dt_isr_handler(void *arg) {
+    uint32_t channel = (uint32_t)(uintptr_t)arg;
+    if (capturing || (REG_READ(GPIO_IN1_REG) & HX711_DT_BIT(dt_pins[channel]))) {
+        return;     // Data bit or stale edge
+    }
+
+    ready_mask |= 1UL << channel;
+    if (ready_mask == HX711_ALL_CHANNELS) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(acquisition_task_handle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+/**
+ * @brief SCK falling edge: the five DT lines hold the bit shifted out on the rising edge
+ */
+static void sck_isr_handler(void *arg) {
+    (void) arg;
+    if (!capturing) {
+        return;     // Reset pulse
+    }
+
+    uint32_t in = REG_READ(GPIO_IN1_REG);
+    uint32_t n = edge_count;
+    if (n < HX711_BITS) {
+        edge_bits[n] = in;
+    }
+    // SCK high again: the next bit may already be shifted out
+    if (REG_READ(GPIO_IN_REG) & (1UL << HX_711_SCK)) {
+        edge_late = true;
+    }
+    edge_count = n + 1;
+
+    if (n + 1 == HX711_PULSES) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(acquisition_task_handle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+/**
+ * @brief Channels with DT low (conversion ready), for edges missed before the ISR was armed
+ */
+static uint32_t read_ready_levels(void) {
+    uint32_t in = REG_READ(GPIO_IN1_REG);
+    uint32_t ready = 0;
+    for (int ch = 0; ch < HX711_CHANNELS; ch++) {
+        if (!(in & HX711_DT_BIT(dt_pins[ch]))) {
+            ready |= 1UL << ch;
+        }
+    }
+    return ready;
+}
+
+static void queue_sample(const hx711_sample_t *sample) {
+    bool overflow = false;
+    if (xQueueSend(sample_queue, sample, 0) != pdPASS) {
+        hx711_sample_t oldest;
+        xQueueReceive(sample_queue, &oldest, 0);
+        xQueueSend(sample_queue, sample, 0);
+        overflow = true;
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    stats.samples++;
+    if (overflow) stats.overflows++;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+/**
+ * @brief Clock out one conversion of every HX711 and queue it
+ * @param ready Channels ready when the burst starts (the others are clocked but dropped)
+ */
+static void run_burst(uint32_t ready) {
+    rmt_transmit_config_t tx_config = { .loop_count = 0, .flags.eot_level = 0 };
+
+    edge_count = 0;
+    edge_late = false;
+    capturing = true;
+
+    esp_err_t err = rmt_transmit(sck_channel, copy_encoder, read_pulses, sizeof(read_pulses), &tx_config);
+    if (err == ESP_OK) {
+        err = rmt_tx_wait_all_done(sck_channel, pdMS_TO_TICKS(20));
+    }
+    // The last edge interrupt may run after the RMT done event
+    if (err == ESP_OK && edge_count < HX711_PULSES) {
+        ulTaskNotifyTake(pdTRUE, HX711_CAPTURE_WAIT_TICKS);
+    }
+
+    capturing = false;
+    ready_mask = 0;
+
+    bool corrupted = (err != ESP_OK) || edge_count != HX711_PULSES || edge_late;
+    portENTER_CRITICAL(&stats_lock);
+    if (corrupted) stats.corrupted++;
+    if (ready != HX711_ALL_CHANNELS) stats.partial++;
+    portEXIT_CRITICAL(&stats_lock);
+    if (corrupted) {
+        ESP_LOGD(TAG, "Burst dropped (edges=%lu, late=%d, err=%s)", edge_count, edge_late, esp_err_to_name(err));
+        return;
+    }
+
+    hx711_sample_t sample = {
+        .valid_mask = ready,
+        .timestamp_ms = esp_timer_get_time() / 1000,
+    };
+    for (int ch = 0; ch < HX711_CHANNELS; ch++) {
+        uint32_t dt_bit = HX711_DT_BIT(dt_pins[ch]);
+        uint32_t value = 0;
+        for (int i = 0; i < HX711_BITS; i++) {
+            value = (value << 1) | ((edge_bits[i] & dt_bit) ? 1 : 0);
+        }
+
+        // Convert to signed value (24-bit two's complement)
+        if (value & 0x800000) {
+            value |= 0xFF000000; // Sign extend
+        }
+        sample.raw[ch] = (int32_t)value;
+    }
+    queue_sample(&sample);
+}
+
+static void run_reset(void) {
+    rmt_transmit_config_t tx_config = { .loop_count = 0, .flags.eot_level = 0 };
+
+    ESP_LOGD(TAG, "Resetting HX711 modules");
+    if (rmt_transmit(sck_channel, copy_encoder, &reset_pulse, sizeof(reset_pulse), &tx_config) == ESP_OK) {
+        rmt_tx_wait_all_done(sck_channel, pdMS_TO_TICKS(20));
+    }
+    ready_mask = 0;
+    reset_requested = false;
+    hx711_flush();
+}
+
+static void hx711_acquisition_task(void *pvParameters) {
+    ESP_LOGI(TAG, "HX711 acquisition task started");
+
+    while (1) {
+        bool woken = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(HX711_READY_TIMEOUT_MS)) > 0;
+
+        if (reset_requested) {
+            run_reset();
+            continue;
+        }
+
+        uint32_t ready;
+        if (ready_mask == HX711_ALL_CHANNELS) {
+            ready = HX711_ALL_CHANNELS;
+        } else if (woken) {
+            continue;       // Late notification of the previous burst
+        } else {
+            // Timeout: read the channels that are ready (missed edge or HX711 missing)
+            ready = read_ready_levels();
+        }
+        if (ready == 0) {
+            portENTER_CRITICAL(&stats_lock);
+            stats.timeouts++;
+            portEXIT_CRITICAL(&stats_lock);
+            continue;
+        }
+        run_burst(ready);
+    }
+}
+
+slave_pcb_err_t hx711_init(void) {
+    ESP_LOGI(TAG, "Initializing HX711 acquisition");
+
+    for (int i = 0; i < HX711_PULSES; i++) {
+        read_pulses[i] = (rmt_symbol_word_t){
+            .level0 = 1, .duration0 = HX711_SCK_HIGH_US, .level1 = 0, .duration1 = HX711_SCK_LOW_US,
+        };
+    }
+
+    sample_queue = xQueueCreate(HX711_QUEUE_LENGTH, sizeof(hx711_sample_t));
+    if (sample_queue == NULL) {
+        REPORT_ERROR(SLAVE_PCB_ERR_MEMORY, TAG, "Failed to create HX711 sample queue", 0);
+        return SLAVE_PCB_ERR_INIT_FAIL;
+    }
+
+    // SCK driven by the RMT; loop back keeps the pad input for the edge interrupt
+    rmt_tx_channel_config_t tx_config = {
+        .gpio_num = HX_711_SCK,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = 1000000,           // 1 tick = 1 us
+        .mem_block_symbols = 48,
+        .trans_queue_depth = 2,
+        .flags.io_loop_back = true,
+    };
+    esp_err_t ret = rmt_new_tx_channel(&tx_config, &sck_channel);
+    if (ret == ESP_OK) {
+        rmt_copy_encoder_config_t encoder_config = {};
+        ret = rmt_new_copy_encoder(&encoder_config, &copy_encoder);
+    }
+    if (ret == ESP_OK) {
+        ret = rmt_enable(sck_channel);
+    }
+    if (ret != ESP_OK) {
+        REPORT_ERROR(SLAVE_PCB_ERR_INIT_FAIL, TAG, "Failed to configure HX711 SCK RMT channel", ret);
+        return SLAVE_PCB_ERR_INIT_FAIL;
+    }
+
+    // Task before the interrupts: the ISRs notify it
+    if (xTaskCreate(hx711_acquisition_task, "hx711", 3072, NULL, 6, &acquisition_task_handle) != pdPASS) {
+        REPORT_ERROR(SLAVE_PCB_ERR_MEMORY, TAG, "Failed to create HX711 task", 0);
+        return SLAVE_PCB_ERR_INIT_FAIL;
+    }
+
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {    // Already installed is fine
+        REPORT_ERROR(SLAVE_PCB_ERR_INIT_FAIL, TAG, "Failed to install GPIO ISR service", ret);
+        return SLAVE_PCB_ERR_INIT_FAIL;
+    }
+
+    ret = gpio_set_intr_type(HX_711_SCK, GPIO_INTR_NEGEDGE);
+    if (ret == ESP_OK) {
+        ret = gpio_isr_handler_add(HX_711_SCK, sck_isr_handler, NULL);
+    }
+    for (int ch = 0; ch < HX711_CHANNELS && ret == ESP_OK; ch++) {
+        ret = gpio_set_intr_type(dt_pins[ch], GPIO_INTR_NEGEDGE);
+        if (ret == ESP_OK) {
+            ret = gpio_isr_handler_add(dt_pins[ch], dt_isr_handler, (void *)(uintptr_t)ch);
+        }
+        if (ret == ESP_OK) {
+            ret = gpio_intr_enable(dt_pins[ch]);
+        }
+    }
+    if (ret == ESP_OK) {
+        ret = gpio_intr_enable(HX_711_SCK);
+    }
+    if (ret != ESP_OK) {
+        REPORT_ERROR(SLAVE_PCB_ERR_INIT_FAIL, TAG, "Failed to configure HX711 interrupts", ret);
+        return SLAVE_PCB_ERR_INIT_FAIL;
+    }
+
+    ESP_LOGI(TAG, "HX711 acquisition ready (SCK %d/%d us)", HX711_SCK_HIGH_US, HX711_SCK_LOW_US);
+    return SLAVE_PCB_OK;
+}
+
+slave_pcb_err_t hx711_read_sample(hx711_sample_t *sample, uint32_t timeout_ms) {
+    if (!sample || !sample_queue) {
+        return SLAVE_PCB_ERR_INVALID_ARG;
+    }
+    if (xQueueReceive(sample_queue, sample, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return SLAVE_PCB_ERR_TIMEOUT;
+    }
+    return SLAVE_PCB_OK;
+}
+
+void hx711_flush(void) {
+    if (sample_queue) {
+        xQueueReset(sample_queue);
+    }
+}
+
+slave_pcb_err_t hx711_reset(void) {
+    if (!acquisition_task_handle) {
+        return SLAVE_PCB_ERR_STATE_INVALID;
+    }
+    reset_requested = true;
+    xTaskNotifyGive(acquisition_task_handle);
+    return SLAVE_PCB_OK;
+}
+
+void hx711_get_stats(hx711_stats_t *stats_out) {
+    if (!stats_out) {
+        return;
+    }
+    portENTER_CRITICAL(&stats_lock);
+    *stats_out = stats;
+    portEXIT_CRITICAL(&stats_lock);
+}
@@ -0,0 +1,74 @@
+#ifndef HX711_H
+#define HX711_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "driver/rmt_tx.h"
+
+#include "sdkconfig.h"
+#include "gpio_pinout.h"
+#include "../common_includes/error_manager.h"
+
+// HX711 acquisition without bit-banging
+// The RMT generates the 25 SCK pulses of a read on the shared clock line.
+// The falling edge of DT (DRDY) starts a burst and each SCK falling edge
+// samples the five DT lines with one GPIO_IN1_REG read. Samples go to a queue.
+// Interrupts are never masked and the CPU never waits in a loop.
+
+#define HX711_CHANNELS          5       // DT_A..DT_E, same order as tank_id_t
+#define HX711_QUEUE_LENGTH      8       // Samples kept when the reader is late (oldest dropped)
+
+// SCK timing (RMT at 1 MHz): high < 50 us (60 us = power down), low long
+// enough for the edge interrupt to sample the bit before the next shift
+#define HX711_SCK_HIGH_US       2
+#define HX711_SCK_LOW_US        48
+#define HX711_RESET_HIGH_US     100     // SCK high > 60 us: power down and reset
+
+#define HX711_READY_TIMEOUT_MS  150     // Conversion period is 100 ms at 10 SPS
+
+typedef struct {
+    int32_t raw[HX711_CHANNELS];        // Sign-extended 24-bit value
+    uint8_t valid_mask;                 // Channels ready when the burst started
+    uint32_t timestamp_ms;
+} hx711_sample_t;
+
+typedef struct {
+    uint32_t samples;                   // Samples queued
+    uint32_t partial;                   // Bursts started without every channel ready
+    uint32_t corrupted;                 // Bursts dropped (edge interrupt late or missed)
+    uint32_t overflows;                 // Oldest sample dropped, queue full
+    uint32_t timeouts;                  // No channel ready within HX711_READY_TIMEOUT_MS
+} hx711_stats_t;
+
+/**
+ * @brief Start the HX711 acquisition (RMT clock, DRDY interrupts, acquisition task)
+ * @return SLAVE_PCB_OK, SLAVE_PCB_ERR_INIT_FAIL
+ */
+slave_pcb_err_t hx711_init(void);
+
+/**
+ * @brief Get the next sample of the five channels
+ * @param timeout_ms Wait for a sample (0 = no wait)
+ * @return SLAVE_PCB_OK, SLAVE_PCB_ERR_TIMEOUT
+ */
+slave_pcb_err_t hx711_read_sample(hx711_sample_t *sample, uint32_t timeout_ms);
+
+/**
+ * @brief Drop the queued samples (next read is a fresh conversion)
+ */
+void hx711_flush(void);
+
+/**
+ * @brief Power-cycle all the HX711 (done by the acquisition task between bursts)
+ */
+slave_pcb_err_t hx711_reset(void);
+
+void hx711_get_stats(hx711_stats_t *stats);
+
+#endif // HX711_H
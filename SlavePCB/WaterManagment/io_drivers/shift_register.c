@@ -6,6 +6,11 @@ SemaphoreHandle_t output_mutex = NULL;
 
 // Current output state buffer
 static uint8_t shift_register_data[SHIFT_REG_NUM_REGISTERS] = {0};
+static bool output_dirty = false;           // Buffer changed since the last transfer
+
+static spi_device_handle_t spi_handle = NULL;
+static uint8_t *spi_tx_buffer = NULL;       // DMA capable
+static TaskHandle_t flush_task_handle = NULL;
 
 // Mapping table for devices to shift register bits
 static const device_bit_mapping_t device_mapping[DEVICE_MAX] = {
@@ -37,52 +42,54 @@ static const device_bit_mapping_t device_mapping[DEVICE_MAX] = {
 
 ////////////////////////////////////////// Internal Functions //////////////////////////////////////////
 /**
- * @brief Shift out data to all registers in the chain
+ * @brief Shift out data to all registers in the chain (output_mutex taken)
+ * @note One SPI transfer by DMA, the calling task is blocked, not the CPU
  */
 static slave_pcb_err_t _shift_out_data(void) {
     ESP_LOGD(TAG, "Shifting out data to registers");
 
     // NOTE: Keep outputs enabled during shift to avoid visible glitches
-    // Modern shift registers can handle this well with proper timing
-
-    // Ensure all control lines are in proper state
-    gpio_set_level(REG_DS, 0);    // Data line low initially
-    gpio_set_level(REG_STCP, 0);  // Storage clock low
-    gpio_set_level(REG_SHCP, 0);  // Shift clock low
-    esp_rom_delay_us(10); // Let signals stabilize
-
-    // Shift data starting from the last register (furthest from MCU)
-    for (int reg = SHIFT_REG_NUM_REGISTERS - 1; reg >= 0; reg--) {
-        uint8_t data = shift_register_data[reg];
-        
-        // Shift out 8 bits, MSB first
-        for (int bit = 7; bit >= 0; bit--) {
-            // Set data line with proper setup time
-            gpio_set_level(REG_DS, (data & (1 << bit)) ? 1 : 0);
-            esp_rom_delay_us(5); // Increased setup time for data stability
-            
-            // Clock pulse with proper timing
-            gpio_set_level(REG_SHCP, 1);
-            esp_rom_delay_us(5); // Increased clock high time
-            gpio_set_level(REG_SHCP, 0);
-            esp_rom_delay_us(5); // Increased clock low time
-        }
+    // Data from the last register (furthest from MCU), MSB first
+    for (int reg = 0; reg < SHIFT_REG_NUM_REGISTERS; reg++) {
+        spi_tx_buffer[reg] = shift_register_data[SHIFT_REG_NUM_REGISTERS - 1 - reg];
     }
 
-    // Ensure data line is stable before latching
-    gpio_set_level(REG_DS, 0); // Set to known state
-    esp_rom_delay_us(10); // Increased stabilization time
-
-    // Latch data to output registers with proper timing
-    gpio_set_level(REG_STCP, 1);
-    esp_rom_delay_us(10); // Increased latch pulse width
-    gpio_set_level(REG_STCP, 0);
-    esp_rom_delay_us(10); // Increased latch setup time
+    // CS (STCP) rises at the end of the transfer and latches the outputs
+    spi_transaction_t trans = {
+        .length = SHIFT_REG_TOTAL_BITS,
+        .tx_buffer = spi_tx_buffer,
+    };
+    esp_err_t err = spi_device_transmit(spi_handle, &trans);
+    if (err != ESP_OK) {
+        REPORT_ERROR(SLAVE_PCB_ERR_SPI_FAIL, TAG, "Shift register transfer failed", err);
+        // Outputs not latched: the flush task tries again
+        output_dirty = true;
+        if (flush_task_handle) {
+            xTaskNotifyGive(flush_task_handle);
+        }
+        return SLAVE_PCB_ERR_SPI_FAIL;
+    }
 
+    output_dirty = false;
     ESP_LOGD(TAG, "Data shifted out successfully");
     return SLAVE_PCB_OK;
 }
 
+/**
+ * @brief Send the changes of a tick in one transfer, until it succeeds
+ */
+static void _flush_task(void *arg) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // Les autres changements de ce tick partent dans le même transfert
+        vTaskDelay(pdMS_TO_TICKS(SHIFT_REG_BATCH_MS));
+        while (shift_register_flush() != SLAVE_PCB_OK) {
+            // Transfert raté ou mutex occupé: les sorties restent à envoyer
+            vTaskDelay(pdMS_TO_TICKS(SHIFT_REG_RETRY_MS));
+        }
+    }
+}
+
 /**
  * @brief Set bit in shift register data buffer
  */
@@ -120,6 +127,7 @@ static slave_pcb_err_t _shift_register_set_output_state(device_type_t device, bo
              state ? "ON" : "OFF");
 
     // Set the bit in the register data buffer
+    uint8_t previous = shift_register_data[mapping->register_index];
     slave_pcb_err_t ret = _set_register_bit(mapping->register_index, 
                                           mapping->bit_position, state);
     if (ret != SLAVE_PCB_OK) {
@@ -127,11 +135,10 @@ static slave_pcb_err_t _shift_register_set_output_state(device_type_t device, bo
         return ret;
     }
 
-    // Update all shift registers with better error handling
-    ret = _shift_out_data();
-    if (ret != SLAVE_PCB_OK) {
-        ESP_LOGE(TAG, "Failed to shift out data for device %d", device);
-        return ret;
+    // Transfer done by the flush task at the end of the tick
+    if (shift_register_data[mapping->register_index] != previous) {
+        output_dirty = true;
+        xTaskNotifyGive(flush_task_handle);
     }
 
     ESP_LOGD(TAG, "Device %d successfully set to %s", device, state ? "ON" : "OFF");
@@ -173,6 +180,46 @@ slave_pcb_err_t init_shift_registers(void) {
     gpio_set_level(REG_MR, 1);
     vTaskDelay(pdMS_TO_TICKS(5)); // Wait after reset
 
+    // SPI bus on DS / SHCP, STCP as chip select
+    spi_bus_config_t buscfg = {
+        .mosi_io_num = REG_DS,
+        .miso_io_num = -1,
+        .sclk_io_num = REG_SHCP,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = SHIFT_REG_NUM_REGISTERS,
+    };
+    esp_err_t err = spi_bus_initialize(SHIFT_REG_SPI_HOST, &buscfg, SPI_DMA_CH_AUTO);
+    if (err != ESP_OK) {
+        REPORT_ERROR(SLAVE_PCB_ERR_SPI_FAIL, TAG, "Shift register SPI bus initialization failed", err);
+        return SLAVE_PCB_ERR_INIT_FAIL;
+    }
+
+    spi_device_interface_config_t devcfg = {
+        .clock_speed_hz = SHIFT_REG_SPI_CLOCK_HZ,
+        .mode = 0,                      // DS sampled on the SHCP rising edge
+        .spics_io_num = REG_STCP,
+        .cs_ena_posttrans = 1,          // STCP rises one bit after the last SHCP edge
+        .queue_size = 1,
+    };
+    err = spi_bus_add_device(SHIFT_REG_SPI_HOST, &devcfg, &spi_handle);
+    if (err != ESP_OK) {
+        REPORT_ERROR(SLAVE_PCB_ERR_SPI_FAIL, TAG, "Shift register SPI device addition failed", err);
+        spi_bus_free(SHIFT_REG_SPI_HOST);
+        return SLAVE_PCB_ERR_INIT_FAIL;
+    }
+
+    spi_tx_buffer = heap_caps_malloc(SHIFT_REG_NUM_REGISTERS, MALLOC_CAP_DMA);
+    if (spi_tx_buffer == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate DMA buffer");
+        return SLAVE_PCB_ERR_MEMORY;
+    }
+
+    if (xTaskCreate(_flush_task, "shift_reg_flush", 2048, NULL, 6, &flush_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create flush task");
+        return SLAVE_PCB_ERR_INIT_FAIL;
+    }
+
     // Shift out initial data (all zeros) to ensure clean state
     _shift_out_data();
 
@@ -227,11 +274,37 @@ slave_pcb_err_t enable_shift_register_outputs(bool enable) {
 slave_pcb_err_t set_all_outputs_safe(void) {
     ESP_LOGI(TAG, "Setting all outputs to safe state");
 
+    if (xSemaphoreTake(output_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to take output mutex");
+        return SLAVE_PCB_ERR_TIMEOUT;
+    }
+
     // Clear all data
     memset(shift_register_data, 0, sizeof(shift_register_data));
 
-    // Update shift registers
-    return _shift_out_data();
+    // Update shift registers now, without waiting for the flush task
+    slave_pcb_err_t ret = _shift_out_data();
+    xSemaphoreGive(output_mutex);
+    return ret;
+}
+
+/**
+ * @brief Send the pending output changes to the registers now
+ * @return slave_pcb_err_t Error code
+ */
+slave_pcb_err_t shift_register_flush(void) {
+    if (xSemaphoreTake(output_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to take output mutex");
+        return SLAVE_PCB_ERR_TIMEOUT;
+    }
+
+    slave_pcb_err_t ret = SLAVE_PCB_OK;
+    if (output_dirty) {
+        ret = _shift_out_data();
+    }
+
+    xSemaphoreGive(output_mutex);
+    return ret;
 }
 
 
@@ -3,13 +3,17 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
 
 
 #include "esp_rom_sys.h" 
 #include "esp_log.h"
+#include "esp_heap_caps.h"
 #include "driver/gpio.h"
+#include "driver/spi_master.h"
 
 
 #include "sdkconfig.h"
@@ -22,6 +26,14 @@
 #define SHIFT_REG_NUM_REGISTERS 4  // Total of 32 output bits
 #define SHIFT_REG_TOTAL_BITS (SHIFT_REG_BITS_PER_REGISTER * SHIFT_REG_NUM_REGISTERS)
 
+// SPI driving of the chain (SPI2 is used by the W5500)
+// MOSI -> DS, SCLK -> SHCP, CS -> STCP: CS rises at the end of the
+// transfer and latches the outputs. The data go through DMA.
+#define SHIFT_REG_SPI_HOST      SPI3_HOST
+#define SHIFT_REG_SPI_CLOCK_HZ  (1 * 1000 * 1000)
+#define SHIFT_REG_BATCH_MS      1       // Changes within this window go in one transfer
+#define SHIFT_REG_RETRY_MS      50      // Failed transfer: next attempt of the flush task
+
 // Device to bit mapping
 typedef struct {
     uint8_t register_index;
@@ -35,5 +47,6 @@ void get_shift_register_state(void);
 slave_pcb_err_t enable_shift_register_outputs(bool enable);
 slave_pcb_err_t set_all_outputs_safe(void);
 slave_pcb_err_t set_output_state(device_type_t device, bool state);
+slave_pcb_err_t shift_register_flush(void);
 
 #endif // SHIFT_REGISTER_H
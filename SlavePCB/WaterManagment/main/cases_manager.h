@@ -14,15 +14,6 @@
 #include "../communications/communications_manager.h"
 
 
-// System states
-typedef enum {
-    STATE_CE = (1 << 0),  // Clean Water Empty
-    STATE_DF = (1 << 1),  // Dirt Water Full
-    STATE_DE = (1 << 2),  // Dirt Water Empty
-    STATE_RF = (1 << 3),  // Recycled Water Full
-    STATE_RE = (1 << 4)   // Recycled Water Empty
-} system_states_t;
-
 // Case compatibility matrix
 static const uint32_t incompatible_cases[CASE_MAX] = {
     [CASE_RST] = 0,
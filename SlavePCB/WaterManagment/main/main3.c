@@ -4,6 +4,7 @@
 #include "../io_drivers/gpio_manager.h"
 #include "../communications/uart/uart_manager.h"
 #include "../communications/communications_manager.h"
+#include "../peripherals_devices/load_cells_manager.h"
 #include "cases_manager.h"
 
 static const char *TAG = "SLAVE_PCB_MAIN";
@@ -51,6 +52,14 @@ static slave_pcb_err_t init_components(void){
         return SLAVE_PCB_ERR_INIT_FAIL;
     }
 
+    // Initialize load cells (after the communication manager: weights go to its state)
+    ret = load_cells_manager_init();
+    if (ret != SLAVE_PCB_OK) {
+        REPORT_ERROR(ret, TAG, "Failed to initialize Load Cells Manager", 0);
+        return SLAVE_PCB_ERR_INIT_FAIL;
+    }
+    xTaskCreate(load_cells_manager_task, "load_cells", 4096, NULL, 5, NULL);
+
     // Test a error reporting of each error type
 
     // REPORT_ERROR(SLAVE_PCB_ERR_INVALID_ARG, TAG, "Test Initialization error", 0);
@@ -59,6 +59,9 @@ slave_pcb_err_t electrovalve_set_state(device_type_t device, bool state) {
     slave_pcb_err_t ret = set_output_state(device, state);
     
     if (ret == SLAVE_PCB_OK) {
+        // Latch now: the current samples only count from the actual switching
+        // (if the transfer fails, the flush task retries it)
+        ret = shift_register_flush();
         electrovalve_states[device].is_active = state;
         electrovalve_states[device].target_state = state;
         electrovalve_states[device].last_state_change = esp_timer_get_time() / 1000;
@@ -80,9 +83,16 @@ bool electrovalve_is_turning(device_type_t device) {
         return electrovalve_states[device].is_active;
     }
 
+    // Dernier échantillon du scan de fond, sans accès I2C
     float current_ma;
-    slave_pcb_err_t ret = current_sensor_read_channel(config->i2c_channel, &current_ma);
-    
+    uint32_t sample_ms;
+    slave_pcb_err_t ret = current_sensor_get_latest(config->i2c_channel, &current_ma, &sample_ms);
+
+    if (ret == SLAVE_PCB_OK && (int32_t)(sample_ms - (electrovalve_states[device].last_state_change + CURRENT_SENSOR_CONVERSION_MS)) < 0) {
+        // Conversion commencée avant la commande: état commandé jusqu'à la prochaine mesure
+        return electrovalve_states[device].is_active;
+    }
+
     if (ret == SLAVE_PCB_OK) {
         electrovalve_states[device].last_current_reading = current_ma;
         electrovalve_states[device].is_turning = (current_ma > CURRENT_THRESHOLD_EV_MA);
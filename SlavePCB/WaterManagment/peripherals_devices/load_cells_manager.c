@@ -0,0 +1,433 @@
+#include "load_cells_manager.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include <math.h>  // For fabsf
+
+static const char *TAG = "LOADCELL_MGR";
+
+// NVS namespace for calibration data
+#define NVS_NAMESPACE "loadcell_cal"
+
+// HX711 configuration - optimized for speed and stability
+#define HX711_STABILIZING_TIME_MS 100   // Reduced from 200ms
+#define HX711_TIMEOUT_MS 500            // Reduced timeout
+
+// Streaming filter, one sample per conversion (kg units)
+#define FILTER_MEDIAN_SIZE 5            // Running median window (sorting network of 5)
+#define HAMPEL_K 3.0f                   // Reject samples further than K sigma from the median
+#define HAMPEL_MIN_SIGMA_KG 0.05f       // Sigma floor: HX711 noise of a tank at rest
+#define MAD_TO_SIGMA 1.4826f            // MAD of a normal distribution -> sigma
+#define ALPHA_BETA_ALPHA 0.2f           // Level gain (~0.5 s time constant at 10 SPS)
+#define ALPHA_BETA_BETA 0.01f           // Rate gain
+#define FILTER_MAX_DT_S 1.0f            // Longer gaps (reset, lost samples) count as 1 s
+#define STABILITY_RATE_KG_S 0.02f       // Fill/drain rate below which the weight is stable
+#define LOAD_CELL_PUBLISH_INTERVAL_MS 1000
+
+// Per-tank streaming estimator: running median + Hampel gate, then alpha-beta
+typedef struct {
+    float window[FILTER_MEDIAN_SIZE];   // Last samples (raw, before the gate)
+    uint8_t window_index;
+    uint8_t window_count;
+    bool initialized;
+    float level_kg;                     // Filtered weight
+    float rate_kg_s;                    // Fill (>0) / drain (<0) rate
+    uint32_t last_sample_ms;
+    uint32_t samples;
+    uint32_t rejected;                  // Samples replaced by the median
+} tank_filter_t;
+
+// Tank configuration with advanced filtering
+typedef struct {
+    float calibration_factor;
+    float tare_offset;
+    float last_weight;
+    uint32_t last_reading_time;
+    bool is_stable;
+    tank_filter_t filter;
+} tank_config_t;
+
+static tank_config_t tank_configs[TANK_MAX] = {
+    [TANK_A] = { .calibration_factor = 1000.0f },
+    [TANK_B] = { .calibration_factor = 1000.0f },
+    [TANK_C] = { .calibration_factor = 1000.0f },
+    [TANK_D] = { .calibration_factor = 1000.0f },
+    [TANK_E] = { .calibration_factor = 1000.0f }
+};
+
+// Usable capacity of each tank (liters), for the level percentage
+static const float tank_capacity_liters[TANK_MAX] = {
+    [TANK_A] = 100.0f,
+    [TANK_B] = 100.0f,
+    [TANK_C] = 100.0f,
+    [TANK_D] = 100.0f,
+    [TANK_E] = 100.0f
+};
+#define WATER_DENSITY_KG_L 1.0f
+
+// System state thresholds (in kg)
+#define CLEAN_WATER_EMPTY_THRESHOLD    5.0f   // CE threshold
+#define DIRTY_WATER_FULL_THRESHOLD     80.0f  // DF threshold  
+#define DIRTY_WATER_EMPTY_THRESHOLD    2.0f   // DE threshold
+#define RECYCLED_WATER_FULL_THRESHOLD  80.0f  // RF threshold
+#define RECYCLED_WATER_EMPTY_THRESHOLD 5.0f   // RE threshold
+
+// Current system states
+static volatile uint32_t current_system_states = 0;
+
+_Static_assert(TANK_MAX == HX711_CHANNELS, "One HX711 channel per tank");
+
+/**
+ * @brief Reset all HX711 modules to ensure synchronized state
+ */
+static void reset_all_hx711_modules(void) {
+    // ESP_LOGI(TAG, "Resetting all HX711 modules for synchronization");
+    
+    // SCK high for >60us (RMT pulse) resets all HX711 modules
+    hx711_reset();
+    
+    // Wait for modules to stabilize
+    vTaskDelay(pdMS_TO_TICKS(HX711_STABILIZING_TIME_MS));
+}
+
+#define SORT2(a, b) do { if ((a) > (b)) { float t = (a); (a) = (b); (b) = t; } } while (0)
+
+/**
+ * @brief Sort 5 values (optimal sorting network, 9 compare-exchanges)
+ */
+static void sort5(float *v) {
+    SORT2(v[0], v[3]); SORT2(v[1], v[4]);
+    SORT2(v[0], v[2]); SORT2(v[1], v[3]);
+    SORT2(v[0], v[1]); SORT2(v[2], v[4]);
+    SORT2(v[1], v[2]); SORT2(v[3], v[4]);
+    SORT2(v[2], v[3]);
+}
+
+/**
+ * @brief Median and median absolute deviation of the (full) window
+ */
+static void window_median_mad(const tank_filter_t *f, float *median, float *mad) {
+    float v[FILTER_MEDIAN_SIZE];
+    for (int i = 0; i < FILTER_MEDIAN_SIZE; i++) {
+        v[i] = f->window[i];
+    }
+    sort5(v);
+    *median = v[FILTER_MEDIAN_SIZE / 2];
+
+    for (int i = 0; i < FILTER_MEDIAN_SIZE; i++) {
+        v[i] = fabsf(v[i] - *median);
+    }
+    sort5(v);
+    *mad = v[FILTER_MEDIAN_SIZE / 2];
+}
+
+/**
+ * @brief Feed one weight sample to the tank estimator
+ *
+ * A sample further than HAMPEL_K sigma (from the MAD) from the running median
+ * is replaced by the median; a real level step enters the window and passes
+ * once it is the majority. The alpha-beta filter then tracks level and rate.
+ */
+static void update_tank_filter(tank_config_t *config, float weight_kg, uint32_t now_ms) {
+    tank_filter_t *f = &config->filter;
+
+    // Fill the window first: the estimator starts from its median
+    if (f->window_count < FILTER_MEDIAN_SIZE) {
+        f->window[f->window_count++] = weight_kg;
+        f->last_sample_ms = now_ms;
+        if (f->window_count < FILTER_MEDIAN_SIZE) {
+            return;
+        }
+        float median, mad;
+        window_median_mad(f, &median, &mad);
+        f->level_kg = median;
+        f->rate_kg_s = 0.0f;
+        f->initialized = true;
+    } else {
+        // Hampel gate against the previous samples
+        float measured = weight_kg;
+        float median, mad;
+        window_median_mad(f, &median, &mad);
+        float sigma = fmaxf(MAD_TO_SIGMA * mad, HAMPEL_MIN_SIGMA_KG);
+        if (fabsf(weight_kg - median) > HAMPEL_K * sigma) {
+            measured = median;
+            f->rejected++;
+        }
+
+        f->window[f->window_index] = weight_kg;
+        f->window_index = (f->window_index + 1) % FILTER_MEDIAN_SIZE;
+
+        // Alpha-beta tracking of level and fill/drain rate
+        float dt = (now_ms - f->last_sample_ms) / 1000.0f;
+        if (dt <= 0.0f) dt = 0.001f;
+        if (dt > FILTER_MAX_DT_S) dt = FILTER_MAX_DT_S;
+
+        float predicted = f->level_kg + f->rate_kg_s * dt;
+        float residual = measured - predicted;
+        f->level_kg = predicted + ALPHA_BETA_ALPHA * residual;
+        f->rate_kg_s += ALPHA_BETA_BETA * residual / dt;
+        f->last_sample_ms = now_ms;
+    }
+    f->samples++;
+
+    config->last_weight = f->level_kg;
+    config->last_reading_time = now_ms;
+    config->is_stable = fabsf(f->rate_kg_s) < STABILITY_RATE_KG_S;
+}
+
+/**
+ * @brief Feed one HX711 sample (all tanks) to the estimators
+ */
+static void process_hx711_sample(const hx711_sample_t *sample) {
+    for (tank_id_t tank = 0; tank < TANK_MAX; tank++) {
+        if (!(sample->valid_mask & (1UL << tank))) {
+            continue;
+        }
+        tank_config_t *config = &tank_configs[tank];
+        float weight = ((float)sample->raw[tank] - config->tare_offset) / config->calibration_factor;
+        update_tank_filter(config, weight, sample->timestamp_ms);
+    }
+}
+
+/**
+ * @brief Publish the filtered weight of every tank with a recent sample
+ */
+static slave_pcb_err_t publish_tank_weights(void) {
+    static water_tanks_levels_t levels = {0};
+    water_tank_data_t *tank_data[TANK_MAX] = {
+        &levels.tank_a, &levels.tank_b, &levels.tank_c, &levels.tank_d, &levels.tank_e
+    };
+    int successful_reads = 0;
+    uint32_t now = esp_timer_get_time() / 1000;
+
+    for (tank_id_t tank = 0; tank < TANK_MAX; tank++) {
+        tank_config_t *config = &tank_configs[tank];
+
+        if (config->filter.initialized && now - config->last_reading_time <= HX711_TIMEOUT_MS * 2) {
+            successful_reads++;
+            // Water only: 1 kg per liter
+            float volume = (config->last_weight > 0.0f) ? config->last_weight / WATER_DENSITY_KG_L : 0.0f;
+            float level = volume / tank_capacity_liters[tank] * 100.0f;
+            tank_data[tank]->weight_kg = config->last_weight;
+            tank_data[tank]->volume_liters = volume;
+            tank_data[tank]->level_percentage = (level > 100.0f) ? 100.0f : level;
+
+            ESP_LOGD(TAG, "Tank %d: %.2f kg (%.3f kg/s, %lu rejected)", tank, config->last_weight,
+                     config->filter.rate_kg_s, config->filter.rejected);
+        } else {
+            ESP_LOGD(TAG, "Tank %d: no recent sample", tank);
+        }
+    }
+
+    // Sent to the MainPCB with the next state message
+    update_tank_levels(&levels);
+
+    ESP_LOGD(TAG, "Publish cycle completed: %d/%d tanks successful", successful_reads, TANK_MAX);
+    return (successful_reads > 0) ? SLAVE_PCB_OK : SLAVE_PCB_ERR_TIMEOUT;
+}
+
+/**
+ * @brief Update system states based on tank weights
+ */
+static void update_system_states(void) {
+    uint32_t new_states = 0;
+
+    // Example tank assignments (this would be configured based on actual tank setup)
+    float clean_water_weight = tank_configs[TANK_A].last_weight; // Assume tank A is clean water
+    float dirty_water_weight = tank_configs[TANK_B].last_weight; // Assume tank B is dirty water  
+    float recycled_water_weight = tank_configs[TANK_C].last_weight; // Assume tank C is recycled water
+
+    // Check thresholds and set state flags
+    if (clean_water_weight < CLEAN_WATER_EMPTY_THRESHOLD) {
+        new_states |= STATE_CE;
+    }
+    
+    if (dirty_water_weight > DIRTY_WATER_FULL_THRESHOLD) {
+        new_states |= STATE_DF;
+    }
+    
+    if (dirty_water_weight < DIRTY_WATER_EMPTY_THRESHOLD) {
+        new_states |= STATE_DE;
+    }
+    
+    if (recycled_water_weight > RECYCLED_WATER_FULL_THRESHOLD) {
+        new_states |= STATE_RF;
+    }
+    
+    if (recycled_water_weight < RECYCLED_WATER_EMPTY_THRESHOLD) {
+        new_states |= STATE_RE;
+    }
+
+    // Check for state changes
+    if (new_states != current_system_states) {
+        ESP_LOGI(TAG, "System states changed: 0x%lx -> 0x%lx", current_system_states, new_states);
+        
+        if (new_states & STATE_CE) ESP_LOGW(TAG, "Clean water tank is empty!");
+        if (new_states & STATE_DF) ESP_LOGW(TAG, "Dirty water tank is full!");
+        if (new_states & STATE_DE) ESP_LOGW(TAG, "Dirty water tank is empty!");
+        if (new_states & STATE_RF) ESP_LOGW(TAG, "Recycled water tank is full!");
+        if (new_states & STATE_RE) ESP_LOGW(TAG, "Recycled water tank is empty!");
+
+        current_system_states = new_states;
+    }
+}
+
+/**
+ * @brief Get current system states
+ */
+uint32_t get_current_system_states(void) {
+    return current_system_states;
+}
+
+/**
+ * @brief Load calibration data from NVS
+ */
+static slave_pcb_err_t load_calibration_from_nvs(tank_id_t tank_id) {
+    if (tank_id >= TANK_MAX) {
+        return SLAVE_PCB_ERR_INVALID_ARG;
+    }
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err;
+
+    // Open NVS
+    err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "No calibration data found in NVS: %s", esp_err_to_name(err));
+        return SLAVE_PCB_ERR_DEVICE_NOT_FOUND;
+    }
+
+    // Create keys for this tank
+    char tare_key[16], cal_key[16];
+    snprintf(tare_key, sizeof(tare_key), "tare_%d", tank_id);
+    snprintf(cal_key, sizeof(cal_key), "cal_%d", tank_id);
+
+    // Load tare offset
+    size_t required_size = sizeof(float);
+    err = nvs_get_blob(nvs_handle, tare_key, &tank_configs[tank_id].tare_offset, &required_size);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to load tare offset for tank %d: %s", tank_id, esp_err_to_name(err));
+        nvs_close(nvs_handle);
+        return SLAVE_PCB_ERR_DEVICE_NOT_FOUND;
+    }
+
+    // Load calibration factor
+    required_size = sizeof(float);
+    err = nvs_get_blob(nvs_handle, cal_key, &tank_configs[tank_id].calibration_factor, &required_size);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to load calibration factor for tank %d: %s", tank_id, esp_err_to_name(err));
+        nvs_close(nvs_handle);
+        return SLAVE_PCB_ERR_DEVICE_NOT_FOUND;
+    }
+
+    nvs_close(nvs_handle);
+    ESP_LOGI(TAG, "Calibration data loaded for tank %d: tare=%.1f, cal_factor=%.1f", 
+             tank_id, tank_configs[tank_id].tare_offset, tank_configs[tank_id].calibration_factor);
+    return SLAVE_PCB_OK;
+}
+
+/**
+ * @brief Load all calibration data from NVS at startup
+ */
+static void load_all_calibrations_from_nvs(void) {
+    ESP_LOGI(TAG, "Loading calibration data from NVS...");
+    
+    for (tank_id_t tank = 0; tank < TANK_MAX; tank++) {
+        slave_pcb_err_t ret = load_calibration_from_nvs(tank);
+        if (ret != SLAVE_PCB_OK) {
+            ESP_LOGW(TAG, "No calibration data found for tank %d, using defaults", tank);
+            // Keep default values (tare_offset = 0, calibration_factor = 1000.0)
+        }
+    }
+}
+
+/**
+ * @brief Load Cell Manager initialization
+ */
+slave_pcb_err_t load_cells_manager_init(void) {
+    ESP_LOGI(TAG, "Initializing Load Cell Manager");
+
+    // Initialize NVS for calibration data storage
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_LOGW(TAG, "NVS partition was truncated, erasing...");
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize NVS: %s", esp_err_to_name(err));
+        return SLAVE_PCB_ERR_MEMORY;
+    }
+
+    // Start the HX711 acquisition (RMT clock, DRDY interrupts)
+    if (hx711_init() != SLAVE_PCB_OK) {
+        ESP_LOGE(TAG, "Failed to start HX711 acquisition");
+        return SLAVE_PCB_ERR_INIT_FAIL;
+    }
+
+    // Reset all HX711 modules for proper synchronization
+    ESP_LOGI(TAG, "Resetting HX711 modules...");
+    reset_all_hx711_modules();
+
+    // Wait for HX711 modules to stabilize
+    ESP_LOGI(TAG, "Waiting for HX711 modules to stabilize...");
+    vTaskDelay(pdMS_TO_TICKS(HX711_STABILIZING_TIME_MS));
+
+    // Load saved calibration data from NVS
+    load_all_calibrations_from_nvs();
+
+    ESP_LOGI(TAG, "Load Cell Manager initialized successfully");
+    return SLAVE_PCB_OK;
+}
+
+/**
+ * @brief Load Cell Manager main task
+ */
+void load_cells_manager_task(void *pvParameters) {
+    ESP_LOGI(TAG, "Load Cell Manager task started");
+
+    uint32_t last_publish_time = esp_timer_get_time() / 1000;
+
+    while (1) {
+        // One sample per conversion: every tank filtered continuously
+        hx711_sample_t sample;
+        if (hx711_read_sample(&sample, HX711_TIMEOUT_MS) == SLAVE_PCB_OK) {
+            process_hx711_sample(&sample);
+        } else {
+            ESP_LOGD(TAG, "No HX711 sample for %d ms", HX711_TIMEOUT_MS);
+        }
+
+        uint32_t now = esp_timer_get_time() / 1000;
+        if (now - last_publish_time < LOAD_CELL_PUBLISH_INTERVAL_MS) {
+            continue;
+        }
+        last_publish_time = now;
+
+        // Send the filtered weights
+        slave_pcb_err_t ret = publish_tank_weights();
+        if (ret != SLAVE_PCB_OK) {
+            ESP_LOGD(TAG, "Error reading tanks: %s", get_error_string(ret));
+        }
+
+        // Update system states based on weights
+        update_system_states();
+
+        // Log current weights and performance periodically
+        static uint32_t last_log_time = 0;
+        
+        if (now - last_log_time > 5000) { // Every 5 seconds instead of 10
+            last_log_time = now;
+            
+            ESP_LOGI(TAG, "Weights (kg) - A:%.2f%s B:%.2f%s C:%.2f%s D:%.2f%s E:%.2f%s",
+                     tank_configs[TANK_A].last_weight, tank_configs[TANK_A].is_stable ? "*" : "",
+                     tank_configs[TANK_B].last_weight, tank_configs[TANK_B].is_stable ? "*" : "",
+                     tank_configs[TANK_C].last_weight, tank_configs[TANK_C].is_stable ? "*" : "",
+                     tank_configs[TANK_D].last_weight, tank_configs[TANK_D].is_stable ? "*" : "",
+                     tank_configs[TANK_E].last_weight, tank_configs[TANK_E].is_stable ? "*" : "");
+            
+            hx711_stats_t stats;
+            hx711_get_stats(&stats);
+            ESP_LOGI(TAG, "Performance: samples=%lu, dropped=%lu, partial=%lu, states=0x%lx",
+                     stats.samples, stats.corrupted + stats.overflows, stats.partial, current_system_states);
+        }
+    }
+}
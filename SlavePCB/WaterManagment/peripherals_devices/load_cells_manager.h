@@ -0,0 +1,30 @@
+#ifndef LOAD_CELLS_MANAGER_H
+#define LOAD_CELLS_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "../io_drivers/hx711.h"
+#include "../common_includes/cases.h"
+#include "../common_includes/error_manager.h"
+#include "../communications/communications_manager.h"
+
+// Tanks weighed by the HX711 (one channel each, DT_A..DT_E)
+typedef enum {
+    TANK_A = 0,
+    TANK_B,
+    TANK_C,
+    TANK_D,
+    TANK_E,
+    TANK_MAX
+} tank_id_t;
+
+slave_pcb_err_t load_cells_manager_init(void);
+void load_cells_manager_task(void *pvParameters);
+uint32_t get_current_system_states(void);   // system_states_t bits from the weights
+
+#endif // LOAD_CELLS_MANAGER_H
@@ -57,6 +57,9 @@ slave_pcb_err_t pump_set_state(device_type_t device, bool state) {
     slave_pcb_err_t ret = set_output_state(device, state);
     
     if (ret == SLAVE_PCB_OK) {
+        // Latch now: the current samples only count from the actual switching
+        // (if the transfer fails, the flush task retries it)
+        ret = shift_register_flush();
         pump_states[device].is_active = state;
         pump_states[device].target_state = state;
         pump_states[device].last_state_change = esp_timer_get_time() / 1000;
@@ -78,9 +81,16 @@ bool pump_is_pumping(device_type_t device) {
         return pump_states[device].is_active;
     }
 
+    // Dernier échantillon du scan de fond, sans accès I2C
     float current_ma;
-    slave_pcb_err_t ret = current_sensor_read_channel(config->i2c_channel, &current_ma);
-    
+    uint32_t sample_ms;
+    slave_pcb_err_t ret = current_sensor_get_latest(config->i2c_channel, &current_ma, &sample_ms);
+
+    if (ret == SLAVE_PCB_OK && (int32_t)(sample_ms - (pump_states[device].last_state_change + CURRENT_SENSOR_CONVERSION_MS)) < 0) {
+        // Conversion commencée avant la commande: état commandé jusqu'à la prochaine mesure
+        return pump_states[device].is_active;
+    }
+
     if (ret == SLAVE_PCB_OK) {
         pump_states[device].last_current_reading = current_ma;
         pump_states[device].is_pumping = (current_ma > config->pumping_current_threshold_ma);